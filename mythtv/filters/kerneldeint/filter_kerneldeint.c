@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
 
 #include "mythconfig.h"
 #if HAVE_STDINT_H
@@ -36,6 +38,16 @@ static const mmx_t mm_cpool[] = { { 0x0000000000000000LL }, };
 #define mmx_t int
 #endif
 
+#if ARCH_X86 && defined(__GNUC__)
+#include <immintrin.h>
+#define KERNEL_SSE2 HAVE_SSE2
+#define KERNEL_AVX2 HAVE_AVX2
+#endif
+#if (ARCH_ARM || ARCH_AARCH64) && HAVE_INTRINSICS_NEON
+#include <arm_neon.h>
+#define KERNEL_NEON 1
+#endif
+
 struct DeintThread
 {
     int       ready;
@@ -55,6 +67,8 @@ typedef struct ThisFilter
     int         actual_threads;
     int         requested_threads;
     pthread_mutex_t mutex;
+    pthread_cond_t  start_cond;
+    pthread_cond_t  done_cond;
 
     int       skipchroma;
     int       mm_flags;
@@ -208,6 +222,33 @@ static void line_filter_mmx(uint8_t *dst, int width, int start_width,
 }
 #endif
 
+#if KERNEL_SSE2
+#define SIMD_SSE2
+#define RENAME(a) a ## _sse2
+#include "../mm_simd.h"
+#include "kerneldeint_template.c"
+#undef RENAME
+#undef SIMD_SSE2
+#endif
+
+#if KERNEL_AVX2
+#define SIMD_AVX2
+#define RENAME(a) a ## _avx2
+#include "../mm_simd.h"
+#include "kerneldeint_template.c"
+#undef RENAME
+#undef SIMD_AVX2
+#endif
+
+#if KERNEL_NEON
+#define SIMD_NEON
+#define RENAME(a) a ## _neon
+#include "../mm_simd.h"
+#include "kerneldeint_template.c"
+#undef RENAME
+#undef SIMD_NEON
+#endif
+
 static void store_ref(struct ThisFilter *p, uint8_t *src, int src_offsets[3],
                       int src_stride[3], int width, int height)
 {
@@ -424,28 +465,36 @@ static void *KernelThread(void *args)
     pthread_mutex_lock(&(filter->mutex));
     int num = filter->actual_threads;
     filter->actual_threads = num + 1;
-    pthread_mutex_unlock(&(filter->mutex));
 
     while (!filter->kill_threads)
     {
-        usleep(1000);
-        if (filter->ready &&
-            filter->frame != NULL &&
-            filter->threads[num].ready)
+        if (!filter->ready ||
+            filter->frame == NULL ||
+            !filter->threads[num].ready)
         {
-            filter_func(
-                filter, filter->frame->buf, filter->frame->offsets,
-                filter->frame->pitches, filter->frame->width,
-                filter->frame->height, filter->field,
-                filter->frame->top_field_first, filter->double_rate,
-                filter->dirty_frame, num, filter->actual_threads);
-
-            pthread_mutex_lock(&(filter->mutex));
-            filter->ready = filter->ready - 1;
-            filter->threads[num].ready = 0;
-            pthread_mutex_unlock(&(filter->mutex));
+            pthread_cond_wait(&(filter->start_cond), &(filter->mutex));
+            continue;
         }
+
+        VideoFrame *frame = filter->frame;
+        int field       = filter->field;
+        int double_rate = filter->double_rate;
+        int dirty       = filter->dirty_frame;
+        int slices      = filter->actual_threads;
+        pthread_mutex_unlock(&(filter->mutex));
+
+        filter_func(
+            filter, frame->buf, frame->offsets, frame->pitches,
+            frame->width, frame->height, field, frame->top_field_first,
+            double_rate, dirty, num, slices);
+
+        pthread_mutex_lock(&(filter->mutex));
+        filter->ready = filter->ready - 1;
+        filter->threads[num].ready = 0;
+        if (filter->ready <= 0)
+            pthread_cond_signal(&(filter->done_cond));
     }
+    pthread_mutex_unlock(&(filter->mutex));
     pthread_exit(NULL);
     return NULL;
 }
@@ -483,17 +532,28 @@ static int KernelDeint(VideoFilter *f, VideoFrame *frame, int field)
     if (filter->actual_threads > 1 && filter->double_rate)
     {
         int i;
+        struct timeval now;
+        struct timespec timeout;
+
+        pthread_mutex_lock(&(filter->mutex));
         for (i = 0; i < filter->actual_threads; i++)
             filter->threads[i].ready = 1;
         filter->frame = frame;
         filter->field = field;
         filter->ready = filter->actual_threads;
-        i = 0;
-        while (filter->ready > 0 && i < 1000)
+        pthread_cond_broadcast(&(filter->start_cond));
+
+        // don't wait more than a second for a stuck slice
+        gettimeofday(&now, NULL);
+        timeout.tv_sec  = now.tv_sec + 1;
+        timeout.tv_nsec = now.tv_usec * 1000;
+        while (filter->ready > 0)
         {
-            usleep(1000);
-            i++;
+            if (pthread_cond_timedwait(&(filter->done_cond), &(filter->mutex),
+                                       &timeout) == ETIMEDOUT)
+                break;
         }
+        pthread_mutex_unlock(&(filter->mutex));
     }
     else
     {
@@ -525,11 +585,17 @@ static void CleanupKernelDeintFilter(VideoFilter *f)
 
     if (filter->threads != NULL)
     {
+        pthread_mutex_lock(&(filter->mutex));
         filter->kill_threads = 1;
+        pthread_cond_broadcast(&(filter->start_cond));
+        pthread_mutex_unlock(&(filter->mutex));
         for (i = 0; i < filter->requested_threads; i++)
             if (filter->threads[i].exists)
                 pthread_join(filter->threads[i].id, NULL);
         free(filter->threads);
+        pthread_cond_destroy(&(filter->start_cond));
+        pthread_cond_destroy(&(filter->done_cond));
+        pthread_mutex_destroy(&(filter->mutex));
     }
 }
 
@@ -560,6 +626,13 @@ static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
     filter->mm_flags = 0;
     filter->line_filter = &line_filter_c;
     filter->line_filter_fast = &line_filter_c_fast;
+#if KERNEL_NEON
+    if (av_get_cpu_flags() & AV_CPU_FLAG_NEON)
+    {
+        filter->line_filter = &line_filter_neon;
+        filter->line_filter_fast = &line_filter_fast_neon;
+    }
+#endif
 #if HAVE_MMX
     filter->mm_flags = av_get_cpu_flags();
     if (filter->mm_flags & AV_CPU_FLAG_MMX)
@@ -567,6 +640,20 @@ static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
         filter->line_filter = &line_filter_mmx;
         filter->line_filter_fast = &line_filter_mmx_fast;
     }
+#if KERNEL_SSE2
+    if (filter->mm_flags & AV_CPU_FLAG_SSE2)
+    {
+        filter->line_filter = &line_filter_sse2;
+        filter->line_filter_fast = &line_filter_fast_sse2;
+    }
+#endif
+#if KERNEL_AVX2
+    if (filter->mm_flags & AV_CPU_FLAG_AVX2)
+    {
+        filter->line_filter = &line_filter_avx2;
+        filter->line_filter_fast = &line_filter_fast_avx2;
+    }
+#endif
 #endif
 
     filter->skipchroma   = 0;
@@ -611,6 +698,8 @@ static VideoFilter *NewKernelDeintFilter(VideoFrameType inpixfmt,
     if (filter->requested_threads > 1)
     {
         pthread_mutex_init(&(filter->mutex), NULL);
+        pthread_cond_init(&(filter->start_cond), NULL);
+        pthread_cond_init(&(filter->done_cond), NULL);
         int success = 0;
         for (int i = 0; i < filter->requested_threads; i++)
         {
@@ -0,0 +1,66 @@
+/*
+ * KernelDeint vector line filters
+ *
+ * Vector forms of line_filter_c() and line_filter_c_fast(), instantiated
+ * once per instruction set from filter_kerneldeint.c; see ../mm_simd.h for
+ * the operations.  The destination may alias one of the source lines, so
+ * every input is loaded before anything is stored.
+ */
+
+#define KERNEL(s1, s2, s3, s4, s5) \
+    VSRA(VSUB(VSUB(VADD(VSLL(VADD(s2, s4), 2), VSLL(s3, 1)), s1), s5), 3)
+
+SIMD_TARGET
+static void RENAME(line_filter_fast)(uint8_t *dst, int width, int start_width,
+                                     uint8_t *buf, uint8_t *src2,
+                                     uint8_t *src3, uint8_t *src4,
+                                     uint8_t *src5)
+{
+    const VEC threshold = VSET1(11);
+    int X;
+
+    for (X = start_width; X + VWIDTH <= width; X += VWIDTH)
+    {
+        VEC s1  = VLOAD(&buf[X]);
+        VEC s2  = VLOAD(&src2[X]);
+        VEC s3  = VLOAD(&src3[X]);
+        VEC s4  = VLOAD(&src4[X]);
+        VEC s5  = VLOAD(&src5[X]);
+        VEC old = VLOAD(&dst[X]);
+        VEC res = KERNEL(s1, s2, s3, s4, s5);
+        VMASK m = VCMPGT(VABSDIFF(s3, s2), threshold);
+
+        VSTORE(&buf[X], s3);
+        res = VBLEND(m, res, old);
+        VSTORE(&dst[X], res);
+    }
+
+    line_filter_c_fast(dst, width, X, buf, src2, src3, src4, src5);
+}
+
+SIMD_TARGET
+static void RENAME(line_filter)(uint8_t *dst, int width, int start_width,
+                                uint8_t *src1, uint8_t *src2, uint8_t *src3,
+                                uint8_t *src4, uint8_t *src5)
+{
+    const VEC threshold = VSET1(11);
+    int X;
+
+    for (X = start_width; X + VWIDTH <= width; X += VWIDTH)
+    {
+        VEC s1  = VLOAD(&src1[X]);
+        VEC s2  = VLOAD(&src2[X]);
+        VEC s3  = VLOAD(&src3[X]);
+        VEC s4  = VLOAD(&src4[X]);
+        VEC s5  = VLOAD(&src5[X]);
+        VEC res = KERNEL(s1, s2, s3, s4, s5);
+        VMASK m = VCMPGT(VABSDIFF(s3, s2), threshold);
+
+        res = VBLEND(m, res, s3);
+        VSTORE(&dst[X], res);
+    }
+
+    line_filter_c(dst, width, X, src1, src2, src3, src4, src5);
+}
+
+#undef KERNEL
@@ -0,0 +1,99 @@
+/* mm_simd.h - 16 bit lane vector operations for the filter templates
+ *
+ * Define one of SIMD_SSE2, SIMD_AVX2 or SIMD_NEON before including, then
+ * include the filter's *_template.c with a matching RENAME().  This file has
+ * no include guard on purpose: it is included once per instruction set.
+ *
+ * Pixels are loaded zero extended to signed 16 bits, which leaves enough
+ * headroom for the sums the deinterlacers use, and are stored back with
+ * unsigned saturation.  Macro arguments may be evaluated more than once.
+ */
+
+#undef VWIDTH
+#undef VEC
+#undef VMASK
+#undef SIMD_TARGET
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VSRA
+#undef VSLL
+#undef VMIN
+#undef VMAX
+#undef VABSDIFF
+#undef VCMPLT
+#undef VCMPGT
+#undef VMAND
+#undef VBLEND
+
+#if defined(SIMD_AVX2)
+
+#define VWIDTH          16
+#define VEC             __m256i
+#define VMASK           __m256i
+#define SIMD_TARGET     __attribute__((target("avx2")))
+#define VLOAD(p)        _mm256_cvtepu8_epi16( \
+                            _mm_loadu_si128((const __m128i*)(p)))
+#define VSTORE(p,v)     _mm_storeu_si128((__m128i*)(p), \
+                            _mm256_castsi256_si128(_mm256_permute4x64_epi64( \
+                                _mm256_packus_epi16(v, v), 0xd8)))
+#define VSET1(x)        _mm256_set1_epi16(x)
+#define VADD(a,b)       _mm256_add_epi16(a, b)
+#define VSUB(a,b)       _mm256_sub_epi16(a, b)
+#define VSRA(a,n)       _mm256_srai_epi16(a, n)
+#define VSLL(a,n)       _mm256_slli_epi16(a, n)
+#define VMIN(a,b)       _mm256_min_epi16(a, b)
+#define VMAX(a,b)       _mm256_max_epi16(a, b)
+#define VABSDIFF(a,b)   _mm256_abs_epi16(_mm256_sub_epi16(a, b))
+#define VCMPLT(a,b)     _mm256_cmpgt_epi16(b, a)
+#define VCMPGT(a,b)     _mm256_cmpgt_epi16(a, b)
+#define VMAND(a,b)      _mm256_and_si256(a, b)
+#define VBLEND(m,a,b)   _mm256_blendv_epi8(b, a, m)
+
+#elif defined(SIMD_SSE2)
+
+#define VWIDTH          8
+#define VEC             __m128i
+#define VMASK           __m128i
+#define SIMD_TARGET     __attribute__((target("sse2")))
+#define VLOAD(p)        _mm_unpacklo_epi8( \
+                            _mm_loadl_epi64((const __m128i*)(p)), \
+                            _mm_setzero_si128())
+#define VSTORE(p,v)     _mm_storel_epi64((__m128i*)(p), _mm_packus_epi16(v, v))
+#define VSET1(x)        _mm_set1_epi16(x)
+#define VADD(a,b)       _mm_add_epi16(a, b)
+#define VSUB(a,b)       _mm_sub_epi16(a, b)
+#define VSRA(a,n)       _mm_srai_epi16(a, n)
+#define VSLL(a,n)       _mm_slli_epi16(a, n)
+#define VMIN(a,b)       _mm_min_epi16(a, b)
+#define VMAX(a,b)       _mm_max_epi16(a, b)
+#define VABSDIFF(a,b)   _mm_max_epi16(_mm_sub_epi16(a, b), _mm_sub_epi16(b, a))
+#define VCMPLT(a,b)     _mm_cmplt_epi16(a, b)
+#define VCMPGT(a,b)     _mm_cmpgt_epi16(a, b)
+#define VMAND(a,b)      _mm_and_si128(a, b)
+#define VBLEND(m,a,b)   _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b))
+
+#elif defined(SIMD_NEON)
+
+#define VWIDTH          8
+#define VEC             int16x8_t
+#define VMASK           uint16x8_t
+#define SIMD_TARGET
+#define VLOAD(p)        vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)))
+#define VSTORE(p,v)     vst1_u8(p, vqmovun_s16(v))
+#define VSET1(x)        vdupq_n_s16(x)
+#define VADD(a,b)       vaddq_s16(a, b)
+#define VSUB(a,b)       vsubq_s16(a, b)
+#define VSRA(a,n)       vshrq_n_s16(a, n)
+#define VSLL(a,n)       vshlq_n_s16(a, n)
+#define VMIN(a,b)       vminq_s16(a, b)
+#define VMAX(a,b)       vmaxq_s16(a, b)
+#define VABSDIFF(a,b)   vabdq_s16(a, b)
+#define VCMPLT(a,b)     vcltq_s16(a, b)
+#define VCMPGT(a,b)     vcgtq_s16(a, b)
+#define VMAND(a,b)      vandq_u16(a, b)
+#define VBLEND(m,a,b)   vbslq_s16(m, a, b)
+
+#endif
@@ -23,6 +23,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
 #include "config.h"
 #if HAVE_STDINT_H
 #include <stdint.h>
@@ -50,6 +52,16 @@
 
 #include "aclib.h"
 
+#if ARCH_X86 && defined(__GNUC__)
+#include <immintrin.h>
+#define YADIF_SSE2 HAVE_SSE2
+#define YADIF_AVX2 HAVE_AVX2
+#endif
+#if (ARCH_ARM || ARCH_AARCH64) && HAVE_INTRINSICS_NEON
+#include <arm_neon.h>
+#define YADIF_NEON 1
+#endif
+
 static void* (*fast_memcpy)(void * to, const void * from, size_t len);
 
 struct DeintThread
@@ -71,6 +83,8 @@ typedef struct ThisFilter
     int         actual_threads;
     int         requested_threads;
     pthread_mutex_t mutex;
+    pthread_cond_t  start_cond;
+    pthread_cond_t  done_cond;
 
     long long last_framenr;
 
@@ -443,6 +457,34 @@ static void filter_line_c(struct ThisFilter *p, uint8_t *dst,
         next2++;
     }
 }
+#undef CHECK
+
+#if YADIF_SSE2
+#define SIMD_SSE2
+#define RENAME(a) a ## _sse2
+#include "../mm_simd.h"
+#include "yadif_template.c"
+#undef RENAME
+#undef SIMD_SSE2
+#endif
+
+#if YADIF_AVX2
+#define SIMD_AVX2
+#define RENAME(a) a ## _avx2
+#include "../mm_simd.h"
+#include "yadif_template.c"
+#undef RENAME
+#undef SIMD_AVX2
+#endif
+
+#if YADIF_NEON
+#define SIMD_NEON
+#define RENAME(a) a ## _neon
+#include "../mm_simd.h"
+#include "yadif_template.c"
+#undef RENAME
+#undef SIMD_NEON
+#endif
 
 static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
                         int dst_stride[3], int width, int height, int parity,
@@ -517,17 +559,28 @@ static int YadifDeint (VideoFilter * f, VideoFrame * frame, int field)
     else
     {
         int i;
+        struct timeval now;
+        struct timespec timeout;
+
+        pthread_mutex_lock(&(filter->mutex));
         for (i = 0; i < filter->actual_threads; i++)
             filter->threads[i].ready = 1;
         filter->field = field;
         filter->frame = frame;
         filter->ready = filter->actual_threads;
-        i = 0;
-        while (filter->ready > 0 && i < 1000)
+        pthread_cond_broadcast(&(filter->start_cond));
+
+        // don't wait more than a second for a stuck slice
+        gettimeofday(&now, NULL);
+        timeout.tv_sec  = now.tv_sec + 1;
+        timeout.tv_nsec = now.tv_usec * 1000;
+        while (filter->ready > 0)
         {
-            usleep(1000);
-            i++;
+            if (pthread_cond_timedwait(&(filter->done_cond), &(filter->mutex),
+                                       &timeout) == ETIMEDOUT)
+                break;
         }
+        pthread_mutex_unlock(&(filter->mutex));
     }
 
     filter->last_framenr = frame->frameNumber;
@@ -543,11 +596,17 @@ static void CleanupYadifDeintFilter (VideoFilter * filter)
 
     if (f->threads != NULL)
     {
+        pthread_mutex_lock(&(f->mutex));
         f->kill_threads = 1;
+        pthread_cond_broadcast(&(f->start_cond));
+        pthread_mutex_unlock(&(f->mutex));
         for (i = 0; i < f->requested_threads; i++)
             if (f->threads[i].exists)
                 pthread_join(f->threads[i].id, NULL);
         free(f->threads);
+        pthread_cond_destroy(&(f->start_cond));
+        pthread_cond_destroy(&(f->done_cond));
+        pthread_mutex_destroy(&(f->mutex));
     }
 
     for (i = 0; i < 3*3; i++)
@@ -565,27 +624,34 @@ static void *YadifThread(void *args)
     pthread_mutex_lock(&(filter->mutex));
     int num = filter->actual_threads;
     filter->actual_threads = num + 1;
-    pthread_mutex_unlock(&(filter->mutex));
 
     while (!filter->kill_threads)
     {
-        usleep(1000);
-        if (filter->ready &&
-            filter->frame != NULL &&
-            filter->threads[num].ready)
+        if (!filter->ready ||
+            filter->frame == NULL ||
+            !filter->threads[num].ready)
         {
-            filter_func(
-                filter, filter->frame->buf, filter->frame->offsets,
-                filter->frame->pitches, filter->frame->width,
-                filter->frame->height, filter->field,
-                filter->frame->top_field_first, num, filter->actual_threads);
-
-            pthread_mutex_lock(&(filter->mutex));
-            filter->ready = filter->ready - 1;
-            filter->threads[num].ready = 0;
-            pthread_mutex_unlock(&(filter->mutex));
+            pthread_cond_wait(&(filter->start_cond), &(filter->mutex));
+            continue;
         }
+
+        VideoFrame *frame = filter->frame;
+        int field  = filter->field;
+        int slices = filter->actual_threads;
+        pthread_mutex_unlock(&(filter->mutex));
+
+        filter_func(
+            filter, frame->buf, frame->offsets, frame->pitches,
+            frame->width, frame->height, field,
+            frame->top_field_first, num, slices);
+
+        pthread_mutex_lock(&(filter->mutex));
+        filter->ready = filter->ready - 1;
+        filter->threads[num].ready = 0;
+        if (filter->ready <= 0)
+            pthread_cond_signal(&(filter->done_cond));
     }
+    pthread_mutex_unlock(&(filter->mutex));
     pthread_exit(NULL);
     return NULL;
 }
@@ -623,11 +689,23 @@ static VideoFilter * YadifDeintFilter(VideoFrameType inpixfmt,
 #endif
 
     filter->filter_line = filter_line_c;
+#if YADIF_NEON
+    if (av_get_cpu_flags() & AV_CPU_FLAG_NEON)
+        filter->filter_line = filter_line_neon;
+#endif
 #if HAVE_MMX
     if (filter->mm_flags & AV_CPU_FLAG_MMX)
     {
         filter->filter_line = filter_line_mmx2;
     }
+#if YADIF_SSE2
+    if (filter->mm_flags & AV_CPU_FLAG_SSE2)
+        filter->filter_line = filter_line_sse2;
+#endif
+#if YADIF_AVX2
+    if (filter->mm_flags & AV_CPU_FLAG_AVX2)
+        filter->filter_line = filter_line_avx2;
+#endif
 
     if (filter->mm_flags & AV_CPU_FLAG_SSE2)
         fast_memcpy=fast_memcpy_SSE;
@@ -667,6 +745,8 @@ static VideoFilter * YadifDeintFilter(VideoFrameType inpixfmt,
     if (filter->requested_threads > 1)
     {
         pthread_mutex_init(&(filter->mutex), NULL);
+        pthread_cond_init(&(filter->start_cond), NULL);
+        pthread_cond_init(&(filter->done_cond), NULL);
         int success = 0;
         for (int i = 0; i < filter->requested_threads; i++)
         {
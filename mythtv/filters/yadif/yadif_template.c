@@ -0,0 +1,89 @@
+/*
+ * Yadif vector line filter
+ *
+ * Vector form of filter_line_c(), instantiated once per instruction set
+ * from filter_yadif.c; see ../mm_simd.h for the operations.  Results are
+ * identical to the C version, including only trying the second direction
+ * when the first one scored better.
+ */
+
+SIMD_TARGET
+static void RENAME(filter_line)(struct ThisFilter *p, uint8_t *dst,
+                                uint8_t *prev, uint8_t *cur, uint8_t *next,
+                                int w, int refs, int parity)
+{
+    uint8_t *prev2= parity ? prev : cur ;
+    uint8_t *next2= parity ? cur  : next;
+    const VEC zero = VSET1(0);
+    const VEC one  = VSET1(1);
+    int x;
+
+#define SCORE(j) \
+    VADD(VADD(VABSDIFF(VLOAD(&cur[x-refs-1+(j)]), VLOAD(&cur[x+refs-1-(j)])), \
+              VABSDIFF(VLOAD(&cur[x-refs  +(j)]), VLOAD(&cur[x+refs  -(j)]))), \
+              VABSDIFF(VLOAD(&cur[x-refs+1+(j)]), VLOAD(&cur[x+refs+1-(j)])))
+#define PRED(j) \
+    VSRA(VADD(VLOAD(&cur[x-refs+(j)]), VLOAD(&cur[x+refs-(j)])), 1)
+#define CHECK(j, mask) \
+    {\
+        VEC score= SCORE(j);\
+        better= mask(VCMPLT(score, spatial_score));\
+        spatial_score= VBLEND(better, score, spatial_score);\
+        spatial_pred= VBLEND(better, PRED(j), spatial_pred);\
+    }
+#define FIRST(m)  (m)
+#define NESTED(m) VMAND(better, m)
+
+    for (x=0; x+VWIDTH<=w; x+=VWIDTH)
+    {
+        VEC c= VLOAD(&cur[x-refs]);
+        VEC e= VLOAD(&cur[x+refs]);
+        VEC p2= VLOAD(&prev2[x]);
+        VEC n2= VLOAD(&next2[x]);
+        VEC d= VSRA(VADD(p2, n2), 1);
+        VEC temporal_diff0= VABSDIFF(p2, n2);
+        VEC temporal_diff1= VSRA(VADD(VABSDIFF(VLOAD(&prev[x-refs]), c),
+                                      VABSDIFF(VLOAD(&prev[x+refs]), e)), 1);
+        VEC temporal_diff2= VSRA(VADD(VABSDIFF(VLOAD(&next[x-refs]), c),
+                                      VABSDIFF(VLOAD(&next[x+refs]), e)), 1);
+        VEC diff= VMAX(VMAX(VSRA(temporal_diff0, 1), temporal_diff1),
+                       temporal_diff2);
+        VEC spatial_pred= VSRA(VADD(c, e), 1);
+        VEC spatial_score=
+            VSUB(VADD(VADD(VABSDIFF(VLOAD(&cur[x-refs-1]),
+                                    VLOAD(&cur[x+refs-1])),
+                           VABSDIFF(c, e)),
+                      VABSDIFF(VLOAD(&cur[x-refs+1]), VLOAD(&cur[x+refs+1]))),
+                 one);
+        VMASK better;
+
+        CHECK(-1, FIRST) CHECK(-2, NESTED)
+        CHECK( 1, FIRST) CHECK( 2, NESTED)
+
+        VEC b= VSRA(VADD(VLOAD(&prev2[x-2*refs]), VLOAD(&next2[x-2*refs])), 1);
+        VEC f= VSRA(VADD(VLOAD(&prev2[x+2*refs]), VLOAD(&next2[x+2*refs])), 1);
+        VEC de= VSUB(d, e);
+        VEC dc= VSUB(d, c);
+        VEC bc= VSUB(b, c);
+        VEC fe= VSUB(f, e);
+        VEC max= VMAX(VMAX(de, dc), VMIN(bc, fe));
+        VEC min= VMIN(VMIN(de, dc), VMAX(bc, fe));
+        diff= VMAX(VMAX(diff, min), VSUB(zero, max));
+
+        spatial_pred= VMIN(VMAX(spatial_pred, VSUB(d, diff)), VADD(d, diff));
+
+        VSTORE(&dst[x], spatial_pred);
+    }
+
+#undef SCORE
+#undef PRED
+#undef CHECK
+#undef FIRST
+#undef NESTED
+
+    if (x < w)
+        filter_line_c(p, dst + x, prev + x, cur + x, next + x,
+                      w - x, refs, parity);
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
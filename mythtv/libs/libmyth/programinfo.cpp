@@ -3746,6 +3746,9 @@ void ProgramInfo::ClearPositionMap(MarkTypes type) const
         return;
     }
 
+    // Deltas are written asynchronously, don't let one land after this
+    MSqlQuery::FlushQueuedWrites();
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     if (IsVideo())
@@ -3823,6 +3826,8 @@ void ProgramInfo::SavePositionMap(
         return;
     }
 
+    MSqlQuery::FlushQueuedWrites();
+
     MSqlQuery query(MSqlQuery::InitCon());
     QString comp;
 
@@ -3982,12 +3987,8 @@ void ProgramInfo::SavePositionMapDelta(
         q << qfields << QString("%1,%2)").arg(frame).arg(offset);
     }
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare(q.join(""));
-    if (!query.exec())
-    {
-        MythDB::DBError("delta position map insert", query);
-    }
+    // Recorders save these every few seconds, nobody waits on them
+    MSqlQuery::QueueWrite(q.join(""));
 }
 
 static const char *from_filemarkup_offset_asc =
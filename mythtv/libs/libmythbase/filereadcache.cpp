@@ -0,0 +1,296 @@
+// POSIX headers
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// Qt headers
+#include <QMutexLocker>
+#include <QFileInfo>
+
+// MythTV headers
+#include "filereadcache.h"
+
+#ifndef _WIN32
+/// Reads up to size bytes from offset, fewer only at the end of the file.
+static qint64 read_at(int fd, char *data, qint64 size, qint64 offset,
+                      bool &ok)
+{
+    qint64 got = 0;
+
+    ok = true;
+
+    while (got < size)
+    {
+        ssize_t ret = pread(fd, data + got, size - got, offset + got);
+        if (ret < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            ok = (got > 0);
+            break;
+        }
+
+        if (ret == 0)
+            break;
+
+        got += ret;
+    }
+
+    return got;
+}
+#endif
+
+static QMutex         s_singletonLock;
+static FileReadCache *s_singleton = NULL;
+
+FileReadCache *FileReadCache::GetSingleton(void)
+{
+    QMutexLocker locker(&s_singletonLock);
+
+    if (!s_singleton)
+        s_singleton = new FileReadCache();
+
+    return s_singleton;
+}
+
+FileReadCache::FileReadCache(qint64 chunkSize, qint64 maxBytes) :
+    m_chunkSize(chunkSize), m_maxBytes(maxBytes),
+    m_bytes(0), m_useCount(0)
+{
+}
+
+/** \fn FileReadCache::AddReader(const QString&,int)
+ *  \brief Registers a reader of filename, which it has open as fd.
+ *
+ *  The key includes the device and inode of fd, so only readers of the
+ *  very same file share chunks, even if filename has since been replaced.
+ *
+ *  \return The key to pass to the other methods, or an empty string if
+ *          the cache can't be used for this file.
+ */
+QString FileReadCache::AddReader(const QString &filename, int fd)
+{
+#ifdef _WIN32
+    // No pread(), so we can't read without moving the caller's position
+    (void) filename;
+    (void) fd;
+    return QString();
+#else
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+        return QString();
+
+    QFileInfo fi(filename);
+    QString   key = fi.canonicalFilePath();
+
+    if (key.isEmpty())
+        key = fi.absoluteFilePath();
+
+    key += QString(":%1:%2").arg((qulonglong)st.st_dev)
+                            .arg((qulonglong)st.st_ino);
+
+    QMutexLocker locker(&m_lock);
+    ++m_readers[key];
+
+    return key;
+#endif
+}
+
+void FileReadCache::RemoveReader(const QString &key)
+{
+    if (key.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, int>::iterator rit = m_readers.find(key);
+    if (rit == m_readers.end())
+        return;
+
+    if (--(*rit) > 0)
+        return;
+
+    m_readers.erase(rit);
+
+    // Last one out, chunks still being loaded are left to their loaders
+    QHash<ChunkKey, Chunk>::iterator it = m_chunks.begin();
+    while (it != m_chunks.end())
+    {
+        if (it.key().first == key && !it->loading)
+        {
+            m_bytes -= it->data.size();
+            it = m_chunks.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+/// Returns true if more than one reader has the file open.
+bool FileReadCache::IsShared(const QString &key)
+{
+    if (key.isEmpty())
+        return false;
+
+    QMutexLocker locker(&m_lock);
+
+    return m_readers.value(key) > 1;
+}
+
+qint64 FileReadCache::GetCachedBytes(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_bytes;
+}
+
+/** \fn FileReadCache::Read(const QString&,int,qint64,char*,qint64)
+ *  \brief Reads size bytes from offset, through the cache.
+ *
+ *  fd is only used with pread() to load missing chunks, so its position
+ *  is left alone.
+ *
+ *  \return Bytes read, fewer than size at the end of the file, or -1 if
+ *          nothing could be read.
+ */
+qint64 FileReadCache::Read(const QString &key, int fd, qint64 offset,
+                           char *data, qint64 size)
+{
+    qint64 copied    = 0;
+    qint64 fullBytes = -1; // end of the last complete chunk, if known
+
+#ifndef _WIN32
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0)
+        fullBytes = (st.st_size / m_chunkSize) * m_chunkSize;
+#endif
+
+    while (copied < size)
+    {
+        qint64 pos    = offset + copied;
+        qint64 within = pos % m_chunkSize;
+        bool   ok     = false;
+
+#ifndef _WIN32
+        if (fullBytes >= 0 && pos >= fullBytes)
+        {
+            // The last chunk isn't kept while the file may still grow, so
+            // read just what was asked for rather than the whole chunk
+            qint64 got = read_at(fd, data + copied, size - copied, pos, ok);
+            if (!ok)
+                return (copied > 0) ? copied : -1;
+            copied += got;
+            break;
+        }
+#endif
+
+        QByteArray chunk = GetChunk(key, fd, pos / m_chunkSize, ok);
+
+        if (!ok)
+            return (copied > 0) ? copied : -1;
+
+        qint64 available = chunk.size() - within;
+        if (available <= 0)
+            break;
+
+        qint64 count = size - copied;
+        if (count > available)
+            count = available;
+
+        memcpy(data + copied, chunk.constData() + within, count);
+        copied += count;
+
+        if (chunk.size() < m_chunkSize)
+            break; // end of file, for now at least
+    }
+
+    return copied;
+}
+
+QByteArray FileReadCache::GetChunk(const QString &key, int fd, qint64 chunk,
+                                   bool &ok)
+{
+    ChunkKey chunkKey(key, chunk);
+
+    QMutexLocker locker(&m_lock);
+
+    while (true)
+    {
+        QHash<ChunkKey, Chunk>::iterator it = m_chunks.find(chunkKey);
+        if (it == m_chunks.end())
+            break;
+
+        if (!it->loading)
+        {
+            it->lastUsed = ++m_useCount;
+            ok = true;
+            return it->data;
+        }
+
+        // Another reader is loading it, which is the point of the cache
+        m_loaded.wait(&m_lock);
+    }
+
+    m_chunks[chunkKey].loading = true;
+
+    locker.unlock();
+
+    QByteArray data(m_chunkSize, Qt::Uninitialized);
+    qint64     got = 0;
+
+#ifndef _WIN32
+    got = read_at(fd, data.data(), m_chunkSize, chunk * m_chunkSize, ok);
+#else
+    (void) fd;
+    ok = false;
+#endif
+
+    data.resize(got);
+
+    locker.relock();
+
+    QHash<ChunkKey, Chunk>::iterator it = m_chunks.find(chunkKey);
+    if (it != m_chunks.end() && it->loading)
+    {
+        if (got == m_chunkSize && m_readers.contains(key))
+        {
+            it->data     = data;
+            it->loading  = false;
+            it->lastUsed = ++m_useCount;
+            m_bytes     += got;
+            Prune();
+        }
+        else
+            m_chunks.erase(it);
+    }
+
+    m_loaded.wakeAll();
+
+    return data;
+}
+
+/// Drops the least recently used chunks. Must be called with m_lock held.
+void FileReadCache::Prune(void)
+{
+    while (m_bytes > m_maxBytes)
+    {
+        QHash<ChunkKey, Chunk>::iterator it     = m_chunks.begin();
+        QHash<ChunkKey, Chunk>::iterator oldest = m_chunks.end();
+
+        for (; it != m_chunks.end(); ++it)
+        {
+            if (it->loading)
+                continue;
+
+            if (oldest == m_chunks.end() || it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+
+        if (oldest == m_chunks.end())
+            return;
+
+        m_bytes -= oldest->data.size();
+        m_chunks.erase(oldest);
+    }
+}
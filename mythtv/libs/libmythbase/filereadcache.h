@@ -0,0 +1,78 @@
+#ifndef FILEREADCACHE_H_
+#define FILEREADCACHE_H_
+
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+
+#include "mythbaseexp.h"
+
+/** \class FileReadCache
+ *  \brief Read-ahead shared by everyone streaming the same file.
+ *
+ *  When several clients play the same recording each reads its own part of
+ *  it and the disk seeks back and forth between them.  Readers registered
+ *  here for the same file read it in large aligned chunks instead, which
+ *  are kept for the others, so each chunk only comes off the disk once.
+ *  The cache only pays while a file has more than one reader, so callers
+ *  check IsShared() and read the file themselves otherwise.
+ *
+ *  Readers are matched by the file they have open rather than by name, so
+ *  a file that is replaced while someone still streams the old one isn't
+ *  served from the old one's chunks.
+ *
+ *  Only complete chunks are kept, a recording that is still being written
+ *  is cached up to its last full chunk and read directly past it.  A file's
+ *  chunks are dropped along
+ *  with its last reader, and the least recently used chunks go first once
+ *  the cache is full.
+ */
+class MBASE_PUBLIC FileReadCache
+{
+  public:
+    static FileReadCache *GetSingleton(void);
+
+    FileReadCache(qint64 chunkSize = 1024 * 1024,
+                  qint64 maxBytes  = 64 * 1024 * 1024);
+
+    QString AddReader(const QString &filename, int fd);
+    void    RemoveReader(const QString &key);
+    bool    IsShared(const QString &key);
+
+    qint64  Read(const QString &key, int fd, qint64 offset,
+                 char *data, qint64 size);
+
+    qint64  GetChunkSize(void) const { return m_chunkSize; }
+    qint64  GetCachedBytes(void);
+
+  private:
+    typedef QPair<QString, qint64> ChunkKey; // reader key, chunk number
+
+    class Chunk
+    {
+      public:
+        Chunk() : loading(false), lastUsed(0) {}
+
+        QByteArray data;
+        bool       loading;
+        quint64    lastUsed;
+    };
+
+    QByteArray GetChunk(const QString &key, int fd, qint64 chunk, bool &ok);
+    void       Prune(void);
+
+    const qint64 m_chunkSize;
+    const qint64 m_maxBytes;
+
+    QMutex                   m_lock;
+    QWaitCondition           m_loaded;
+    QHash<QString, int>      m_readers;
+    QHash<ChunkKey, Chunk>   m_chunks;
+    qint64                   m_bytes;
+    quint64                  m_useCount;
+};
+
+#endif
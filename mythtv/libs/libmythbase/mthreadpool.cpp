@@ -115,6 +115,10 @@ class MPoolThread : public MThread
     {
         RunProlog();
 
+        // Pool threads can be many at once, so they wait for a DB
+        // connection when there are too many rather than open another
+        GetMythDB()->GetDBManager()->AllowConnectionWait();
+
         MythTimer t;
         t.start();
         QMutexLocker locker(&m_lock);
@@ -174,6 +174,8 @@ MythCoreContextPrivate::~MythCoreContextPrivate()
 
     MThreadPool::ShutdownAllPools();
 
+    GetMythDB()->GetDBManager()->StopQueuedWrites();
+
     ShutdownMythSystemLegacy();
 
     ShutdownMythDownloadManager();
@@ -818,6 +820,17 @@ void MythCoreContext::ClearSettingsCache(const QString &myKey)
     d->m_database->ClearSettingsCache(myKey);
 }
 
+/** \brief Tells the backend and its clients that a setting has changed
+ *
+ *  Unlike CLEAR_SETTINGS_CACHE only the one setting is dropped from their
+ *  settings caches. An empty host means the global setting.
+ */
+void MythCoreContext::SendSettingChanged(const QString &key,
+                                         const QString &host)
+{
+    SendMessage(QString("SETTING_CHANGED %1 %2").arg(key).arg(host));
+}
+
 void MythCoreContext::ActivateSettingsCache(bool activate)
 {
     d->m_database->ActivateSettingsCache(activate);
@@ -1530,6 +1543,29 @@ void MythCoreContext::readyRead(MythSocket *sock)
             LOG(VB_NETWORK, LOG_INFO, LOC + "Received remote 'Clear Cache' request");
             ClearSettingsCache();
         }
+        else if (message.startsWith("SETTING_CHANGED"))
+        {
+            if (tokens.size() < 2)
+            {
+                LOG(VB_NETWORK, LOG_ERR, LOC +
+                    "SETTING_CHANGED event received without a setting");
+                return;
+            }
+
+            QString key = tokens[1];
+            if (tokens.size() > 2)
+                key = tokens[2] + ' ' + key;
+
+            LOG(VB_NETWORK, LOG_INFO, LOC +
+                QString("Received remote 'SETTING_CHANGED %1' request")
+                    .arg(key));
+            ClearSettingsCache(key);
+
+            strlist.pop_front();
+            strlist.pop_front();
+            MythEvent me(message, strlist);
+            dispatch(me);
+        }
         else if (message.startsWith("FILE_WRITTEN"))
         {
             QString file;
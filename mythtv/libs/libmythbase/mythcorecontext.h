@@ -188,6 +188,8 @@ class MBASE_PUBLIC MythCoreContext : public QObject, public MythObservable, publ
     bool CheckSubnet(const QHostAddress &addr);
 
     void ClearSettingsCache(const QString &myKey = QString(""));
+    void SendSettingChanged(const QString &key,
+                            const QString &host = QString());
     void ActivateSettingsCache(bool activate = true);
     void OverrideSettingForSession(const QString &key, const QString &value);
     void ClearOverrideSettingForSession(const QString &key);
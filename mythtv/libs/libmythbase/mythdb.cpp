@@ -1,9 +1,10 @@
 #include <vector>
 using namespace std;
 
-#include <QReadWriteLock>
+#include <QThreadStorage>
 #include <QTextStream>
 #include <QSqlError>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QFile>
 #include <QHash>
@@ -62,12 +63,36 @@ struct SingleSetting
 
 typedef QHash<QString,QString> SettingsMap;
 
+/// The settings as seen by readers. Both maps are implicitly shared, so a
+/// copy is cheap and isn't affected by later changes to the original.
+struct SettingsSnapshot
+{
+    /// Permanent settings in the DB and overridden settings
+    SettingsMap cache;
+    /// Overridden this session only
+    SettingsMap overrides;
+};
+
+/// A thread's copy of the settings and the generation it was taken at
+struct LocalSettingsSnapshot
+{
+    LocalSettingsSnapshot() : generation(-1) {}
+
+    SettingsSnapshot snapshot;
+    int generation;
+};
+
 class MythDBPrivate
 {
   public:
     MythDBPrivate();
    ~MythDBPrivate();
 
+    const SettingsSnapshot &GetSettingsSnapshot(void);
+    /// Makes changes to settings visible to readers, call with
+    /// settingsCacheLock held
+    void PublishSettings(void) { settingsGeneration.ref(); }
+
     DatabaseParams  m_DBparams;  ///< Current database host & WOL details
     QString m_localhostname;
     MDBManager m_dbmanager;
@@ -75,12 +100,14 @@ class MythDBPrivate
     bool ignoreDatabase;
     bool suppressDBMessages;
 
-    QReadWriteLock settingsCacheLock;
+    /// Serializes changes to settings, readers don't take it
+    QMutex settingsCacheLock;
     volatile bool useSettingsCache;
-    /// Permanent settings in the DB and overridden settings
-    SettingsMap settingsCache;
-    /// Overridden this session only
-    SettingsMap overriddenSettings;
+    /// The latest settings, readers work from their own copy of it
+    SettingsSnapshot settings;
+    /// Moves on whenever settings changes
+    QAtomicInt settingsGeneration;
+    QThreadStorage<LocalSettingsSnapshot> localSettings;
     /// Settings which should be written to the database as soon as it becomes
     /// available
     QList<SingleSetting> delayedSettings;
@@ -96,7 +123,7 @@ MythDBPrivate::MythDBPrivate() :
     haveDBConnection(false), haveSchema(false)
 {
     m_localhostname.clear();
-    settingsCache.reserve(settings_reserve);
+    settings.cache.reserve(settings_reserve);
 }
 
 MythDBPrivate::~MythDBPrivate()
@@ -104,6 +131,27 @@ MythDBPrivate::~MythDBPrivate()
     LOG(VB_DATABASE, LOG_INFO, "Destroying MythDBPrivate");
 }
 
+/** \brief Returns this thread's copy of the settings.
+ *
+ *  The copy is only refreshed, under the lock, when the settings have
+ *  changed since it was taken; otherwise reading settings costs one atomic
+ *  load and doesn't contend with other readers. The reference is valid until
+ *  the next call from this thread.
+ */
+const SettingsSnapshot &MythDBPrivate::GetSettingsSnapshot(void)
+{
+    LocalSettingsSnapshot &local = localSettings.localData();
+
+    if (local.generation != settingsGeneration.loadAcquire())
+    {
+        QMutexLocker locker(&settingsCacheLock);
+        local.snapshot   = settings;
+        local.generation = settingsGeneration.load();
+    }
+
+    return local.snapshot;
+}
+
 MythDB::MythDB()
 {
     d = new MythDBPrivate();
@@ -366,25 +414,16 @@ QString MythDB::GetSetting(const QString &_key, const QString &defaultval)
     QString key = _key.toLower();
     QString value = defaultval;
 
-    d->settingsCacheLock.lockForRead();
+    const SettingsSnapshot &snapshot = d->GetSettingsSnapshot();
     if (d->useSettingsCache)
     {
-        SettingsMap::const_iterator it = d->settingsCache.find(key);
-        if (it != d->settingsCache.end())
-        {
-            value = *it;
-            d->settingsCacheLock.unlock();
-            return value;
-        }
-    }
-    SettingsMap::const_iterator it = d->overriddenSettings.find(key);
-    if (it != d->overriddenSettings.end())
-    {
-        value = *it;
-        d->settingsCacheLock.unlock();
-        return value;
+        SettingsMap::const_iterator it = snapshot.cache.find(key);
+        if (it != snapshot.cache.end())
+            return *it;
     }
-    d->settingsCacheLock.unlock();
+    SettingsMap::const_iterator it = snapshot.overrides.find(key);
+    if (it != snapshot.overrides.end())
+        return *it;
 
     if (d->ignoreDatabase || !HaveValidDatabase())
         return value;
@@ -422,11 +461,14 @@ QString MythDB::GetSetting(const QString &_key, const QString &defaultval)
     {
         key.squeeze();
         value.squeeze();
-        d->settingsCacheLock.lockForWrite();
+        d->settingsCacheLock.lock();
         // another thread may have inserted a value into the cache
         // while we did not have the lock, check first then save
-        if (d->settingsCache.find(key) == d->settingsCache.end())
-            d->settingsCache[key] = value;
+        if (!d->settings.cache.contains(key))
+        {
+            d->settings.cache[key] = value;
+            d->PublishSettings();
+        }
         d->settingsCacheLock.unlock();
     }
 
@@ -446,13 +488,14 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
 
     {
         uint done_cnt = 0;
-        d->settingsCacheLock.lockForRead();
+        // A copy, GetSetting() below may refresh this thread's snapshot
+        SettingsSnapshot snapshot = d->GetSettingsSnapshot();
         if (d->useSettingsCache)
         {
             for (; kvit != _key_value_pairs.end(); ++dit, ++kvit)
             {
-                SettingsMap::const_iterator it = d->settingsCache.find(dit.key());
-                if (it != d->settingsCache.end())
+                SettingsMap::const_iterator it = snapshot.cache.find(dit.key());
+                if (it != snapshot.cache.end())
                 {
                     *kvit = *it;
                     *dit = true;
@@ -463,15 +506,14 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
         for (; kvit != _key_value_pairs.end(); ++dit, ++kvit)
         {
             SettingsMap::const_iterator it =
-                d->overriddenSettings.find(dit.key());
-            if (it != d->overriddenSettings.end())
+                snapshot.overrides.find(dit.key());
+            if (it != snapshot.overrides.end())
             {
                 *kvit = *it;
                 *dit = true;
                 done_cnt++;
             }
         }
-        d->settingsCacheLock.unlock();
 
         // Avoid extra work if everything was in the caches and
         // also don't try to access the DB if ignoreDatabase is set
@@ -532,7 +574,7 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
 
     if (d->useSettingsCache)
     {
-        d->settingsCacheLock.lockForWrite();
+        d->settingsCacheLock.lock();
         QMap<QString,KVIt>::const_iterator it = keymap.begin();
         for (; it != keymap.end(); ++it)
         {
@@ -540,13 +582,14 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
 
             // another thread may have inserted a value into the cache
             // while we did not have the lock, check first then save
-            if (d->settingsCache.find(key) == d->settingsCache.end())
+            if (!d->settings.cache.contains(key))
             {
                 key.squeeze();
                 value.squeeze();
-                d->settingsCache[key] = value;
+                d->settings.cache[key] = value;
             }
         }
+        d->PublishSettings();
         d->settingsCacheLock.unlock();
     }
 
@@ -599,25 +642,16 @@ QString MythDB::GetSettingOnHost(const QString &_key, const QString &_host,
     QString value = defaultval;
     QString myKey = host + ' ' + key;
 
-    d->settingsCacheLock.lockForRead();
+    const SettingsSnapshot &snapshot = d->GetSettingsSnapshot();
     if (d->useSettingsCache)
     {
-        SettingsMap::const_iterator it = d->settingsCache.find(myKey);
-        if (it != d->settingsCache.end())
-        {
-            value = *it;
-            d->settingsCacheLock.unlock();
-            return value;
-        }
-    }
-    SettingsMap::const_iterator it = d->overriddenSettings.find(myKey);
-    if (it != d->overriddenSettings.end())
-    {
-        value = *it;
-        d->settingsCacheLock.unlock();
-        return value;
+        SettingsMap::const_iterator it = snapshot.cache.find(myKey);
+        if (it != snapshot.cache.end())
+            return *it;
     }
-    d->settingsCacheLock.unlock();
+    SettingsMap::const_iterator it = snapshot.overrides.find(myKey);
+    if (it != snapshot.overrides.end())
+        return *it;
 
     if (d->ignoreDatabase)
         return value;
@@ -648,9 +682,12 @@ QString MythDB::GetSettingOnHost(const QString &_key, const QString &_host,
     {
         myKey.squeeze();
         value.squeeze();
-        d->settingsCacheLock.lockForWrite();
-        if (d->settingsCache.find(myKey) == d->settingsCache.end())
-            d->settingsCache[myKey] = value;
+        d->settingsCacheLock.lock();
+        if (!d->settings.cache.contains(myKey))
+        {
+            d->settings.cache[myKey] = value;
+            d->PublishSettings();
+        }
         d->settingsCacheLock.unlock();
     }
 
@@ -783,10 +820,11 @@ void MythDB::OverrideSettingForSession(
     mk2.squeeze();
     mv.squeeze();
 
-    d->settingsCacheLock.lockForWrite();
-    d->overriddenSettings[mk] = mv;
-    d->settingsCache[mk]      = mv;
-    d->settingsCache[mk2]     = mv;
+    d->settingsCacheLock.lock();
+    d->settings.overrides[mk] = mv;
+    d->settings.cache[mk]     = mv;
+    d->settings.cache[mk2]    = mv;
+    d->PublishSettings();
     d->settingsCacheLock.unlock();
 }
 
@@ -796,36 +834,29 @@ void MythDB::ClearOverrideSettingForSession(const QString &key)
     QString mk = key.toLower();
     QString mk2 = d->m_localhostname + ' ' + mk;
 
-    d->settingsCacheLock.lockForWrite();
-
-    SettingsMap::iterator oit = d->overriddenSettings.find(mk);
-    if (oit != d->overriddenSettings.end())
-        d->overriddenSettings.erase(oit);
-
-    SettingsMap::iterator sit = d->settingsCache.find(mk);
-    if (sit != d->settingsCache.end())
-        d->settingsCache.erase(sit);
+    d->settingsCacheLock.lock();
 
-    sit = d->settingsCache.find(mk2);
-    if (sit != d->settingsCache.end())
-        d->settingsCache.erase(sit);
+    d->settings.overrides.remove(mk);
+    d->settings.cache.remove(mk);
+    d->settings.cache.remove(mk2);
+    d->PublishSettings();
 
     d->settingsCacheLock.unlock();
 }
 
-static void clear(
-    SettingsMap &cache, SettingsMap &overrides, const QString &myKey)
+static bool clear(
+    SettingsMap &cache, const SettingsMap &overrides, const QString &myKey)
 {
     // Do the actual clearing..
-    SettingsMap::iterator it = cache.find(myKey);
-    if (it != cache.end())
+    if (cache.contains(myKey))
     {
         SettingsMap::const_iterator oit = overrides.find(myKey);
         if (oit == overrides.end())
         {
             LOG(VB_DATABASE, LOG_INFO,
                     QString("Clearing Settings Cache for '%1'.").arg(myKey));
-            cache.erase(it);
+            cache.remove(myKey);
+            return true;
         }
         else
         {
@@ -834,37 +865,51 @@ static void clear(
                     .arg(myKey));
         }
     }
+
+    return false;
 }
 
+/** \brief Drops the given setting, or all of them, from the settings cache.
+ *
+ *  Readers keep using their copy of the cache until their next read, when
+ *  they pick up the change; clearing a single key leaves the rest of the
+ *  cache intact.
+ */
 void MythDB::ClearSettingsCache(const QString &_key)
 {
-    d->settingsCacheLock.lockForWrite();
+    d->settingsCacheLock.lock();
 
     if (_key.isEmpty())
     {
         LOG(VB_DATABASE, LOG_INFO, "Clearing Settings Cache.");
-        d->settingsCache.clear();
-        d->settingsCache.reserve(settings_reserve);
+        SettingsMap cache;
+        cache.reserve(settings_reserve);
 
-        SettingsMap::const_iterator it = d->overriddenSettings.begin();
-        for (; it != d->overriddenSettings.end(); ++it)
+        SettingsMap::const_iterator it = d->settings.overrides.begin();
+        for (; it != d->settings.overrides.end(); ++it)
         {
             QString mk2 = d->m_localhostname + ' ' + it.key();
             mk2.squeeze();
 
-            d->settingsCache[it.key()] = *it;
-            d->settingsCache[mk2] = *it;
+            cache[it.key()] = *it;
+            cache[mk2] = *it;
         }
+
+        d->settings.cache = cache;
+        d->PublishSettings();
     }
     else
     {
         QString myKey = _key.toLower();
-        clear(d->settingsCache, d->overriddenSettings, myKey);
+        bool changed = clear(d->settings.cache, d->settings.overrides, myKey);
 
         // To be safe always clear any local[ized] version too
         QString mkl = myKey.section(QChar(' '), 1);
         if (!mkl.isEmpty())
-            clear(d->settingsCache, d->overriddenSettings, mkl);
+            changed |= clear(d->settings.cache, d->settings.overrides, mkl);
+
+        if (changed)
+            d->PublishSettings();
     }
 
     d->settingsCacheLock.unlock();
@@ -3,7 +3,11 @@
 // ANSI C
 #include <cstdlib>
 
+// C++
+#include <algorithm>
+
 // Qt
+#include <QPair>
 #include <QVector>
 #include <QSqlDriver>
 #include <QSemaphore>
@@ -32,6 +36,23 @@
 
 static const uint kPurgeTimeout = 60 * 60;
 
+/// Connections MDBManager opens before reaping idle ones, or making
+/// threads that may wait wait for one
+static const int kMaxConnections = 64;
+/// How long to wait for a connection (ms) before opening one over the limit
+static const int kConnectionWaitTimeout = 5000;
+
+/// Queued writes run together in one batch
+static const int kWriteBatchSize = 200;
+/// How long the writer waits for a batch to fill (ms)
+static const int kWriteBatchDelay = 250;
+/// Queued writes beyond which QueueWrite() blocks
+static const int kMaxQueuedWrites = 10000;
+
+/// Statements kept prepared per connection. The server limits the total
+/// (max_prepared_stmt_count), so keep this modest.
+static const int kPreparedQueryCacheSize = 32;
+
 bool TestDatabase(QString dbHostName,
                   QString dbUserName,
                   QString dbPassword,
@@ -75,6 +96,8 @@ MSqlDatabase::MSqlDatabase(const QString &name)
 {
     m_name = name;
     m_name.detach();
+    m_preparedSerial = 0;
+    m_reconnects = 0;
 
     if (!QSqlDatabase::isDriverAvailable("QMYSQL"))
     {
@@ -98,6 +121,8 @@ MSqlDatabase::MSqlDatabase(const QString &name)
 
 MSqlDatabase::~MSqlDatabase()
 {
+    ClearPreparedQueries();
+
     if (m_db.isOpen())
     {
         m_db.close();
@@ -254,6 +279,10 @@ bool MSqlDatabase::KickDatabase(void)
 
 bool MSqlDatabase::Reconnect()
 {
+    // Statements don't survive the connection
+    ClearPreparedQueries();
+
+    ++m_reconnects;
     m_db.close();
     m_db.open();
 
@@ -275,14 +304,253 @@ void MSqlDatabase::InitSessionVars()
     m_db.exec("SET @@session.sql_mode=''");
 }
 
+/** \brief Hands out the statement prepared earlier for this SQL, if any.
+ *
+ *  The statement is shared with query, and isn't handed out again until
+ *  it is returned. Nested queries on the same connection may use the same
+ *  SQL, the inner one then prepares its own.
+ */
+bool MSqlDatabase::TakePreparedQuery(const QString &sql, QSqlQuery &query,
+                                     uint &id)
+{
+    QHash<QString, PreparedQuery>::iterator it = m_prepared.find(sql);
+    if (it == m_prepared.end() || it->inUse)
+        return false;
+
+    it->inUse    = true;
+    it->lastUsed = ++m_preparedSerial;
+    query = it->query;
+    id    = it->id;
+
+    return true;
+}
+
+/** \brief Keeps a newly prepared statement for reuse, evicting the least
+ *         recently used idle one if the cache is full.
+ *  \return The id to return it with, or 0 if it wasn't kept.
+ */
+uint MSqlDatabase::AddPreparedQuery(const QString &sql, const QSqlQuery &query)
+{
+    if (m_prepared.contains(sql))
+        return 0;
+
+    if (m_prepared.size() >= kPreparedQueryCacheSize)
+    {
+        QHash<QString, PreparedQuery>::iterator oldest = m_prepared.end();
+        QHash<QString, PreparedQuery>::iterator it = m_prepared.begin();
+        for (; it != m_prepared.end(); ++it)
+        {
+            if (!it->inUse && (oldest == m_prepared.end() ||
+                               it->lastUsed < oldest->lastUsed))
+                oldest = it;
+        }
+
+        if (oldest == m_prepared.end())
+            return 0;
+
+        m_prepared.erase(oldest);
+    }
+
+    PreparedQuery prepared;
+    prepared.query    = query;
+    prepared.id       = ++m_preparedSerial;
+    prepared.lastUsed = prepared.id;
+    prepared.inUse    = true;
+    m_prepared.insert(sql, prepared);
+
+    return prepared.id;
+}
+
+void MSqlDatabase::ReturnPreparedQuery(const QString &sql, uint id)
+{
+    QHash<QString, PreparedQuery>::iterator it = m_prepared.find(sql);
+
+    // It may have been dropped by a reconnect in the meantime
+    if (it == m_prepared.end() || it->id != id)
+        return;
+
+    // Frees the result set, the statement stays prepared
+    it->query.finish();
+    it->inUse = false;
+}
+
+void MSqlDatabase::ClearPreparedQueries(void)
+{
+    m_prepared.clear();
+}
+
 // -----------------------------------------------------------------------
 
+static bool exec_write(MSqlQuery &query, const QString &sql,
+                       const MSqlBindings &bindings)
+{
+    // Literal statements are all different, don't fill the prepared
+    // statement cache with them
+    if (bindings.isEmpty())
+        return query.exec(sql);
+
+    if (!query.prepare(sql))
+        return false;
+    query.bindValues(bindings);
+    return query.exec();
+}
+
+/// \brief Runs the writes queued with MSqlQuery::QueueWrite()
+class MSqlWriteThread : public MThread
+{
+  public:
+    MSqlWriteThread() : MThread("DBWriter"), m_busy(false), m_aborted(false)
+    {
+    }
+
+    ~MSqlWriteThread()
+    {
+        stop();
+        wait();
+    }
+
+    void run(void);
+
+    /// \brief Runs what is queued, then exits
+    void stop(void)
+    {
+        QMutexLocker locker(&m_lock);
+        m_aborted = true;
+        m_wait.wakeAll();
+    }
+
+    void enqueue(const QString &sql, const MSqlBindings &bindings);
+    void flush(void);
+
+    uint pending(void)
+    {
+        QMutexLocker locker(&m_lock);
+        return m_queue.size();
+    }
 
+  private:
+    typedef QPair<QString, MSqlBindings> QueuedWrite;
+
+    QMutex             m_lock;
+    QWaitCondition     m_wait;     ///< the queue needs writing
+    QWaitCondition     m_done;     ///< a batch was written
+    QList<QueuedWrite> m_queue;    ///< protected by m_lock
+    bool               m_busy;     ///< a batch is being written
+    bool               m_aborted;  ///< protected by m_lock
+};
+
+void MSqlWriteThread::run(void)
+{
+    RunProlog();
+
+    // The query, and so the connection, is kept for the life of the thread
+    MSqlQuery *query =
+        new MSqlQuery(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
+
+    QMutexLocker locker(&m_lock);
+    while (!m_aborted || !m_queue.isEmpty())
+    {
+        if (m_queue.isEmpty())
+        {
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        // Give writers a moment to fill the batch
+        if (!m_aborted && m_queue.size() < kWriteBatchSize)
+            m_wait.wait(&m_lock, kWriteBatchDelay);
+
+        QList<QueuedWrite> batch = m_queue.mid(0, kWriteBatchSize);
+        m_queue.erase(m_queue.begin(), m_queue.begin() + batch.size());
+        m_busy = true;
+        locker.unlock();
+
+        // One commit for the batch rather than one per statement
+        bool inTransaction =
+            batch.size() > 1 && query->exec("START TRANSACTION");
+        uint reconnects = query->ReconnectCount();
+
+        for (int i = 0; i < batch.size(); ++i)
+        {
+            if (!exec_write(*query, batch.at(i).first, batch.at(i).second))
+                MythDB::DBError("Queued write", *query);
+
+            if (inTransaction && query->ReconnectCount() != reconnects)
+            {
+                // Reconnecting rolled back the statements before this one,
+                // which was retried on its own. Run them again without a
+                // transaction, like the rest of the batch.
+                LOG(VB_GENERAL, LOG_WARNING,
+                    QString("DB reconnected during queued writes, "
+                            "rewriting %1 statements").arg(i));
+                inTransaction = false;
+                for (int j = 0; j < i; ++j)
+                {
+                    const QueuedWrite &write = batch.at(j);
+                    if (!exec_write(*query, write.first, write.second))
+                        MythDB::DBError("Queued write", *query);
+                }
+            }
+        }
+
+        if (inTransaction && !query->exec("COMMIT"))
+            MythDB::DBError("Queued write - commit", *query);
+
+        LOG(VB_DATABASE, LOG_DEBUG,
+            QString("Wrote %1 queued statements").arg(batch.size()));
+
+        locker.relock();
+        m_busy = false;
+        m_done.wakeAll();
+    }
+    locker.unlock();
+
+    delete query;
+
+    RunEpilog();
+}
+
+void MSqlWriteThread::enqueue(const QString &sql,
+                              const MSqlBindings &bindings)
+{
+    QMutexLocker locker(&m_lock);
+
+    while (m_queue.size() >= kMaxQueuedWrites && !m_aborted)
+        m_done.wait(&m_lock);
+
+    m_queue.append(QueuedWrite(sql, bindings));
+
+    // The writer only needs waking to start a batch or when one is full
+    if (m_queue.size() == 1 || m_queue.size() >= kWriteBatchSize)
+        m_wait.wakeAll();
+}
+
+void MSqlWriteThread::flush(void)
+{
+    QMutexLocker locker(&m_lock);
+    while (!m_queue.isEmpty() || m_busy)
+    {
+        m_wait.wakeAll();
+        m_done.wait(&m_lock);
+    }
+}
+
+// -----------------------------------------------------------------------
 
 MDBManager::MDBManager()
 {
     m_nextConnID = 0;
     m_connCount = 0;
+    m_inUseCount = 0;
+    m_checkouts = 0;
+    m_waits = 0;
+    m_totalWaitUsecs = 0;
+    m_maxWaitUsecs = 0;
+    m_reaped = 0;
+    m_reapPending = 0;
+
+    m_writer = NULL;
+    m_writerStopped = false;
 
     m_schedCon = NULL;
     m_DDCon = NULL;
@@ -290,6 +558,14 @@ MDBManager::MDBManager()
 
 MDBManager::~MDBManager()
 {
+    // The writer can't be stopped from here, its thread cleanup needs
+    // the MythDB being destroyed. See StopQueuedWrites().
+    if (m_writer)
+    {
+        LOG(VB_GENERAL, LOG_CRIT,
+            "MDBManager exiting with the DB writer still running");
+    }
+
     CloseDatabases();
 
     if (m_connCount != 0 || m_schedCon || m_DDCon)
@@ -325,6 +601,11 @@ MSqlDatabase *MDBManager::popConnection(bool reuse)
     }
 #endif
 
+    ++m_checkouts;
+
+    if (m_pool[QThread::currentThread()].isEmpty())
+        WaitForRoom();
+
     DBList &list = m_pool[QThread::currentThread()];
     if (list.isEmpty())
     {
@@ -338,6 +619,8 @@ MSqlDatabase *MDBManager::popConnection(bool reuse)
         db = list.back();
         list.pop_back();
     }
+    ++m_inUseCount;
+    ++m_threadInUse[QThread::currentThread()];
 
 #if REUSE_CONNECTION
     if (reuse)
@@ -375,6 +658,10 @@ void MDBManager::pushConnection(MSqlDatabase *db)
     {
         db->m_lastDBKick = MythDate::current();
         m_pool[QThread::currentThread()].push_front(db);
+        --m_inUseCount;
+        if (--m_threadInUse[QThread::currentThread()] <= 0)
+            m_threadInUse.remove(QThread::currentThread());
+        m_available.wakeOne();
     }
 
     m_lock.unlock();
@@ -384,6 +671,8 @@ void MDBManager::pushConnection(MSqlDatabase *db)
 
 void MDBManager::PurgeIdleConnections(bool leaveOne)
 {
+    CloseReapedConnections();
+
     QMutexLocker locker(&m_lock);
 
     leaveOne = leaveOne || (gCoreContext && gCoreContext->IsUIThread());
@@ -441,12 +730,215 @@ void MDBManager::PurgeIdleConnections(bool leaveOne)
 
     if (purgedConnections)
     {
+        m_available.wakeAll();
         LOG(VB_DATABASE, LOG_INFO,
                 QString("Purged %1 idle of %2 total DB connections.")
                 .arg(purgedConnections).arg(totalConnections));
     }
 }
 
+/** \brief Makes room for the current thread to open a connection.
+ *
+ *  When the pool is full the idle connection of another thread is reaped,
+ *  but it stays open until its owner closes it. Only threads that called
+ *  AllowConnectionWait() wait for that, for up to kConnectionWaitTimeout,
+ *  and only while they hold no connection themselves. Waiting releases
+ *  m_lock. Any other thread, such as the UI thread or a recorder, opens
+ *  one over the limit rather than stall.
+ *
+ *  Call with m_lock held.
+ */
+void MDBManager::WaitForRoom(void)
+{
+    if (m_connCount < kMaxConnections)
+        return;
+
+    // Don't reap more than would bring the pool back under the limit
+    if (m_connCount - m_reapPending >= kMaxConnections)
+        ReapIdleConnection();
+
+    QThread *thread = QThread::currentThread();
+    if (!m_mayWait.contains(thread) || m_threadInUse.value(thread) > 0)
+    {
+        LOG(VB_DATABASE, LOG_INFO,
+            QString("DB connection limit of %1 reached, opening another")
+            .arg(kMaxConnections));
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    ++m_waits;
+
+    while (m_connCount >= kMaxConnections)
+    {
+        qint64 left = kConnectionWaitTimeout - timer.elapsed();
+        if (left <= 0)
+        {
+            // Better too many connections than stalling any longer
+            LOG(VB_GENERAL, LOG_WARNING,
+                QString("No DB connection became free in %1 ms, "
+                        "exceeding the limit of %2")
+                .arg(timer.elapsed()).arg(kMaxConnections));
+            break;
+        }
+        m_available.wait(&m_lock, left);
+
+        if (m_connCount - m_reapPending >= kMaxConnections)
+            ReapIdleConnection();
+    }
+
+    qint64 usecs = timer.nsecsElapsed() / 1000;
+    m_totalWaitUsecs += usecs;
+    m_maxWaitUsecs = std::max(m_maxWaitUsecs, usecs);
+}
+
+/** \brief Reaps the connection idle the longest in another thread's pool.
+ *
+ *  Connections belong to the thread that opened them, so the connection is
+ *  only taken out of the pool here and stays counted as open. Its thread
+ *  closes it the next time it uses the pool, see CloseReapedConnections(). The
+ *  main thread's connections are left alone, reopening them would stall
+ *  the UI. Call with m_lock held.
+ *
+ *  \return true if a connection was reaped
+ */
+bool MDBManager::ReapIdleConnection(void)
+{
+    QThread *mainThread = NULL;
+    if (QCoreApplication::instance())
+        mainThread = QCoreApplication::instance()->thread();
+
+    QHash<QThread*, DBList>::iterator oldest = m_pool.end();
+    QHash<QThread*, DBList>::iterator it = m_pool.begin();
+    for (; it != m_pool.end(); ++it)
+    {
+        if (it->isEmpty() || it.key() == QThread::currentThread() ||
+            it.key() == mainThread)
+            continue;
+
+        // Connections are returned to the front, so the last is the oldest
+        if (oldest == m_pool.end() ||
+            it->back()->m_lastDBKick < oldest->back()->m_lastDBKick)
+            oldest = it;
+    }
+
+    if (oldest == m_pool.end())
+        return false;
+
+    MSqlDatabase *db = oldest->takeLast();
+    m_reap_pool[oldest.key()].push_back(db);
+    ++m_reapPending;
+    ++m_reaped;
+
+    LOG(VB_DATABASE, LOG_INFO,
+        QString("Reaped idle DB connection '%1' to make room, pending: %2")
+        .arg(db->m_name).arg(m_reapPending));
+
+    return true;
+}
+
+/// Closes the current thread's connections reaped by other threads.
+void MDBManager::CloseReapedConnections(void)
+{
+    m_lock.lock();
+    DBList list = m_reap_pool.take(QThread::currentThread());
+    m_lock.unlock();
+
+    if (list.isEmpty())
+        return;
+
+    for (DBList::iterator it = list.begin(); it != list.end(); ++it)
+    {
+        LOG(VB_DATABASE, LOG_INFO,
+            "Closing reaped DB connection named '" + (*it)->m_name + "'");
+        delete (*it);
+    }
+
+    m_lock.lock();
+    m_connCount -= list.size();
+    m_reapPending -= list.size();
+    m_available.wakeAll();
+    m_lock.unlock();
+}
+
+/** \brief Lets the current thread wait for a connection when the pool is
+ *         full, rather than open one over the limit.
+ *
+ *  For worker threads, such as MThreadPool's, which can be many at once and
+ *  can afford to wait. Lasts until the thread calls CloseDatabases().
+ */
+void MDBManager::AllowConnectionWait(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_mayWait.insert(QThread::currentThread());
+}
+
+MDBManager::PoolStats MDBManager::GetPoolStats(void)
+{
+    PoolStats stats;
+
+    m_lock.lock();
+    stats.open           = m_connCount;
+    stats.inUse          = m_inUseCount;
+    stats.limit          = kMaxConnections;
+    stats.checkouts      = m_checkouts;
+    stats.waits          = m_waits;
+    stats.totalWaitUsecs = m_totalWaitUsecs;
+    stats.maxWaitUsecs   = m_maxWaitUsecs;
+    stats.reaped         = m_reaped;
+    stats.reapPending    = m_reapPending;
+    m_lock.unlock();
+
+    QMutexLocker locker(&m_writerLock);
+    stats.queuedWrites = m_writer ? m_writer->pending() : 0;
+
+    return stats;
+}
+
+void MDBManager::QueueWrite(const QString &sql, const MSqlBindings &bindings)
+{
+    QMutexLocker locker(&m_writerLock);
+
+    if (!m_writerStopped)
+    {
+        if (!m_writer)
+        {
+            m_writer = new MSqlWriteThread();
+            m_writer->start();
+        }
+        m_writer->enqueue(sql, bindings);
+        return;
+    }
+
+    // Shutting down, so write it now
+    locker.unlock();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!exec_write(query, sql, bindings))
+        MythDB::DBError("Queued write", query);
+}
+
+void MDBManager::FlushQueuedWrites(void)
+{
+    QMutexLocker locker(&m_writerLock);
+    if (m_writer)
+        m_writer->flush();
+}
+
+/** \brief Runs the queued writes and stops the writer thread. Later
+ *         writes are run right away.
+ *
+ *  Must be called before the MythDB is destroyed.
+ */
+void MDBManager::StopQueuedWrites(void)
+{
+    QMutexLocker locker(&m_writerLock);
+    m_writerStopped = true;
+    delete m_writer;
+    m_writer = NULL;
+}
+
 MSqlDatabase *MDBManager::getStaticCon(MSqlDatabase **dbcon, QString name)
 {
     if (!dbcon)
@@ -478,9 +970,15 @@ MSqlDatabase *MDBManager::getDDCon()
 
 void MDBManager::CloseDatabases()
 {
+    CloseReapedConnections();
+
     m_lock.lock();
     DBList list = m_pool[QThread::currentThread()];
     m_pool[QThread::currentThread()].clear();
+    m_connCount -= list.size();
+    m_mayWait.remove(QThread::currentThread());
+    m_threadInUse.remove(QThread::currentThread());
+    m_available.wakeAll();
     m_lock.unlock();
 
     for (DBList::iterator it = list.begin(); it != list.end(); ++it)
@@ -489,7 +987,6 @@ void MDBManager::CloseDatabases()
             "Closing DB connection named '" + (*it)->m_name + "'");
         (*it)->m_db.close();
         delete (*it);
-        m_connCount--;
     }
 
     m_lock.lock();
@@ -527,6 +1024,7 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
     m_isConnected = false;
     m_db = qi.db;
     m_returnConnection = qi.returnConnection;
+    m_prepared_id = 0;
 
     m_isConnected = m_db && m_db->isOpen();
 
@@ -537,6 +1035,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
 
 MSqlQuery::~MSqlQuery()
 {
+    ReleasePreparedQuery();
+
     if (m_returnConnection)
     {
         MDBManager *dbmanager = GetMythDB()->GetDBManager();
@@ -578,6 +1078,16 @@ MSqlQueryInfo MSqlQuery::InitCon(ConnectionReuse _reuse)
     return qi;
 }
 
+void MSqlQuery::QueueWrite(const QString &sql, const MSqlBindings &bindings)
+{
+    GetMythDB()->GetDBManager()->QueueWrite(sql, bindings);
+}
+
+void MSqlQuery::FlushQueuedWrites(void)
+{
+    GetMythDB()->GetDBManager()->FlushQueuedWrites();
+}
+
 MSqlQueryInfo MSqlQuery::SchedCon()
 {
     MSqlDatabase *db = GetMythDB()->GetDBManager()->getSchedCon();
@@ -653,6 +1163,8 @@ bool MSqlQuery::exec()
 
     bool result = QSqlQuery::exec();
     qint64 elapsed = timer.elapsed();
+    MSqlQueryProfiler::Record(m_last_prepared_query,
+                              timer.nsecsElapsed() / 1000, true);
 
     // if the query failed with "MySQL server has gone away"
     // Close and reopen the database connection and retry the query if it
@@ -738,7 +1250,14 @@ bool MSqlQuery::exec(const QString &query)
         return false;
     }
 
+    // Don't run this over a cached statement
+    ReleasePreparedQuery();
+
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = QSqlQuery::exec(query);
+    MSqlQueryProfiler::Record(query, timer.nsecsElapsed() / 1000, false);
 
     // if the query failed with "MySQL server has gone away"
     // Close and reopen the database connection and retry the query if it
@@ -824,6 +1343,7 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    ReleasePreparedQuery();
     m_last_prepared_query = query;
 
 #ifdef DEBUG_QT4_PORT
@@ -852,6 +1372,10 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    // Reuse the statement if this connection has prepared it before
+    if (m_db->TakePreparedQuery(query, *this, m_prepared_id))
+        return true;
+
     // QT docs indicate that there are significant speed ups and a reduction
     // in memory usage by enabling forward-only cursors
     //
@@ -875,9 +1399,29 @@ bool MSqlQuery::prepare(const QString& query)
             MythDB::DBErrorMessage(QSqlQuery::lastError()));
     }
 
+    if (ok)
+        m_prepared_id = m_db->AddPreparedQuery(query, *this);
+
     return ok;
 }
 
+/** \brief Gives the connection's cached statement back, if we have one,
+ *         and switches to a statement of our own.
+ */
+void MSqlQuery::ReleasePreparedQuery(void)
+{
+    if (!m_prepared_id)
+        return;
+
+    if (m_db)
+    {
+        m_db->ReturnPreparedQuery(m_last_prepared_query, m_prepared_id);
+        QSqlQuery::operator=(QSqlQuery(QString(), m_db->db()));
+    }
+
+    m_prepared_id = 0;
+}
+
 bool MSqlQuery::testDBConnection()
 {
     MSqlDatabase *db = GetMythDB()->GetDBManager()->popConnection(true);
@@ -926,6 +1470,10 @@ bool MSqlQuery::Reconnect(void)
 {
     if (!m_db->Reconnect())
         return false;
+
+    // The reconnect dropped the cache, the statement is ours alone now
+    m_prepared_id = 0;
+
     if (!m_last_prepared_query.isEmpty())
     {
         MSqlBindings tmp = QSqlQuery::boundValues();
@@ -991,3 +1539,176 @@ void MSqlEscapeAsAQuery(QString &query, MSqlBindings &bindings)
                               result.driver()->formatValue(f));
     }
 }
+
+// -----------------------------------------------------------------------
+
+/// Latency samples kept per statement for the percentile
+static const int kProfilerSamples = 512;
+/// Statements tracked; more would only be noise on the status page
+static const int kProfilerStatements = 1000;
+
+struct ProfiledStatement
+{
+    ProfiledStatement() : count(0), totalUsecs(0), maxUsecs(0) {}
+
+    uint            count;
+    qint64          totalUsecs;
+    qint64          maxUsecs;
+    QVector<qint64> samples; // ring buffer of the latest latencies
+};
+
+static QMutex                             s_profilerLock;
+static QHash<QString, ProfiledStatement>  s_profiled;   // by normalized text
+static QHash<QString, QString>            s_normalized; // prepared SQL to key
+
+void MSqlQueryProfiler::Record(const QString &query, qint64 usecs,
+                               bool prepared)
+{
+    if (query.isEmpty())
+        return;
+
+    QMutexLocker locker(&s_profilerLock);
+
+    // Prepared statements repeat verbatim, so only normalize them once
+    QString key;
+    if (prepared)
+    {
+        QHash<QString, QString>::const_iterator nit = s_normalized.find(query);
+        if (nit != s_normalized.end())
+            key = *nit;
+    }
+
+    if (key.isEmpty())
+    {
+        // Every other query waits on this lock, so don't normalize under it
+        locker.unlock();
+        key = Normalize(query);
+        locker.relock();
+
+        if (prepared && s_normalized.size() < kProfilerStatements)
+            s_normalized.insert(query, key);
+    }
+
+    QHash<QString, ProfiledStatement>::iterator it = s_profiled.find(key);
+    if (it == s_profiled.end())
+    {
+        if (s_profiled.size() >= kProfilerStatements)
+            return;
+        it = s_profiled.insert(key, ProfiledStatement());
+        it->samples.reserve(kProfilerSamples);
+    }
+
+    if (it->samples.size() < kProfilerSamples)
+        it->samples.append(usecs);
+    else
+        it->samples[it->count % kProfilerSamples] = usecs;
+
+    it->count++;
+    it->totalUsecs += usecs;
+    it->maxUsecs = std::max(it->maxUsecs, usecs);
+}
+
+static bool stats_total_greater_than(const MSqlQueryProfiler::Stats &a,
+                                     const MSqlQueryProfiler::Stats &b)
+{
+    return a.totalUsecs > b.totalUsecs;
+}
+
+/** \brief Returns the statements that took the most time in total, most
+ *         first. The 99th percentile is over the latest executions only.
+ */
+QList<MSqlQueryProfiler::Stats> MSqlQueryProfiler::GetStats(int limit)
+{
+    QList<Stats> stats;
+
+    {
+        QMutexLocker locker(&s_profilerLock);
+
+        QHash<QString, ProfiledStatement>::const_iterator it;
+        for (it = s_profiled.begin(); it != s_profiled.end(); ++it)
+        {
+            QVector<qint64> samples = it->samples;
+            int p99 = (samples.size() * 99 + 99) / 100 - 1;
+            std::nth_element(samples.begin(), samples.begin() + p99,
+                             samples.end());
+
+            Stats entry;
+            entry.statement  = it.key();
+            entry.count      = it->count;
+            entry.totalUsecs = it->totalUsecs;
+            entry.p99Usecs   = samples[p99];
+            entry.maxUsecs   = it->maxUsecs;
+            stats.append(entry);
+        }
+    }
+
+    std::sort(stats.begin(), stats.end(), stats_total_greater_than);
+
+    if (limit > 0 && stats.size() > limit)
+        stats = stats.mid(0, limit);
+
+    return stats;
+}
+
+void MSqlQueryProfiler::Reset(void)
+{
+    QMutexLocker locker(&s_profilerLock);
+    s_profiled.clear();
+    s_normalized.clear();
+}
+
+/** \brief Collapses white space and replaces string and number literals
+ *         with '?', leaving placeholders and identifiers alone.
+ */
+QString MSqlQueryProfiler::Normalize(const QString &query)
+{
+    QString result;
+    result.reserve(query.size());
+
+    const QChar *c   = query.constData();
+    const QChar *end = c + query.size();
+
+    while (c < end)
+    {
+        if (c->isSpace())
+        {
+            while (c < end && c->isSpace())
+                ++c;
+            if (!result.isEmpty() && c < end)
+                result += ' ';
+        }
+        else if (*c == '\'' || *c == '"')
+        {
+            QChar quote = *c++;
+            while (c < end)
+            {
+                if (*c == '\\' && c + 1 < end)
+                    c += 2;
+                else if (*c == quote && c + 1 < end && *(c + 1) == quote)
+                    c += 2;
+                else if (*c++ == quote)
+                    break;
+            }
+            result += '?';
+        }
+        else if (c->isDigit())
+        {
+            while (c < end && (c->isLetterOrNumber() || *c == '.'))
+                ++c;
+            result += '?';
+        }
+        else if (c->isLetter() || *c == '_' || *c == ':' || *c == '@')
+        {
+            // Identifiers and placeholders may contain digits
+            while (c < end && (c->isLetterOrNumber() || *c == '_' ||
+                               *c == ':' || *c == '@' || *c == '.'))
+                result += *c++;
+        }
+        else
+        {
+            result += *c++;
+        }
+    }
+
+    return result;
+}
@@ -9,7 +9,11 @@
 #include <QRegExp>
 #include <QDateTime>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMap>
 
 #include "mythbaseexp.h"
 #include "mythdbparams.h"
@@ -22,6 +26,9 @@ MBASE_PUBLIC bool TestDatabase(QString dbHostName,
                                QString dbName = "mythconverg",
                                int     dbPort = 3306);
 
+/// \brief typedef for a map of string -> string bindings for generic queries.
+typedef QMap<QString, QVariant> MSqlBindings;
+
 /// \brief QSqlDatabase wrapper, used by MSqlQuery. Do not use directly.
 class MSqlDatabase
 {
@@ -42,14 +49,65 @@ class MSqlDatabase
     bool Reconnect(void);
     void InitSessionVars(void);
 
+    bool TakePreparedQuery(const QString &sql, QSqlQuery &query, uint &id);
+    uint AddPreparedQuery(const QString &sql, const QSqlQuery &query);
+    void ReturnPreparedQuery(const QString &sql, uint id);
+    void ClearPreparedQueries(void);
+
   private:
+    /// A statement prepared on this connection, shared with the MSqlQuery
+    /// using it
+    struct PreparedQuery
+    {
+        QSqlQuery query;
+        uint      id;
+        uint      lastUsed;
+        bool      inUse;
+    };
+
     QString m_name;
     QSqlDatabase m_db;
     QDateTime m_lastDBKick;
     DatabaseParams m_dbparms;
+    QHash<QString, PreparedQuery> m_prepared;
+    uint m_preparedSerial;
+    uint m_reconnects; ///< times reopened, losing any open transaction
 };
 
-/// \brief DB connection pool, used by MSqlQuery. Do not use directly.
+/** \brief Times MSqlQuery statements, for the backend status page.
+ *
+ *  Statements are grouped by their text with literals replaced by '?', so
+ *  both prepared and literal queries of the same shape are counted together.
+ */
+class MBASE_PUBLIC MSqlQueryProfiler
+{
+  public:
+    typedef struct
+    {
+        QString statement;
+        uint    count;
+        qint64  totalUsecs;
+        qint64  p99Usecs;
+        qint64  maxUsecs;
+    } Stats;
+
+    static void Record(const QString &query, qint64 usecs, bool prepared);
+    static QList<Stats> GetStats(int limit = 0);
+    static void Reset(void);
+
+    static QString Normalize(const QString &query);
+};
+
+class MSqlWriteThread;
+
+/** \brief DB connection pool, used by MSqlQuery. Do not use directly.
+ *
+ *  Each connection is only used by the thread that opened it, but the
+ *  number open across all threads is bounded. A thread needing a new
+ *  connection when the pool is full reaps the one idle the longest in
+ *  another thread. Failing that, worker threads that allow it wait for
+ *  one to become idle, and all others open one over the limit.
+ */
 class MBASE_PUBLIC MDBManager
 {
   friend class MSqlQuery;
@@ -59,6 +117,27 @@ class MBASE_PUBLIC MDBManager
 
     void CloseDatabases(void);
     void PurgeIdleConnections(bool leaveOne = false);
+    void AllowConnectionWait(void);
+
+    typedef struct
+    {
+        uint   open;           ///< connections open, excluding static ones
+        uint   inUse;          ///< connections checked out
+        uint   limit;          ///< most connections opened without waiting
+        uint   checkouts;      ///< connections handed out
+        uint   waits;          ///< checkouts that had to wait for room
+        qint64 totalWaitUsecs;
+        qint64 maxWaitUsecs;
+        uint   reaped;         ///< idle connections reaped to make room
+        uint   reapPending;    ///< reaped connections not yet closed
+        uint   queuedWrites;   ///< writes queued and not yet run
+    } PoolStats;
+
+    PoolStats GetPoolStats(void);
+
+    void QueueWrite(const QString &sql, const MSqlBindings &bindings);
+    void FlushQueuedWrites(void);
+    void StopQueuedWrites(void);
 
   protected:
     MSqlDatabase *popConnection(bool reuse);
@@ -69,10 +148,17 @@ class MBASE_PUBLIC MDBManager
 
   private:
     MSqlDatabase *getStaticCon(MSqlDatabase **dbcon, QString name);
+    void WaitForRoom(void);
+    bool ReapIdleConnection(void);
+    void CloseReapedConnections(void);
 
     QMutex m_lock;
+    QWaitCondition m_available; // a connection was returned or closed
     typedef QList<MSqlDatabase*> DBList;
     QHash<QThread*, DBList> m_pool; // protected by m_lock
+    QHash<QThread*, DBList> m_reap_pool; // to close, protected by m_lock
+    QHash<QThread*, int> m_threadInUse; // protected by m_lock
+    QSet<QThread*> m_mayWait; // protected by m_lock
 #if REUSE_CONNECTION
     QHash<QThread*, MSqlDatabase*> m_inuse; // protected by m_lock
     QHash<QThread*, int> m_inuse_count; // protected by m_lock
@@ -80,6 +166,17 @@ class MBASE_PUBLIC MDBManager
 
     int m_nextConnID;
     int m_connCount;
+    int m_inUseCount;
+    uint m_checkouts;
+    uint m_waits;
+    qint64 m_totalWaitUsecs;
+    qint64 m_maxWaitUsecs;
+    uint m_reaped;
+    int m_reapPending; // reaped, still open and counted in m_connCount
+
+    QMutex m_writerLock;
+    MSqlWriteThread *m_writer;  // protected by m_writerLock
+    bool m_writerStopped;       // protected by m_writerLock
 
     MSqlDatabase *m_schedCon;
     MSqlDatabase *m_DDCon;
@@ -94,9 +191,6 @@ typedef struct _MSqlQueryInfo
     bool returnConnection;
 } MSqlQueryInfo;
 
-/// \brief typedef for a map of string -> string bindings for generic queries.
-typedef QMap<QString, QVariant> MSqlBindings;
-
 /// \brief Add the entries in addfrom to the map in output
  MBASE_PUBLIC  void MSqlAddMoreBindings(MSqlBindings &output, MSqlBindings &addfrom);
 
@@ -125,6 +219,7 @@ typedef QMap<QString, QVariant> MSqlBindings;
 class MBASE_PUBLIC MSqlQuery : private QSqlQuery
 {
     MBASE_PUBLIC friend void MSqlEscapeAsAQuery(QString&, MSqlBindings&);
+    friend class MSqlWriteThread;
   public:
     /// \brief Get DB connection from pool
     explicit MSqlQuery(const MSqlQueryInfo &qi);
@@ -210,6 +305,15 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     /// \brief Returns dedicated connection. (Required for using temporary SQL tables.)
     static MSqlQueryInfo DDCon();
 
+    /// \brief Queues a write whose result isn't needed, e.g. seek table
+    ///        updates. Queued writes are run in order, in batches, on a
+    ///        connection of their own.
+    static void QueueWrite(const QString &sql,
+                           const MSqlBindings &bindings = MSqlBindings());
+
+    /// \brief Waits until all queued writes have been run
+    static void FlushQueuedWrites(void);
+
   private:
     // Only QSql::In is supported as a param type and only named params...
     void bindValue(const QString&, const QVariant&, QSql::ParamType);
@@ -218,11 +322,14 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
 
     bool seekDebug(const char *type, bool result,
                    int where, bool relative) const;
+    void ReleasePreparedQuery(void);
+    uint ReconnectCount(void) const { return m_db ? m_db->m_reconnects : 0; }
 
     MSqlDatabase *m_db;
     bool m_isConnected;
     bool m_returnConnection;
     QString m_last_prepared_query; // holds a copy of the last prepared query
+    uint m_prepared_id; // the connection's cached statement we share, or 0
 #ifdef DEBUG_QT4_PORT
     QRegExp m_testbindings;
 #endif
@@ -106,7 +106,13 @@ void MythPlugin::destroy(void)
         rfunc();
 }
 
-MythPluginManager::MythPluginManager()
+/** \brief Finds the plugins in the plugins directory.
+ *
+ *  With deferInit set the libraries are only listed, so that startup doesn't
+ *  wait on them. They are then initialized by the caller, through
+ *  init_plugin() or InitPendingPlugins(), or on their first use.
+ */
+MythPluginManager::MythPluginManager(bool deferInit)
 {
     QString pluginprefix = GetPluginsDir();
 
@@ -135,8 +141,11 @@ MythPluginManager::MythPluginManager()
             library = library.right(library.length() - prefixLength);
             library = library.left(library.length() - suffixLength);
 
-            init_plugin(library);
+            m_pending.append(library);
         }
+
+        if (!deferInit)
+            InitPendingPlugins();
     }
     else
         LOG(VB_GENERAL, LOG_WARNING,
@@ -151,6 +160,8 @@ bool MythPluginManager::init_plugin(const QString &plugname)
 {
     QString newname = FindPluginName(plugname);
 
+    m_pending.removeAll(plugname);
+
     if (!m_dict[newname])
     {
         m_dict.insert(newname, new MythPlugin(newname, plugname));
@@ -180,6 +191,18 @@ bool MythPluginManager::init_plugin(const QString &plugname)
     return true;
 }
 
+void MythPluginManager::InitPendingPlugins(void)
+{
+    while (!m_pending.isEmpty())
+        init_plugin(m_pending.first());
+}
+
+/// \brief Is the plugin initialized, or waiting to be
+bool MythPluginManager::HasPlugin(const QString &plugname)
+{
+    return m_pending.contains(plugname) || GetPlugin(plugname);
+}
+
 // return false on success, true on error
 bool MythPluginManager::run_plugin(const QString &plugname)
 {
@@ -220,6 +243,10 @@ bool MythPluginManager::destroy_plugin(const QString &plugname)
 {
     QString newname = FindPluginName(plugname);
 
+    // Never loaded, so there is nothing to tear down
+    if (m_pending.removeAll(plugname))
+        return true;
+
     if (!m_dict[newname] && !init_plugin(plugname))
     {
         LOG(VB_GENERAL, LOG_ALERT,
@@ -253,6 +280,7 @@ void MythPluginManager::DestroyAllPlugins(void)
 
     m_dict.clear();
     moduleMap.clear();
+    m_pending.clear();
 }
 
 QStringList MythPluginManager::EnumeratePlugins(void)
@@ -261,5 +289,6 @@ QStringList MythPluginManager::EnumeratePlugins(void)
     QHash<QString, MythPlugin*>::const_iterator it = m_dict.begin();
     for (; it != m_dict.end(); ++it)
         ret << (*it)->getName();
+    ret << m_pending;
     return ret;
 }
@@ -2,6 +2,7 @@
 #define MYTHPLUGIN_H_
 
 #include <QLibrary>
+#include <QStringList>
 #include <QMap>
 #include <QHash>
 
@@ -57,10 +58,13 @@ class MythPlugin : public QLibrary
 class MBASE_PUBLIC MythPluginManager
 {
   public:
-    MythPluginManager();
+    explicit MythPluginManager(bool deferInit = false);
    ~MythPluginManager();
 
     bool init_plugin(const QString &plugname);
+    void InitPendingPlugins(void);
+    QStringList GetPendingPlugins(void) const { return m_pending; }
+    bool HasPlugin(const QString &plugname);
     bool run_plugin(const QString &plugname);
     bool config_plugin(const QString &plugname);
     bool destroy_plugin(const QString &plugname);
@@ -74,6 +78,9 @@ class MBASE_PUBLIC MythPluginManager
     QHash<QString,MythPlugin*> m_dict;
 
     QMap<QString, MythPlugin *> moduleMap;
+
+    /// Plugins found in the plugins directory but not yet initialized
+    QStringList m_pending;
 };
 
 #endif
@@ -0,0 +1,3 @@
+#include "test_filereadcache.h"
+
+QTEST_APPLESS_MAIN(TestFileReadCache)
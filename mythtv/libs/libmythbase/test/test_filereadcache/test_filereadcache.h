@@ -0,0 +1,209 @@
+/*
+ *  Class TestFileReadCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+
+#include "filereadcache.h"
+
+#define CHUNK_SIZE 4096
+
+class TestFileReadCache: public QObject
+{
+    Q_OBJECT
+
+  private:
+    QTemporaryFile m_file;
+    QByteArray     m_contents;
+
+  private slots:
+    void initTestCase(void)
+    {
+        // Three and a half chunks of a pattern that doesn't repeat per chunk
+        for (int i = 0; i < CHUNK_SIZE * 7 / 2; ++i)
+            m_contents.append(char((i * 7 + i / 251) & 0xff));
+
+        QVERIFY(m_file.open());
+        QCOMPARE(m_file.write(m_contents), qint64(m_contents.size()));
+        QVERIFY(m_file.flush());
+    }
+
+    void SingleReaderIsNotShared(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+
+        QString key = cache.AddReader(m_file.fileName(), m_file.handle());
+        QVERIFY(!key.isEmpty());
+        QVERIFY(!cache.IsShared(key));
+
+        cache.RemoveReader(key);
+    }
+
+    void ReadersOfTheSameFileShare(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+
+        QString key1 = cache.AddReader(m_file.fileName(), m_file.handle());
+        QString key2 = cache.AddReader(m_file.fileName(), m_file.handle());
+        QCOMPARE(key1, key2);
+        QVERIFY(cache.IsShared(key1));
+
+        cache.RemoveReader(key2);
+        QVERIFY(!cache.IsShared(key1));
+
+        cache.RemoveReader(key1);
+    }
+
+    void ReplacedFileIsNotShared(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+
+        QTemporaryFile old;
+        QVERIFY(old.open());
+        QString name = old.fileName();
+        QString key1 = cache.AddReader(name, old.handle());
+
+        // Keep the old file open, as a reader streaming it would
+        QVERIFY(QFile::rename(name, name + ".old"));
+
+        QFile replacement(name);
+        QVERIFY(replacement.open(QIODevice::ReadWrite));
+        QString key2 = cache.AddReader(name, replacement.handle());
+
+        QVERIFY(!key2.isEmpty());
+        QVERIFY(key1 != key2);
+        QVERIFY(!cache.IsShared(key1));
+        QVERIFY(!cache.IsShared(key2));
+
+        cache.RemoveReader(key2);
+        cache.RemoveReader(key1);
+        replacement.remove();
+        QFile::remove(name + ".old");
+    }
+
+    void ReadsAcrossChunks(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+        QString key = cache.AddReader(m_file.fileName(), m_file.handle());
+
+        QByteArray buf(CHUNK_SIZE * 2, 0);
+        qint64 ret = cache.Read(key, m_file.handle(), CHUNK_SIZE / 2,
+                                buf.data(), buf.size());
+
+        QCOMPARE(ret, qint64(buf.size()));
+        QCOMPARE(buf, m_contents.mid(CHUNK_SIZE / 2, buf.size()));
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE * 3));
+
+        cache.RemoveReader(key);
+    }
+
+    void ShortReadAtEndOfFile(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+        QString key = cache.AddReader(m_file.fileName(), m_file.handle());
+
+        QByteArray buf(CHUNK_SIZE, 0);
+        qint64 ret = cache.Read(key, m_file.handle(), CHUNK_SIZE * 3,
+                                buf.data(), buf.size());
+
+        QCOMPARE(ret, qint64(CHUNK_SIZE / 2));
+        QCOMPARE(buf.left(ret), m_contents.mid(CHUNK_SIZE * 3));
+
+        // The last chunk may still grow, so it isn't kept
+        QCOMPARE(cache.GetCachedBytes(), qint64(0));
+
+        ret = cache.Read(key, m_file.handle(), m_contents.size(),
+                         buf.data(), buf.size());
+        QCOMPARE(ret, qint64(0));
+
+        cache.RemoveReader(key);
+    }
+
+    void ReadsGrowingFile(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+
+        QTemporaryFile growing;
+        QVERIFY(growing.open());
+        QVERIFY(growing.write(m_contents.left(CHUNK_SIZE * 3 / 2)) > 0);
+        QVERIFY(growing.flush());
+
+        QString key = cache.AddReader(growing.fileName(), growing.handle());
+
+        // Only the complete chunk is kept, the rest is read as asked
+        QByteArray buf(CHUNK_SIZE, 0);
+        qint64 ret = cache.Read(key, growing.handle(), CHUNK_SIZE / 2,
+                                buf.data(), buf.size());
+        QCOMPARE(ret, qint64(CHUNK_SIZE));
+        QCOMPARE(buf, m_contents.mid(CHUNK_SIZE / 2, CHUNK_SIZE));
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE));
+
+        QVERIFY(growing.write(m_contents.mid(CHUNK_SIZE * 3 / 2)) > 0);
+        QVERIFY(growing.flush());
+
+        ret = cache.Read(key, growing.handle(), CHUNK_SIZE * 3 / 2,
+                         buf.data(), buf.size());
+        QCOMPARE(ret, qint64(CHUNK_SIZE));
+        QCOMPARE(buf, m_contents.mid(CHUNK_SIZE * 3 / 2, CHUNK_SIZE));
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE * 3));
+
+        cache.RemoveReader(key);
+    }
+
+    void LastReaderDropsChunks(void)
+    {
+        FileReadCache cache(CHUNK_SIZE);
+        QString key1 = cache.AddReader(m_file.fileName(), m_file.handle());
+        QString key2 = cache.AddReader(m_file.fileName(), m_file.handle());
+
+        QByteArray buf(CHUNK_SIZE, 0);
+        cache.Read(key1, m_file.handle(), 0, buf.data(), buf.size());
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE));
+
+        cache.RemoveReader(key1);
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE));
+
+        cache.RemoveReader(key2);
+        QCOMPARE(cache.GetCachedBytes(), qint64(0));
+    }
+
+    void EvictsLeastRecentlyUsed(void)
+    {
+        FileReadCache cache(CHUNK_SIZE, CHUNK_SIZE * 2);
+        QString key = cache.AddReader(m_file.fileName(), m_file.handle());
+
+        QByteArray buf(CHUNK_SIZE, 0);
+        cache.Read(key, m_file.handle(), 0, buf.data(), buf.size());
+        cache.Read(key, m_file.handle(), CHUNK_SIZE, buf.data(), buf.size());
+        cache.Read(key, m_file.handle(), 0, buf.data(), buf.size());
+        cache.Read(key, m_file.handle(), CHUNK_SIZE * 2,
+                   buf.data(), buf.size());
+
+        QCOMPARE(cache.GetCachedBytes(), qint64(CHUNK_SIZE * 2));
+
+        // Chunk 0 was used more recently than chunk 1, so it is still there
+        // and is served even with no file to read it from.
+        QCOMPARE(cache.Read(key, -1, 0, buf.data(), buf.size()),
+                 qint64(CHUNK_SIZE));
+        QCOMPARE(buf, m_contents.left(CHUNK_SIZE));
+        QCOMPARE(cache.Read(key, -1, CHUNK_SIZE, buf.data(), buf.size()),
+                 qint64(-1));
+
+        cache.RemoveReader(key);
+    }
+};
@@ -0,0 +1,3 @@
+#include "test_mythdb.h"
+
+QTEST_APPLESS_MAIN(TestMythDB)
@@ -0,0 +1,152 @@
+/*
+ *  Class TestMythDB
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QSemaphore>
+#include <QThread>
+
+#include "mythdb.h"
+
+#define READER_THREADS 16
+
+/// Reads a setting, then once more when told to
+class SettingReader : public QThread
+{
+  public:
+    explicit SettingReader(const QString &key) : m_key(key) {}
+
+    void run(void)
+    {
+        m_first = GetMythDB()->GetSetting(m_key);
+        m_read.release();
+        m_reread.acquire();
+        m_second = GetMythDB()->GetSetting(m_key);
+    }
+
+    QString    m_key;
+    QString    m_first;
+    QString    m_second;
+    QSemaphore m_read;
+    QSemaphore m_reread;
+};
+
+/// Reads a numeric setting in a loop
+class SettingLoop : public QThread
+{
+  public:
+    SettingLoop(const QString &key, int count) :
+        m_key(key), m_count(count), m_sum(0) {}
+
+    void run(void)
+    {
+        for (int i = 0; i < m_count; ++i)
+            m_sum += GetMythDB()->GetNumSetting(m_key, 0);
+    }
+
+    QString m_key;
+    int     m_count;
+    qint64  m_sum;
+};
+
+class TestMythDB: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    // Without a database all settings come from the session overrides
+    void initTestCase(void)
+    {
+        GetMythDB()->IgnoreDatabase(true);
+        GetMythDB()->ActivateSettingsCache(true);
+    }
+
+    void cleanupTestCase(void)
+    {
+        DestroyMythDB();
+    }
+
+    void OverrideIsRead(void)
+    {
+        GetMythDB()->OverrideSettingForSession("TestOverride", "42");
+
+        QCOMPARE(GetMythDB()->GetSetting("TestOverride"), QString("42"));
+        QCOMPARE(GetMythDB()->GetNumSetting("testoverride", 0), 42);
+    }
+
+    void ClearedOverrideFallsBackToDefault(void)
+    {
+        GetMythDB()->OverrideSettingForSession("TestCleared", "1");
+        QCOMPARE(GetMythDB()->GetNumSetting("TestCleared", 5), 1);
+
+        GetMythDB()->ClearOverrideSettingForSession("TestCleared");
+        QCOMPARE(GetMythDB()->GetNumSetting("TestCleared", 5), 5);
+    }
+
+    void ClearingCacheKeepsOverrides(void)
+    {
+        GetMythDB()->OverrideSettingForSession("TestKept", "7");
+
+        GetMythDB()->ClearSettingsCache("TestKept");
+        QCOMPARE(GetMythDB()->GetNumSetting("TestKept", 0), 7);
+
+        GetMythDB()->ClearSettingsCache();
+        QCOMPARE(GetMythDB()->GetNumSetting("TestKept", 0), 7);
+    }
+
+    void OtherThreadSeesChange(void)
+    {
+        GetMythDB()->OverrideSettingForSession("TestShared", "old");
+
+        SettingReader reader("TestShared");
+        reader.start();
+        reader.m_read.acquire();
+
+        GetMythDB()->OverrideSettingForSession("TestShared", "new");
+        reader.m_reread.release();
+        QVERIFY(reader.wait(5000));
+
+        QCOMPARE(reader.m_first, QString("old"));
+        QCOMPARE(reader.m_second, QString("new"));
+    }
+
+    void GetSettingThroughput(void)
+    {
+        GetMythDB()->OverrideSettingForSession("TestThroughput", "3");
+
+        const int count = 100000;
+        QList<SettingLoop*> loops;
+        for (int i = 0; i < READER_THREADS; ++i)
+            loops.append(new SettingLoop("TestThroughput", count));
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < loops.size(); ++i)
+            {
+                loops[i]->m_sum = 0;
+                loops[i]->start();
+            }
+            for (int i = 0; i < loops.size(); ++i)
+                loops[i]->wait();
+        }
+
+        for (int i = 0; i < loops.size(); ++i)
+            QCOMPARE(loops[i]->m_sum, qint64(3) * count);
+
+        qDeleteAll(loops);
+    }
+};
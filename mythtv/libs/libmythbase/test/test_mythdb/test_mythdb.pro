@@ -0,0 +1,35 @@
+include ( ../../../../settings.pro )
+
+QT += xml sql network
+
+contains(QT_VERSION, ^4\\.[0-9]\\..*) {
+CONFIG += qtestlib
+}
+contains(QT_VERSION, ^5\\.[0-9]\\..*) {
+QT += testlib
+}
+
+TEMPLATE = app
+TARGET = test_mythdb
+DEPENDPATH += . ../.. ../../logging
+INCLUDEPATH += . ../.. ../../logging
+LIBS += -L../.. -lmythbase-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+contains(QMAKE_CXX, "g++") {
+  QMAKE_CXXFLAGS += -O0 -fprofile-arcs -ftest-coverage 
+  QMAKE_LFLAGS += -fprofile-arcs 
+}
+
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/zeromq/src/.libs/
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/nzmqt/src/
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../..
+
+# Input
+HEADERS += test_mythdb.h
+SOURCES += test_mythdb.cpp
+
+QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
+QMAKE_CLEAN += ; rm -f *.gcov *.gcda *.gcno
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
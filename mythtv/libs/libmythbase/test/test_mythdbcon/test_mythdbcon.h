@@ -0,0 +1,97 @@
+/*
+ *  Class TestMythDBCon
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythdbcon.h"
+
+class TestMythDBCon: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void init(void)
+    {
+        MSqlQueryProfiler::Reset();
+    }
+
+    void NormalizeCollapsesWhiteSpace(void)
+    {
+        QCOMPARE(MSqlQueryProfiler::Normalize(
+                     "  SELECT chanid,\n       starttime\tFROM   program "),
+                 QString("SELECT chanid, starttime FROM program"));
+    }
+
+    void NormalizeReplacesLiterals(void)
+    {
+        QCOMPARE(MSqlQueryProfiler::Normalize(
+                     "SELECT title FROM recorded WHERE chanid = 1021 "
+                     "AND title = 'It''s \\'on\\'' AND stars > 0.5"),
+                 QString("SELECT title FROM recorded WHERE chanid = ? "
+                         "AND title = ? AND stars > ?"));
+        QCOMPARE(MSqlQueryProfiler::Normalize(
+                     "DELETE FROM oldrecorded WHERE recordid IN (1, 22, 333)"),
+                 QString("DELETE FROM oldrecorded WHERE recordid IN (?, ?, ?)"));
+    }
+
+    void NormalizeKeepsPlaceholdersAndIdentifiers(void)
+    {
+        QString query("SELECT r.recordid FROM record r "
+                      "WHERE r.chanid = :CHANID1 AND r.type = :TYPE");
+        QCOMPARE(MSqlQueryProfiler::Normalize(query), query);
+    }
+
+    void StatementsWithDifferentLiteralsAreMerged(void)
+    {
+        MSqlQueryProfiler::Record("SELECT * FROM channel WHERE chanid = 1",
+                                  10, false);
+        MSqlQueryProfiler::Record("SELECT * FROM channel WHERE chanid = 2",
+                                  30, false);
+
+        QList<MSqlQueryProfiler::Stats> stats = MSqlQueryProfiler::GetStats();
+        QCOMPARE(stats.size(), 1);
+        QCOMPARE(stats[0].statement,
+                 QString("SELECT * FROM channel WHERE chanid = ?"));
+        QCOMPARE(stats[0].count, 2U);
+        QCOMPARE(stats[0].totalUsecs, qint64(40));
+        QCOMPARE(stats[0].maxUsecs, qint64(30));
+    }
+
+    void StatsAreSortedByTotalTime(void)
+    {
+        for (qint64 i = 1; i <= 100; ++i)
+            MSqlQueryProfiler::Record("SELECT :A", i, true);
+        MSqlQueryProfiler::Record("SELECT :B", 10000, true);
+        MSqlQueryProfiler::Record("SELECT :C", 1, true);
+
+        QList<MSqlQueryProfiler::Stats> stats = MSqlQueryProfiler::GetStats(2);
+        QCOMPARE(stats.size(), 2);
+        QCOMPARE(stats[0].statement, QString("SELECT :B"));
+        QCOMPARE(stats[1].statement, QString("SELECT :A"));
+        QCOMPARE(stats[1].count, 100U);
+        QCOMPARE(stats[1].p99Usecs, qint64(99));
+        QCOMPARE(stats[1].maxUsecs, qint64(100));
+    }
+
+    void ResetClearsStats(void)
+    {
+        MSqlQueryProfiler::Record("SELECT 1", 5, false);
+        MSqlQueryProfiler::Reset();
+        QVERIFY(MSqlQueryProfiler::GetStats().isEmpty());
+    }
+};
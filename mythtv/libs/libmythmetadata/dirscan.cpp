@@ -6,6 +6,7 @@
 #include "mythcorecontext.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "videodirindex.h"
 #include "remoteutil.h"
 #include "mythcontext.h"
 #include "mythlogging.h"
@@ -114,6 +115,45 @@ namespace
         return true;
     }
 
+    /// scan_dir() for directories listed through a VideoDirIndex, so that
+    /// only those that changed since the last scan are actually read.
+    void scan_indexed_dir(const QString &start_path, const QStringList &dirs,
+                          const QStringList &files, DirectoryHandler *handler,
+                          const ext_lookup &ext_settings, VideoDirIndex &index)
+    {
+        QDir d(start_path);
+
+        for (QStringList::const_iterator p = dirs.begin(); p != dirs.end(); ++p)
+        {
+            QString     path = d.absoluteFilePath(*p);
+            QStringList subdirs, subfiles;
+
+            // Since we are dealing with a subdirectory failure is fine
+            if (!index.List(path, subdirs, subfiles))
+                continue;
+
+            if (subdirs.contains("VIDEO_TS") || subdirs.contains("BDMV"))
+            {
+                handler->handleFile(*p, path, QFileInfo(*p).suffix(), "");
+                continue;
+            }
+
+            DirectoryHandler *dh = handler->newDir(*p, path);
+            scan_indexed_dir(path, subdirs, subfiles, dh, ext_settings, index);
+        }
+
+        for (QStringList::const_iterator p = files.begin(); p != files.end();
+             ++p)
+        {
+            QString suffix = QFileInfo(*p).suffix();
+
+            if (ext_settings.extension_ignored(suffix))
+                continue;
+
+            handler->handleFile(*p, d.absoluteFilePath(*p), suffix, "");
+        }
+    }
+
     bool scan_sg_dir(const QString &start_path, const QString &host,
                      const QString &base_path, DirectoryHandler *handler,
                      const ext_lookup &ext_settings, bool isMaster = false)
@@ -229,7 +269,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, VideoDirIndex *index)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -241,7 +281,24 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        bool scanned = false;
+
+        if (index)
+        {
+            QStringList dirs, files;
+
+            scanned = index->List(QDir(start_path).absolutePath(),
+                                  dirs, files);
+            if (scanned)
+            {
+                scan_indexed_dir(start_path, dirs, files, handler, extlookup,
+                                 *index);
+            }
+        }
+        else
+            scanned = scan_dir(start_path, handler, extlookup);
+
+        if (!scanned)
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
@@ -1,5 +1,7 @@
 #include "imagemetadata.h"
 
+#include <QFile>
+
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for avcodeclock
 #include "mythdirs.h"         // for ffprobe
@@ -475,6 +477,332 @@ QString PictureMetaData::DecodeComment(std::string rawValue)
 }
 
 
+//! TIFF byte order marks
+static const QByteArray kTiffIntel("II*\0", 4);
+static const QByteArray kTiffMotorola("MM\0*", 4);
+
+
+//! \brief Reads the scanner's Exif tags directly from a JPEG/TIFF header
+//! \details Only the Exif block is read, following IFD0 and the Exif sub-IFD,
+//! so scanning is bounded by a few small reads per file rather than libexiv2
+//! parsing every tag (and maker note) it finds. Informational tags are still
+//! provided by libexiv2.
+class ExifHeaderMetaData : public ImageMetaData
+{
+public:
+    explicit ExifHeaderMetaData(const QString &filePath);
+
+    virtual bool        IsValid()                  { return m_valid; }
+    virtual QStringList GetAllTags()
+    { return PictureMetaData(m_filePath).GetAllTags(); }
+    virtual int         GetOrientation(bool *exists = NULL);
+    virtual QDateTime   GetOriginalDateTime(bool *exists = NULL);
+    virtual QString     GetComment(bool *exists = NULL);
+
+protected:
+    bool    FindExif(qint64 &base, qint64 &length);
+    bool    ReadIfd(quint32 offset, bool exifIfd);
+    bool    Read(quint32 offset, quint32 size, QByteArray &data);
+    QString ReadText(const char *entry, bool comment);
+
+    quint16 Get16(const char *p) const
+    {
+        const uchar *u = reinterpret_cast<const uchar *>(p);
+        return m_bigEndian ? quint16(u[0] << 8 | u[1]) : quint16(u[1] << 8 | u[0]);
+    }
+    quint32 Get32(const char *p) const
+    {
+        return m_bigEndian ? quint32(Get16(p)) << 16 | Get16(p + 2)
+                           : quint32(Get16(p + 2)) << 16 | Get16(p);
+    }
+
+    QFile   m_file;
+    qint64  m_base;      //!< File offset of the TIFF header
+    qint64  m_length;    //!< Size of the TIFF block
+    bool    m_bigEndian;
+    bool    m_valid;
+
+    int     m_orientation;
+    QString m_dateTime, m_description, m_userComment;
+    bool    m_hasOrientation, m_hasDateTime, m_hasDescription, m_hasUserComment;
+};
+
+
+/*!
+   \brief Constructor. Reads the Exif header of a picture.
+   \details Invalid if the file isn't a JPEG/TIFF or its Exif can't be parsed
+   \param filePath Absolute image path
+ */
+ExifHeaderMetaData::ExifHeaderMetaData(const QString &filePath)
+    : ImageMetaData(filePath), m_file(filePath),
+      m_base(0), m_length(0), m_bigEndian(false), m_valid(false),
+      m_orientation(0),
+      m_hasOrientation(false), m_hasDateTime(false),
+      m_hasDescription(false), m_hasUserComment(false)
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return;
+
+    if (!FindExif(m_base, m_length))
+        return;
+
+    // A JPEG without Exif has no tags
+    if (m_length == 0)
+    {
+        m_valid = true;
+        return;
+    }
+
+    QByteArray header;
+    if (!Read(0, 8, header))
+        return;
+
+    if (header.startsWith(kTiffIntel))
+        m_bigEndian = false;
+    else if (header.startsWith(kTiffMotorola))
+        m_bigEndian = true;
+    else
+        return;
+
+    m_valid = ReadIfd(Get32(header.constData() + 4), false);
+}
+
+
+/*!
+   \brief Locates the TIFF structure holding the Exif tags
+   \param[out] base File offset of TIFF header
+   \param[out] length Size of TIFF data, 0 if a JPEG has no Exif
+   \return bool False if not a JPEG or TIFF file
+ */
+bool ExifHeaderMetaData::FindExif(qint64 &base, qint64 &length)
+{
+    QByteArray magic = m_file.read(4);
+
+    // TIFF files (and raw formats based on TIFF) are the Exif structure
+    if (magic.startsWith(kTiffIntel) || magic.startsWith(kTiffMotorola))
+    {
+        base   = 0;
+        length = m_file.size();
+        return true;
+    }
+
+    // JPEG must start with SOI
+    if (!magic.startsWith("\xFF\xD8"))
+        return false;
+
+    // Walk segments until Exif APP1 or the image data starts
+    qint64 pos = 2;
+    while (m_file.seek(pos))
+    {
+        QByteArray marker = m_file.read(4);
+        if (marker.size() < 4 || uchar(marker[0]) != 0xFF)
+            return false;
+
+        uchar   type = marker[1];
+        quint32 size = uchar(marker[2]) << 8 | uchar(marker[3]);
+
+        // Padding
+        if (type == 0xFF)
+        {
+            ++pos;
+            continue;
+        }
+
+        // Start of scan/end of image
+        if (type == 0xDA || type == 0xD9)
+            break;
+
+        if (type == 0xE1 && size > 8
+                && m_file.read(6) == QByteArray("Exif\0\0", 6))
+        {
+            base   = pos + 10;
+            length = size - 8;
+            return true;
+        }
+
+        pos += 2 + size;
+    }
+
+    base = length = 0;
+    return true;
+}
+
+
+/*!
+   \brief Reads bytes from the TIFF structure
+   \param offset Offset from TIFF header
+   \param size Number of bytes
+   \param[out] data Bytes read
+   \return bool False if the data lies outside of the TIFF structure
+ */
+bool ExifHeaderMetaData::Read(quint32 offset, quint32 size, QByteArray &data)
+{
+    if (qint64(offset) + size > m_length || !m_file.seek(m_base + offset))
+        return false;
+
+    data = m_file.read(size);
+    return quint32(data.size()) == size;
+}
+
+
+/*!
+   \brief Reads the scanner's tags from an image file directory
+   \param offset Offset of IFD from TIFF header
+   \param exifIfd True for the Exif sub-IFD, false for IFD0
+   \return bool False if the IFD is corrupt
+ */
+bool ExifHeaderMetaData::ReadIfd(quint32 offset, bool exifIfd)
+{
+    QByteArray count;
+    if (!Read(offset, 2, count))
+        return false;
+
+    QByteArray entries;
+    if (!Read(offset + 2, Get16(count.constData()) * 12, entries))
+        return false;
+
+    quint32 exifOffset = 0;
+
+    for (int i = 0; i + 12 <= entries.size(); i += 12)
+    {
+        const char *entry = entries.constData() + i;
+
+        switch (Get16(entry))
+        {
+        case 0x0112: // Exif.Image.Orientation, SHORT
+            if (!exifIfd)
+            {
+                m_orientation    = Get16(entry + 8);
+                m_hasOrientation = true;
+            }
+            break;
+
+        case 0x0132: // Exif.Image.DateTime, ASCII
+            if (!exifIfd)
+            {
+                m_dateTime    = ReadText(entry, false);
+                m_hasDateTime = true;
+            }
+            break;
+
+        case 0x010E: // Exif.Image.ImageDescription, ASCII
+            if (!exifIfd)
+            {
+                m_description    = ReadText(entry, false);
+                m_hasDescription = true;
+            }
+            break;
+
+        case 0x8769: // Exif IFD pointer, LONG
+            if (!exifIfd)
+                exifOffset = Get32(entry + 8);
+            break;
+
+        case 0x9286: // Exif.Photo.UserComment, UNDEFINED
+            if (exifIfd)
+            {
+                m_userComment    = ReadText(entry, true);
+                m_hasUserComment = true;
+            }
+            break;
+        }
+    }
+
+    // A broken Exif IFD loses the comment only
+    if (exifOffset)
+        (void) ReadIfd(exifOffset, true);
+
+    return true;
+}
+
+
+/*!
+   \brief Reads a text tag
+   \param entry IFD entry of the tag
+   \param comment True for UserComment, which is prefixed by its charset
+   \return QString Text of the tag
+ */
+QString ExifHeaderMetaData::ReadText(const char *entry, bool comment)
+{
+    quint32 size = Get32(entry + 4);
+
+    // Values of 4 bytes or less are held in the entry itself
+    QByteArray value;
+    if (size <= 4)
+        value = QByteArray(entry + 8, size);
+    else if (!Read(Get32(entry + 8), size, value))
+        return QString();
+
+    if (!comment)
+        return QString::fromUtf8(value.constData(), qstrnlen(value.constData(),
+                                                             value.size()));
+
+    // UserComment starts with an 8 byte charset code
+    QByteArray charset = value.left(8);
+    value = value.mid(8);
+
+    QString text;
+    if (charset.startsWith("UNICODE"))
+    {
+        const char *p = value.constData();
+        for (int i = 0; i + 1 < value.size(); i += 2)
+            text += QChar(Get16(p + i));
+    }
+    else
+        text = QString::fromUtf8(value.constData(),
+                                 qstrnlen(value.constData(), value.size()));
+
+    // Cameras pad comments with nulls or spaces
+    int end = text.size();
+    while (end > 0 && (text.at(end - 1).isNull() || text.at(end - 1).isSpace()))
+        --end;
+    return text.left(end);
+}
+
+
+/*!
+   \brief Read Exif orientation
+   \param [out] exists (Optional) True if orientation is defined by metadata
+   \return Exif orientation code
+ */
+int ExifHeaderMetaData::GetOrientation(bool *exists)
+{
+    if (exists)
+        *exists = m_hasOrientation;
+    return m_orientation;
+}
+
+
+/*!
+   \brief Read Exif timestamp of image capture
+   \param [out] exists (Optional) True if date exists in metadata
+   \return Timestamp (possibly invalid) in camera timezone
+ */
+QDateTime ExifHeaderMetaData::GetOriginalDateTime(bool *exists)
+{
+    if (exists)
+        *exists = m_hasDateTime;
+
+    // Exif time has no timezone
+    return QDateTime::fromString(m_dateTime, EXIF_TAG_DATE_FORMAT);
+}
+
+
+/*!
+   \brief Read Exif comments from metadata
+   \details Returns UserComment, if not empty. Otherwise returns ImageDescription
+   \param [out] exists (Optional) True if either comment is found in metadata
+   \return Comment as a string
+ */
+QString ExifHeaderMetaData::GetComment(bool *exists)
+{
+    if (exists)
+        *exists = m_hasUserComment || m_hasDescription;
+
+    return m_userComment.isEmpty() ? m_description : m_userComment;
+}
+
+
 //! Reads video metadata tags using FFmpeg
 //! Raw values for Orientation & Date are read quickly via FFmpeg API.
 //! However, as collating and interpreting other tags is messy and dependant on
@@ -703,6 +1031,24 @@ ImageMetaData* ImageMetaData::FromPicture(const QString &filePath)
 { return new PictureMetaData(filePath); }
 
 
+/*!
+   \brief Factory to retrieve the scanner's tags quickly from pictures
+   \details Reads the Exif header of JPEG & TIFF files directly. Other formats
+   use libexiv2, as FromPicture()
+   \param filePath Image path
+   \return Picture metadata reader
+*/
+ImageMetaData* ImageMetaData::FromPictureHeader(const QString &filePath)
+{
+    ExifHeaderMetaData *header = new ExifHeaderMetaData(filePath);
+    if (header->IsValid())
+        return header;
+
+    delete header;
+    return new PictureMetaData(filePath);
+}
+
+
 /*!
    \brief Factory to retrieve metadata from videos
    \param filePath Image path
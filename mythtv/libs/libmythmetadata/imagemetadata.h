@@ -1,6 +1,7 @@
 //! \file
 //! \brief Handles Exif/FFMpeg metadata tags for images
-//! \details For pictures, Exif tags are read using libexiv2 on demand
+//! \details For pictures, Exif tags are read using libexiv2 on demand. The
+//! scanner reads its tags straight from the Exif header of JPEG/TIFF files.
 //! For videos, tags are requested from mythffprobe
 //! Common tags (used by Gallery) are Orientation, Image Comment & Capture timestamp;
 //! all others are for information only. Videos have no comments; their orientation
@@ -97,6 +98,7 @@ class META_PUBLIC ImageMetaData
     Q_DECLARE_TR_FUNCTIONS(ImageMetaData)
 public:
     static ImageMetaData* FromPicture(const QString &filePath);
+    static ImageMetaData* FromPictureHeader(const QString &filePath);
     static ImageMetaData* FromVideo(const QString &filePath);
 
     virtual ~ImageMetaData() {}
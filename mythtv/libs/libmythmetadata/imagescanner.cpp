@@ -2,6 +2,7 @@
 
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for events
+#include "mythdbcon.h"        // for transactions
 
 #include "imagemetadata.h"
 
@@ -267,6 +268,13 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
     // Create directory node
     int id = SyncDirectory(dirInfo, devId, base, parentId);
 
+    // Files are listed before dirs. All Db writes for them use this query's
+    // connection, so are committed together in a single transaction
+    MSqlQuery transaction(MSqlQuery::InitCon());
+    bool inTransaction = transaction.exec("START TRANSACTION");
+    if (!inTransaction)
+        MythDB::DBError("ImageScanThread::SyncSubTree - start", transaction);
+
     // Sync its contents
     QFileInfoList list = dir.entryInfoList();
     foreach(const QFileInfo &fileInfo, list)
@@ -275,11 +283,19 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
         {
             LOG(VB_GENERAL, LOG_INFO,
                 QString("Scan interrupted in %2").arg(dirInfo.absoluteFilePath()));
-            return;
+            break;
         }
 
         if (fileInfo.isDir())
         {
+            if (inTransaction)
+            {
+                if (!transaction.exec("COMMIT"))
+                    MythDB::DBError("ImageScanThread::SyncSubTree - commit",
+                                    transaction);
+                inTransaction = false;
+            }
+
             // Scan this directory
             SyncSubTree(fileInfo, id, devId, base);
         }
@@ -295,6 +311,9 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
                 Broadcast(m_progressCount);
         }
     }
+
+    if (inTransaction && !transaction.exec("COMMIT"))
+        MythDB::DBError("ImageScanThread::SyncSubTree - commit", transaction);
 }
 
 
@@ -410,7 +429,7 @@ void ImageScanThread<DBFS>::PopulateMetadata
 {
     // Set orientation, date, comment from file meta data
     ImageMetaData *metadata = (type == kImageFile)
-            ? ImageMetaData::FromPicture(path)
+            ? ImageMetaData::FromPictureHeader(path)
             : ImageMetaData::FromVideo(path);
 
     orientation  = metadata->GetOrientation();
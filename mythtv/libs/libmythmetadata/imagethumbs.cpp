@@ -1,8 +1,18 @@
 #include "imagethumbs.h"
 
-#include <QDir>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QCryptographicHash>
+#include <QImageReader>
 #include <QStringList>
+#include <QRunnable>
+#include <QDateTime>
+#include <QThread>
+#include <QDir>
 
+#include "mthreadpool.h"
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for events
 #include "mythsystemlegacy.h" // for previewgen
@@ -11,17 +21,219 @@
 #include "mythimage.h"
 
 #include "imagemetadata.h"
+#include "imagemanager.h"
+
+//! Bytes hashed at the start, middle and end of videos
+#define SAMPLE_SIZE (64 * 1024)
+
+//! Unused store entries younger than this may be about to be linked
+#define PRUNE_AGE 60
+
+
+/*!
+ \brief Constructor
+*/
+ThumbStore::ThumbStore()
+    : m_dir(QString("%1/" TEMP_SUBDIR "/" THUMBNAIL_SUBDIR "/.store")
+            .arg(GetConfDir()))
+{}
+
+
+/*!
+ \brief Identify a file by its content
+ \param filePath Absolute path of the file
+ \param sampled If true only parts of the file are hashed, for large videos
+ \return QString Hash and size of the file, or empty if it can't be shared
+*/
+QString ThumbStore::ContentKey(const QString &filePath, bool sampled)
+{
+#ifdef _WIN32
+    // Entries are shared by hard links
+    Q_UNUSED(filePath)
+    Q_UNUSED(sampled)
+    return QString();
+#else
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    qint64 size = file.size();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    if (!sampled)
+    {
+        while (!file.atEnd())
+        {
+            QByteArray data = file.read(SAMPLE_SIZE);
+            if (data.isEmpty())
+                return QString();
+            hash.addData(data);
+        }
+    }
+    else
+    {
+        qint64 offsets[3] = { 0, (size - SAMPLE_SIZE) / 2, size - SAMPLE_SIZE };
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!file.seek(qMax(offsets[i], qint64(0))))
+                return QString();
+            hash.addData(file.read(SAMPLE_SIZE));
+        }
+    }
+
+    return QString("%1-%2").arg(QString(hash.result().toHex())).arg(size);
+#endif
+}
+
+
+/*!
+ \brief Get the store path of a thumbnail
+ \param key Content key of the image
+ \param orientation Orientation applied to the thumbnail
+ \param size Thumbnail bounds
+ \param suffix File type of the thumbnail
+ \return QString Absolute path of the store entry
+*/
+QString ThumbStore::EntryPath(const QString &key, int orientation,
+                              const QSize &size, const QString &suffix) const
+{
+    return QString("%1/%2-o%3-%4x%5.%6").arg(m_dir, key).arg(orientation)
+            .arg(size.width()).arg(size.height()).arg(suffix.toLower());
+}
+
+
+/*!
+ \brief Make a thumbnail path refer to a store entry
+ \param entry Store entry
+ \param thumbPath Thumbnail path of an image
+ \return bool True if the thumbnail now exists
+*/
+bool ThumbStore::Link(const QString &entry, const QString &thumbPath) const
+{
+    QDir::root().mkpath(QFileInfo(thumbPath).path());
+
+#ifndef _WIN32
+    if (link(entry.toLocal8Bit().constData(),
+             thumbPath.toLocal8Bit().constData()) == 0)
+        return true;
+#endif
+
+    // Hard links need the same filesystem
+    return QFile::copy(entry, thumbPath);
+}
+
+
+/*!
+ \brief Delete entries that are no longer linked to any image
+*/
+void ThumbStore::Prune() const
+{
+#ifndef _WIN32
+    uint limit = QDateTime::currentDateTime().toTime_t() - PRUNE_AGE;
+    int  count = 0;
+
+    QDir dir(m_dir);
+    foreach (const QString &name, dir.entryList(QDir::Files))
+    {
+        QString path = dir.absoluteFilePath(name);
+        struct stat st;
+
+        if (stat(path.toLocal8Bit().constData(), &st) == 0
+                && st.st_nlink <= 1 && uint(st.st_mtime) < limit
+                && dir.remove(name))
+            ++count;
+    }
+
+    if (count > 0)
+        LOG(VB_FILE, LOG_INFO,
+            QString("Pruned %1 unused thumbnails from %2").arg(count).arg(m_dir));
+#endif
+}
+
+
+/*!
+ \brief Load an image reduced to about twice the size of its thumbnail
+ \details Decoders that can scale whilst decoding, such as JPEG in the DCT
+ domain, do the bulk of the reduction much faster than scaling afterwards.
+ \param filePath Image file
+ \param size Largest thumbnail that will be made from the image
+ \return QImage Image, which is null if it could not be read
+*/
+QImage ThumbStore::LoadScaled(const QString &filePath, const QSize &size)
+{
+    QImageReader reader(filePath);
+
+    QSize full = reader.size();
+    if (full.isValid()
+            && reader.supportsOption(QImageIOHandler::ScaledSize))
+    {
+        QSize reduced = full;
+        reduced.scale(size * 2, Qt::KeepAspectRatio);
+
+        if (reduced.width() < full.width() && reduced.height() < full.height())
+            reader.setScaledSize(reduced);
+    }
+
+    return reader.read();
+}
+
+
+/*!
+ \brief Make several thumbnails from one decoded image
+ \param image Source image
+ \param sizes Thumbnail bounds
+ \return QList<QImage> A thumbnail for each size
+*/
+QList<QImage> ThumbStore::Scale(const QImage &image, const QList<QSize> &sizes)
+{
+    QList<QImage> thumbs;
+    foreach (const QSize &size, sizes)
+        thumbs << image.scaled(size, Qt::KeepAspectRatio,
+                               Qt::SmoothTransformation);
+    return thumbs;
+}
+
+
+//! Generates a picture thumbnail on a pool thread
+template <class DBFS>
+class ThumbCreator : public QRunnable
+{
+public:
+    ThumbCreator(ThumbThread<DBFS> &thread, const TaskPtr &task)
+        : m_thread(thread), m_task(task) {}
+
+    void run()
+    {
+        // As for the thumbnail threads
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        m_thread.HandleCreate(m_task);
+    }
+
+private:
+    ThumbThread<DBFS> &m_thread;
+    TaskPtr            m_task;
+};
+
 
 /*!
  \brief Constructor
  \param name Thread name
  \param dbfs Filesystem/Database adapter
+ \param workers Number of thumbnails to generate in parallel
 */
 template <class DBFS>
-ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs)
-    : MThread(name), m_dbfs(*dbfs),
+ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs,
+                               int workers)
+    : MThread(name), m_dbfs(*dbfs), m_store(), m_pruneStore(true),
+      m_workers(workers), m_pool(NULL),
       m_requestQ(), m_backgroundQ(), m_doBackground(true)
-{}
+{
+    if (m_workers > 1)
+    {
+        m_pool = new MThreadPool(name);
+        m_pool->setMaxThreadCount(m_workers);
+    }
+}
 
 
 /*!
@@ -32,6 +244,7 @@ ThumbThread<DBFS>::~ThumbThread()
 {
     cancel();
     wait();
+    delete m_pool;
 }
 
 
@@ -103,6 +316,22 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
 }
 
 
+/*!
+ \brief Prunes the store once current tasks are done
+ \details For thumbnails removed other than by a DELETE task, such as a device's
+ thumbnail dir. Starts the thread if it is idle.
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::PruneStore()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pruneStore = true;
+
+    if (!this->isRunning())
+        this->start();
+}
+
+
 /*!
   /brief Removes all tasks for a device from a task queue
  */
@@ -144,41 +373,41 @@ void ThumbThread<DBFS>::run()
         QThread::yieldCurrentThread();
 
         // process next highest-priority task
-        TaskPtr task;
-        {
-            QMutexLocker locker(&m_mutex);
-            if (!m_requestQ.isEmpty())
-                task = m_requestQ.take(m_requestQ.constBegin().key());
-            else if (m_doBackground && !m_backgroundQ.isEmpty())
-                task = m_backgroundQ.take(m_backgroundQ.constBegin().key());
-            else
-                // quit when both queues exhausted
-                break;
-        }
+        TaskPtr task = TakeTask(false);
+
+        // quit when both queues exhausted
+        if (!task)
+            break;
 
         // Shouldn't receive empty requests
         if (task->m_images.isEmpty())
             continue;
 
-        if (task->m_action == "CREATE")
+        if (task->m_action == "CREATE" && m_pool)
         {
-            ImagePtrK im = task->m_images.at(0);
-
-            QString err = CreateThumbnail(im, task->m_priority);
-
-            if (!err.isEmpty())
-            {
-                LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
-            }
-            else if (task->m_notify)
+            // Generate the next few thumbnails together
+            int started = 0;
+            while (task)
             {
-                // notify clients when done
-                m_dbfs.Notify("THUMB_AVAILABLE",
-                              QStringList(QString::number(im->m_id)));
+                if (!task->m_images.isEmpty())
+                    m_pool->start(new ThumbCreator<DBFS>(*this, task),
+                                  "ThumbCreator");
+
+                task = (++started < m_workers) ? TakeTask(true) : TaskPtr();
             }
+            m_pool->waitForDone();
+        }
+        else if (task->m_action == "CREATE")
+        {
+            HandleCreate(task);
         }
         else if (task->m_action == "DELETE")
         {
+            // Store entries may now be unused
+            m_mutex.lock();
+            m_pruneStore = true;
+            m_mutex.unlock();
+
             foreach(ImagePtrK im, task->m_images)
             {
                 QString thumbnail = im->m_thumbPath;
@@ -234,10 +463,67 @@ void ThumbThread<DBFS>::run()
                 QString("Unknown task %1").arg(task->m_action));
     }
 
+    m_mutex.lock();
+    bool prune = m_pruneStore;
+    m_pruneStore = false;
+    m_mutex.unlock();
+
+    if (prune)
+        m_store.Prune();
+
     RunEpilog();
 }
 
 
+/*!
+ \brief Take the next task to process
+ \param createOnly If true, only take the next task if it is a Create request
+ \return TaskPtr Highest priority task, or null if there is none
+*/
+template <class DBFS>
+TaskPtr ThumbThread<DBFS>::TakeTask(bool createOnly)
+{
+    QMutexLocker locker(&m_mutex);
+
+    ThumbQueue *queue = NULL;
+    if (!m_requestQ.isEmpty())
+        queue = &m_requestQ;
+    else if (m_doBackground && !m_backgroundQ.isEmpty())
+        queue = &m_backgroundQ;
+    else
+        return TaskPtr();
+
+    if (createOnly && queue->constBegin().value()->m_action != "CREATE")
+        return TaskPtr();
+
+    return queue->take(queue->constBegin().key());
+}
+
+
+/*!
+ \brief Handle a Create request
+ \param task The request
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::HandleCreate(const TaskPtr &task)
+{
+    ImagePtrK im = task->m_images.at(0);
+
+    QString err = CreateThumbnail(im, task->m_priority);
+
+    if (!err.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
+    }
+    else if (task->m_notify)
+    {
+        // notify clients when done
+        m_dbfs.Notify("THUMB_AVAILABLE",
+                      QStringList(QString::number(im->m_id)));
+    }
+}
+
+
 /*!
  \brief Generate thumbnail for an image
  \param im Image
@@ -256,30 +542,58 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
     // Local filenames are always absolute
     // Remote filenames are absolute from the scanner only
     // UI requests (derived from Db) are relative
-    QString imagePath = m_dbfs.GetAbsFilePath(im);
+    QString imagePath;
+    {
+        QMutexLocker locker(&m_dbfsLock);
+        imagePath = m_dbfs.GetAbsFilePath(im);
+    }
     if (imagePath.isEmpty())
         return QString("Empty image path: %1").arg(im->m_filePath);
 
     // Ensure path exists
     QDir::root().mkpath(QFileInfo(im->m_thumbPath).path());
 
+    // Compensate for any Qt auto-orientation
+    int orientBy = Orientation(im->m_orientation)
+            .GetCurrent(im->m_type == kImageFile);
+
+    // Video thumbnails are also shown in slideshow
+    QSize size = im->m_type == kVideoFile ? QSize(320, 240) : QSize(240, 180);
+
+    // Images with the same content share a thumbnail
+    QString suffix = QFileInfo(im->m_thumbPath).suffix().toLower();
+    QString key    = ThumbStore::ContentKey(imagePath, im->m_type == kVideoFile);
+    QString entry  = key.isEmpty()
+            ? QString() : m_store.EntryPath(key, orientBy, size, suffix);
+
+    if (!entry.isEmpty() && QFile::exists(entry)
+            && m_store.Link(entry, im->m_thumbPath))
+    {
+        LOG(VB_FILE, LOG_INFO,  QString("[%2] Shared %1")
+            .arg(im->m_thumbPath).arg(thumbPriority));
+        return QString();
+    }
+
+    QString output = entry.isEmpty() ? im->m_thumbPath : entry;
+
     QImage image;
     if (im->m_type == kImageFile)
     {
-        if (!image.load(imagePath))
+        image = ThumbStore::LoadScaled(imagePath, size);
+        if (image.isNull())
             return QString("Failed to open image %1").arg(imagePath);
 
         // Resize to optimise load/display time by FE's
-        image = image.scaled(QSize(240,180), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        image = ThumbStore::Scale(image, QList<QSize>() << size).at(0);
     }
     else if (im->m_type == kVideoFile)
     {
         // Run Preview Generator in foreground
         QString cmd = GetAppBinDir() + MYTH_APPNAME_MYTHPREVIEWGEN;
         QStringList args;
-        args << "--size 320x240"; // Video thumbnails are also shown in slideshow
+        args << QString("--size %1x%2").arg(size.width()).arg(size.height());
         args << QString("--infile '%1'").arg(imagePath);
-        args << QString("--outfile '%1'").arg(im->m_thumbPath);
+        args << QString("--outfile '%1'").arg(output);
 
         MythSystemLegacy ms(cmd, args,
                             kMSRunShell           |
@@ -298,24 +612,42 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
             return QString("Preview Generator failed for %1").arg(imagePath);
         }
 
-        if (!image.load(im->m_thumbPath))
-            return QString("Failed to open preview %1").arg(im->m_thumbPath);
+        if (!image.load(output))
+            return QString("Failed to open preview %1").arg(output);
     }
     else
         return QString("Can't create thumbnail for type %1 (image %2)")
                 .arg(im->m_type).arg(imagePath);
 
-    // Compensate for any Qt auto-orientation
-    int orientBy = Orientation(im->m_orientation)
-            .GetCurrent(im->m_type == kImageFile);
-
     // Orientate now to optimise load/display time - no orientation
     // is required when displaying thumbnails
     image = MythImage::ApplyExifOrientation(image, orientBy);
 
-    // Create the thumbnail
-    if (!image.save(im->m_thumbPath))
-        return QString("Failed to create thumbnail %1").arg(im->m_thumbPath);
+    if (entry.isEmpty())
+    {
+        // Create the thumbnail
+        if (!image.save(im->m_thumbPath))
+            return QString("Failed to create thumbnail %1").arg(im->m_thumbPath);
+    }
+    else
+    {
+        // Another worker may be creating the same entry, so write it aside
+        // and rename it into place
+        QString temp = QString("%1.%2.tmp").arg(entry)
+                .arg(quintptr(QThread::currentThread()), 0, 16);
+
+        if (!image.save(temp, suffix.toLatin1().constData()))
+        {
+            QFile::remove(temp);
+            return QString("Failed to create thumbnail %1").arg(entry);
+        }
+
+        if (!QFile::rename(temp, entry))
+            QFile::remove(temp);
+
+        if (!m_store.Link(entry, im->m_thumbPath))
+            return QString("Failed to link thumbnail %1").arg(im->m_thumbPath);
+    }
 
     LOG(VB_FILE, LOG_INFO,  QString("[%2] Created %1")
         .arg(im->m_thumbPath).arg(thumbPriority));
@@ -344,7 +676,10 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
 template <class DBFS>
 ImageThumb<DBFS>::ImageThumb(DBFS *const dbfs)
     : m_dbfs(*dbfs),
-      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs)),
+      // Leave a core for the frontend/backend itself
+      m_imageThread(new ThumbThread<DBFS>(
+                        "ImageThumbs", dbfs,
+                        qBound(1, QThread::idealThreadCount() - 1, 4))),
       m_videoThread(new ThumbThread<DBFS>("VideoThumbs", dbfs))
 {}
 
@@ -379,6 +714,11 @@ void ImageThumb<DBFS>::ClearThumbs(int devId, const QString &action)
 
     // Remove devices now they are not in use
     QStringList mountPaths = m_dbfs.CloseDevices(devId, action);
+
+    // Their thumbnails are gone, so store entries may now be unused.
+    // Image and video threads share the store, so one prune will do.
+    if (m_imageThread)
+        m_imageThread->PruneStore();
 //    if (mountPaths.isEmpty())
 //        return;
 
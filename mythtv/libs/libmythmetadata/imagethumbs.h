@@ -10,17 +10,25 @@
 //! When images are removed, their thumbnails are also deleted (thumbnail cache is
 //! synchronised to database). Obsolete images are broadcast to enable clients to
 //! also cleanup/synchronise their caches.
+//! Thumbnails are generated once per file content into a shared store and hard
+//! linked to each image's thumbnail path, so duplicate and moved images reuse
+//! the same thumbnail. Several pictures are generated in parallel.
 
 #ifndef IMAGETHUMBS_H
 #define IMAGETHUMBS_H
 
 #include <QMap>
+#include <QList>
+#include <QSize>
+#include <QImage>
 #include <QMutex>
 #include <QWaitCondition>
 
 #include "imagetypes.h"
 #include "mthread.h"
 
+class MThreadPool;
+
 //! \brief Priority of a thumbnail request. First/lowest are handled before later/higher
 //! \details Ordered to optimise perceived client performance, ie. pictures will be
 //! displayed before directories (4 thumbnails), then videos (slow to generate) are filled
@@ -78,18 +86,43 @@ public:
 typedef QSharedPointer<ThumbTask> TaskPtr;
 
 
+//! \brief Thumbnails shared by all images with the same content
+//! \details Entries are named by content hash, file size, orientation and
+//! thumbnail size. Image thumbnail paths are hard links to them and an entry
+//! is pruned once nothing links to it any more.
+class META_PUBLIC ThumbStore
+{
+public:
+    ThumbStore();
+
+    static QString ContentKey(const QString &filePath, bool sampled);
+
+    QString EntryPath(const QString &key, int orientation, const QSize &size,
+                      const QString &suffix) const;
+    bool    Link(const QString &entry, const QString &thumbPath) const;
+    void    Prune() const;
+
+    static QImage       LoadScaled(const QString &filePath, const QSize &size);
+    static QList<QImage> Scale(const QImage &image, const QList<QSize> &sizes);
+
+private:
+    QString m_dir; //!< Store location, beside the device thumbnail dirs
+};
+
+
 //! A generator worker thread
 template <class DBFS>
 class ThumbThread : public MThread
 {
 public:
-    ThumbThread(const QString &name, DBFS *const dbfs);
+    ThumbThread(const QString &name, DBFS *const dbfs, int workers = 1);
     ~ThumbThread();
 
     void cancel();
     void Enqueue(const TaskPtr &task);
     void AbortDevice(int devId, const QString &action);
     void PauseBackground(bool pause);
+    void PruneStore();
 
 protected:
     void run();
@@ -100,10 +133,19 @@ private:
     //! A priority queue where 0 is highest priority
     typedef QMultiMap<int, TaskPtr> ThumbQueue;
 
+    template <class T> friend class ThumbCreator;
+
+    TaskPtr TakeTask(bool createOnly);
+    void    HandleCreate(const TaskPtr &task);
     QString CreateThumbnail(ImagePtrK im, int thumbPriority);
     static void RemoveTasks(ThumbQueue &queue, int devId);
 
     DBFS &m_dbfs;               //!< Database/filesystem adapter
+    QMutex m_dbfsLock;          //!< Serialises adapter use by the workers
+    ThumbStore m_store;         //!< Thumbnails shared between images
+    bool m_pruneStore;          //!< Whether store may have unused entries
+    int m_workers;              //!< Thumbnails generated in parallel
+    MThreadPool *m_pool;        //!< Generators, when more than one
     QWaitCondition m_taskDone;  //! Synchronises completed tasks
 
     ThumbQueue m_requestQ;   //!< Priority queue of requests
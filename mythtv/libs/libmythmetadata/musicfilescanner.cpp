@@ -2,21 +2,116 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+// C++ headers
+#include <vector>
+
 // Qt headers
+#include <QWaitCondition>
+#include <QRunnable>
+#include <QThread>
 #include <QDir>
 
 // MythTV headers
 #include <mythdate.h>
 #include <mythdb.h>
 #include <mythcontext.h>
+#include <mthreadpool.h>
+#include <mythtimer.h>
 #include <musicmetadata.h>
 #include <metaio.h>
 #include <musicfilescanner.h>
 
+/// A track to add or update, with what was read from its file
+class MusicFileScanner::ScannedTrack
+{
+  public:
+    ScannedTrack() : location(kFileSystem), data(NULL), fileSize(0),
+        readTime(0) {}
+
+    QString           filename;
+    QString           startDir;
+    MusicFileLocation location;
+    MusicMetadata    *data;
+    AlbumArtList      embeddedArt;
+    quint64           fileSize;
+    int               readTime;
+};
+
+/// The files of one directory, read in parallel and then written to the
+/// database in one transaction
+class MusicFileScanner::TrackBatch
+{
+  public:
+    TrackBatch() : pending(0) {}
+
+    void Wait(void)
+    {
+        QMutexLocker locker(&lock);
+        while (pending > 0)
+            done.wait(&lock);
+    }
+
+    std::vector<ScannedTrack> tracks;
+    QStringList               removed;
+    QStringList               removedStartDirs;
+
+    QMutex                    lock;
+    QWaitCondition            done;
+    int                       pending;
+};
+
+class MusicFileScanner::TagReadTask : public QRunnable
+{
+  public:
+    TagReadTask(TrackBatch &batch, ScannedTrack &track) :
+        m_batch(batch), m_track(track) {}
+
+    void run(void)
+    {
+        MythTimer timer;
+        timer.start();
+
+        LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1")
+            .arg(m_track.filename));
+
+        m_track.data = MetaIO::readMetadata(m_track.filename);
+
+        if (m_track.data)
+        {
+            m_track.fileSize = (quint64)QFileInfo(m_track.filename).size();
+
+            // Embedded images are only picked up for new tracks
+            if (m_track.location == kFileSystem)
+            {
+                MetaIO *tagger = MetaIO::createTagger(m_track.filename);
+
+                if (tagger)
+                {
+                    if (tagger->supportsEmbeddedImages())
+                        m_track.embeddedArt =
+                            tagger->getAlbumArtList(m_track.data->Filename());
+                    delete tagger;
+                }
+            }
+        }
+
+        m_track.readTime = timer.elapsed();
+
+        QMutexLocker locker(&m_batch.lock);
+        if (--m_batch.pending == 0)
+            m_batch.done.wakeAll();
+    }
+
+  private:
+    TrackBatch   &m_batch;
+    ScannedTrack &m_track;
+};
+
 MusicFileScanner::MusicFileScanner():
     m_tracksTotal(0), m_tracksUnchanged(0), m_tracksAdded (0), m_tracksRemoved(0),
     m_tracksUpdated(0), m_coverartTotal(0), m_coverartUnchanged(0), m_coverartAdded(0),
-    m_coverartRemoved(0), m_coverartUpdated(0)
+    m_coverartRemoved(0), m_coverartUpdated(0),
+    m_findTime(0), m_readTime(0), m_dbTime(0), m_tracksRead(0)
 {
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -252,12 +347,8 @@ bool MusicFileScanner::HasFileChanged(
 }
 
 /*!
- * \brief Insert file details into database.
- *        If it is an audio file, read the metadata and insert
- *        that information at the same time.
- *
- *        If it is an image file, just insert the filename and
- *        type.
+ * \brief Insert an image file into the database, just the filename
+ *        and type. Tracks go through AddTrackToDB().
  *
  * \param filename Full path to file.
  *
@@ -297,75 +388,78 @@ void MusicFileScanner::AddFileToDB(const QString &filename, const QString &start
         return;
     }
 
-    if (extension.isEmpty() || !MetaIO::ValidFileExtensions.contains(extension.toLower()))
-    {
-        LOG(VB_GENERAL, LOG_WARNING, QString("Ignoring filename with unsupported filename: '%1'").arg(filename));
-        return;
-    }
+    LOG(VB_GENERAL, LOG_WARNING,
+        QString("Ignoring file that isn't artwork: '%1'").arg(filename));
+}
 
-    LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1").arg(filename));
-    MusicMetadata *data = MetaIO::readMetadata(filename);
-    if (data)
-    {
-        data->setFileSize((quint64)QFileInfo(filename).size());
-        data->setHostname(gCoreContext->GetHostName());
+/*!
+ * \brief Insert a track into the database.
+ *
+ * \param track The track, with the metadata read from its file.
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::AddTrackToDB(ScannedTrack &track)
+{
+    QString directory = track.filename;
+    directory.remove(0, track.startDir.length());
+    directory = directory.section( '/', 0, -2);
 
-        QString album_cache_string;
+    MusicMetadata *data = track.data;
 
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did >= 0)
-            data->setDirectoryId(did);
+    data->setFileSize(track.fileSize);
+    data->setHostname(gCoreContext->GetHostName());
 
-        int aid = m_artistid[data->Artist().toLower()];
-        if (aid > 0)
-        {
-            data->setArtistId(aid);
+    QString album_cache_string;
 
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(data->getArtistId()) + "#"
-                + data->Album().toLower();
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did >= 0)
+        data->setDirectoryId(did);
 
-            if (m_albumid[album_cache_string] > 0)
-                data->setAlbumId(m_albumid[album_cache_string]);
-        }
+    int aid = m_artistid[data->Artist().toLower()];
+    if (aid > 0)
+    {
+        data->setArtistId(aid);
 
-        int gid = m_genreid[data->Genre().toLower()];
-        if (gid > 0)
-            data->setGenreId(gid);
+        // The album cache depends on the artist id
+        album_cache_string = QString::number(data->getArtistId()) + "#"
+            + data->Album().toLower();
 
-        // Commit track info to database
-        data->dumpToDatabase();
+        if (m_albumid[album_cache_string] > 0)
+            data->setAlbumId(m_albumid[album_cache_string]);
+    }
 
-        // Update the cache
-        m_artistid[data->Artist().toLower()] =
-            data->getArtistId();
+    int gid = m_genreid[data->Genre().toLower()];
+    if (gid > 0)
+        data->setGenreId(gid);
 
-        m_genreid[data->Genre().toLower()] =
-            data->getGenreId();
+    // Commit track info to database
+    data->dumpToDatabase();
 
-        album_cache_string = QString::number(data->getArtistId()) + "#"
-            + data->Album().toLower();
-        m_albumid[album_cache_string] = data->getAlbumId();
+    // Update the cache
+    m_artistid[data->Artist().toLower()] =
+        data->getArtistId();
 
-        // read any embedded images from the tag
-        MetaIO *tagger = MetaIO::createTagger(filename);
+    m_genreid[data->Genre().toLower()] =
+        data->getGenreId();
 
-        if (tagger)
-        {
-            if (tagger->supportsEmbeddedImages())
-            {
-                AlbumArtList artList = tagger->getAlbumArtList(data->Filename());
-                data->setEmbeddedAlbumArt(artList);
-                data->getAlbumArtImages()->dumpToDatabase();
-            }
-            delete tagger;
-        }
+    album_cache_string = QString::number(data->getArtistId()) + "#"
+        + data->Album().toLower();
+    m_albumid[album_cache_string] = data->getAlbumId();
 
-        delete data;
+    // save any embedded images from the tag, now we have a track id
+    if (!track.embeddedArt.isEmpty())
+    {
+        data->setEmbeddedAlbumArt(track.embeddedArt);
+        data->getAlbumArtImages()->dumpToDatabase();
 
-        ++m_tracksAdded;
+        // setEmbeddedAlbumArt() took copies
+        qDeleteAll(track.embeddedArt);
+        track.embeddedArt.clear();
     }
+
+    ++m_tracksAdded;
 }
 
 /*!
@@ -550,23 +644,21 @@ void MusicFileScanner::RemoveFileFromDB(const QString &filename, const QString &
 }
 
 /*!
- * \brief Updates a file in the database.
+ * \brief Updates a track in the database.
  *
- * \param filename Full path to file.
+ * \param track The track, with the metadata read from its file.
  *
  * \returns Nothing.
  */
-void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &startDir)
+void MusicFileScanner::UpdateTrackInDB(ScannedTrack &track)
 {
-    QString dbFilename = filename;
-    dbFilename.remove(0, startDir.length());
+    QString dbFilename = track.filename;
+    dbFilename.remove(0, track.startDir.length());
 
-    QString directory = filename;
-    directory.remove(0, startDir.length());
-    directory = directory.section( '/', 0, -2);
+    QString directory = dbFilename.section( '/', 0, -2);
 
     MusicMetadata *db_meta   = MetaIO::getMetadata(dbFilename);
-    MusicMetadata *disk_meta = MetaIO::readMetadata(filename);
+    MusicMetadata *disk_meta = track.data;
 
     if (db_meta && disk_meta)
     {
@@ -575,7 +667,6 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
             LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
                                                 "invalid ID - %1")
                                             .arg(db_meta->ID()));
-            delete disk_meta;
             delete db_meta;
             return;
         }
@@ -609,7 +700,7 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
         if (gid > 0)
             disk_meta->setGenreId(gid);
 
-        disk_meta->setFileSize((quint64)QFileInfo(filename).size());
+        disk_meta->setFileSize(track.fileSize);
 
         disk_meta->setHostname(gCoreContext->GetHostName());
 
@@ -626,13 +717,168 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
         m_albumid[album_cache_string] = disk_meta->getAlbumId();
     }
 
-    if (disk_meta)
-        delete disk_meta;
-
     if (db_meta)
         delete db_meta;
 }
 
+/*!
+ * \brief Adds, updates and removes the tracks in music_files.
+ *
+ *        Tags are read by a pool of threads, a few directories ahead of
+ *        the database writes. Each directory's changes are written in a
+ *        single transaction.
+ *
+ * \param music_files MusicLoadedMap
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::UpdateTracks(MusicLoadedMap &music_files)
+{
+    int threads = qMax(QThread::idealThreadCount(), 2);
+
+    MThreadPool pool("MusicFileScanner");
+    pool.setMaxThreadCount(threads);
+
+    QList<TrackBatch*> batches;
+    MusicLoadedMap::ConstIterator iter = music_files.constBegin();
+
+    while (iter != music_files.constEnd() || !batches.isEmpty())
+    {
+        // Keep the readers busy while the oldest directory is written
+        while (iter != music_files.constEnd() && batches.size() < threads * 2)
+            batches.push_back(StartBatch(pool, music_files, iter));
+
+        TrackBatch *batch = batches.takeFirst();
+        batch->Wait();
+        WriteBatch(*batch);
+        delete batch;
+    }
+
+    pool.waitForDone();
+}
+
+/// Queues reading the tags of the files from iter on that are in the same
+/// directory, leaving iter at the first file of the next directory.
+MusicFileScanner::TrackBatch *MusicFileScanner::StartBatch(
+    MThreadPool &pool, const MusicLoadedMap &music_files,
+    MusicLoadedMap::ConstIterator &iter)
+{
+    TrackBatch *batch     = new TrackBatch;
+    QString     directory = iter.key().section('/', 0, -2);
+
+    for (; iter != music_files.constEnd() &&
+             iter.key().section('/', 0, -2) == directory; ++iter)
+    {
+        if ((*iter).location == MusicFileScanner::kDatabase)
+        {
+            batch->removed << iter.key();
+            batch->removedStartDirs << (*iter).startDir;
+        }
+        else if ((*iter).location == MusicFileScanner::kFileSystem ||
+                 (*iter).location == MusicFileScanner::kNeedUpdate)
+        {
+            ScannedTrack track;
+            track.filename = iter.key();
+            track.startDir = (*iter).startDir;
+            track.location = (*iter).location;
+            batch->tracks.push_back(track);
+        }
+    }
+
+    // The tracks mustn't move once the readers have been given them
+    batch->pending = batch->tracks.size();
+
+    std::vector<ScannedTrack>::iterator it = batch->tracks.begin();
+    for (; it != batch->tracks.end(); ++it)
+        pool.start(new TagReadTask(*batch, *it), "MusicTagReader");
+
+    return batch;
+}
+
+void MusicFileScanner::WriteBatch(TrackBatch &batch)
+{
+    MythTimer timer;
+    timer.start();
+
+    // Everything below uses this query's connection while it is open, so
+    // the whole directory goes in one transaction.
+    MSqlQuery transaction(MSqlQuery::InitCon());
+
+    if (!transaction.exec("START TRANSACTION"))
+        MythDB::DBError("MusicFileScanner::WriteBatch - start", transaction);
+
+    for (int x = 0; x < batch.removed.size(); x++)
+        RemoveFileFromDB(batch.removed[x], batch.removedStartDirs[x]);
+
+    std::vector<ScannedTrack>::iterator it = batch.tracks.begin();
+    for (; it != batch.tracks.end(); ++it)
+    {
+        m_readTime += it->readTime;
+        ++m_tracksRead;
+
+        if (it->location == MusicFileScanner::kNeedUpdate)
+        {
+            UpdateTrackInDB(*it);
+            ++m_tracksUpdated;
+        }
+        else if (it->data)
+            AddTrackToDB(*it);
+
+        delete it->data;
+        it->data = NULL;
+        qDeleteAll(it->embeddedArt);
+    }
+
+    if (!transaction.exec("COMMIT"))
+        MythDB::DBError("MusicFileScanner::WriteBatch - commit", transaction);
+
+    m_dbTime += timer.elapsed();
+}
+
+/*!
+ * \brief Adds and removes the images in art_files, a transaction per
+ *        directory as for the tracks.
+ *
+ * \param art_files MusicLoadedMap
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::UpdateArtwork(MusicLoadedMap &art_files)
+{
+    MythTimer timer;
+    timer.start();
+
+    QString   artDirectory;
+    MSqlQuery transaction(MSqlQuery::InitCon());
+
+    MusicLoadedMap::Iterator iter;
+    for (iter = art_files.begin(); iter != art_files.end(); iter++)
+    {
+        QString directory = iter.key().section('/', 0, -2);
+        if (directory != artDirectory)
+        {
+            if (!artDirectory.isEmpty() && !transaction.exec("COMMIT"))
+                MythDB::DBError("MusicFileScanner::UpdateArtwork - commit",
+                                transaction);
+            if (!transaction.exec("START TRANSACTION"))
+                MythDB::DBError("MusicFileScanner::UpdateArtwork - start",
+                                transaction);
+            artDirectory = directory;
+        }
+
+        if ((*iter).location == MusicFileScanner::kFileSystem)
+            AddFileToDB(iter.key(), (*iter).startDir);
+        else if ((*iter).location == MusicFileScanner::kDatabase)
+            RemoveFileFromDB(iter.key(), (*iter).startDir);
+    }
+
+    if (!artDirectory.isEmpty() && !transaction.exec("COMMIT"))
+        MythDB::DBError("MusicFileScanner::UpdateArtwork - commit",
+                        transaction);
+
+    m_dbTime += timer.elapsed();
+}
+
 /*!
  * \brief Scan a list of directories recursively for music and albumart.
  *        Inserts, updates and removes any files any files found in the
@@ -685,10 +931,14 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
 
     m_tracksTotal = m_tracksAdded = m_tracksUnchanged = m_tracksRemoved = m_tracksUpdated = 0;
     m_coverartTotal = m_coverartAdded = m_coverartUnchanged = m_coverartRemoved = m_coverartUpdated = 0;
+    m_findTime = m_readTime = m_dbTime = 0;
+    m_tracksRead = 0;
+
+    MythTimer totalTimer;
+    totalTimer.start();
 
     MusicLoadedMap music_files;
     MusicLoadedMap art_files;
-    MusicLoadedMap::Iterator iter;
 
     for (int x = 0; x < dirList.count(); x++)
     {
@@ -705,49 +955,18 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     ScanMusic(music_files);
     ScanArtwork(art_files);
 
-    LOG(VB_GENERAL, LOG_INFO, "Updating database");
-
-        /*
-        This can be optimised quite a bit by consolidating all commands
-        via a lot of refactoring.
-
-        1) group all files of the same decoder type, and don't
-        create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-        singletons, it should be a fairly simple change.
-
-        2) RemoveFileFromDB should group the remove into one big SQL.
-
-        3) UpdateFileInDB, same as 1.
-        */
+    m_findTime = totalTimer.elapsed();
 
-    for (iter = music_files.begin(); iter != music_files.end(); iter++)
-    {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
-            RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_tracksUpdated;
-        }
-    }
+    LOG(VB_GENERAL, LOG_INFO, "Updating database");
 
-    for (iter = art_files.begin(); iter != art_files.end(); iter++)
-    {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
-            RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_coverartUpdated;
-        }
-    }
+    UpdateTracks(music_files);
+    UpdateArtwork(art_files);
 
     // Cleanup orphaned entries from the database
+    MythTimer timer;
+    timer.start();
     cleanDB();
+    m_dbTime += timer.elapsed();
 
     QString trackStatus = QString("total tracks found: %1 (unchanged: %2, added: %3, removed: %4, updated %5)")
                                   .arg(m_tracksTotal).arg(m_tracksUnchanged).arg(m_tracksAdded)
@@ -757,9 +976,20 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
                                      .arg(m_coverartRemoved).arg(m_coverartUpdated);
 
 
+    int elapsed = totalTimer.elapsed();
+    QString timeStatus = QString("read %1 tracks in %2s (%3 files/sec), "
+                                 "finding files: %4s, reading tags: %5s (all readers), "
+                                 "database: %6s")
+        .arg(m_tracksRead).arg(elapsed / 1000.0, 0, 'f', 1)
+        .arg(elapsed > 0 ? m_tracksRead * 1000.0 / elapsed : 0.0, 0, 'f', 1)
+        .arg(m_findTime / 1000.0, 0, 'f', 1)
+        .arg(m_readTime / 1000.0, 0, 'f', 1)
+        .arg(m_dbTime / 1000.0, 0, 'f', 1);
+
     LOG(VB_GENERAL, LOG_INFO, "Music file scanner finished ");
     LOG(VB_GENERAL, LOG_INFO, trackStatus);
     LOG(VB_GENERAL, LOG_INFO, coverartStatus);
+    LOG(VB_GENERAL, LOG_INFO, timeStatus);
 
     gCoreContext->SendMessage(QString("MUSIC_SCANNER_FINISHED %1 %2 %3 %4 %5")
                                       .arg(host).arg(m_tracksTotal).arg(m_tracksAdded)
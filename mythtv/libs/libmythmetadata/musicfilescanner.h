@@ -7,6 +7,8 @@
 // Qt headers
 #include <QCoreApplication>
 
+class MThreadPool;
+
 typedef QMap<QString, int> IdCache;
 
 class META_PUBLIC MusicFileScanner
@@ -28,6 +30,11 @@ class META_PUBLIC MusicFileScanner
     };
 
     typedef QMap <QString, MusicFileData> MusicLoadedMap;
+
+    class ScannedTrack;
+    class TrackBatch;
+    class TagReadTask;
+
     public:
         MusicFileScanner(void);
         ~MusicFileScanner(void);
@@ -41,8 +48,15 @@ class META_PUBLIC MusicFileScanner
         int  GetDirectoryId(const QString &directory, const int &parentid);
         bool HasFileChanged(const QString &filename, const QString &date_modified);
         void AddFileToDB(const QString &filename, const QString &startDir);
+        void AddTrackToDB(ScannedTrack &track);
         void RemoveFileFromDB (const QString &filename, const QString &startDir);
-        void UpdateFileInDB(const QString &filename, const QString &startDir);
+        void UpdateTrackInDB(ScannedTrack &track);
+        void UpdateTracks(MusicLoadedMap &music_files);
+        TrackBatch *StartBatch(MThreadPool &pool,
+                               const MusicLoadedMap &music_files,
+                               MusicLoadedMap::ConstIterator &iter);
+        void WriteBatch(TrackBatch &batch);
+        void UpdateArtwork(MusicLoadedMap &art_files);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
         void cleanDB();
@@ -61,6 +75,11 @@ class META_PUBLIC MusicFileScanner
 
         uint m_tracksTotal, m_tracksUnchanged, m_tracksAdded, m_tracksRemoved, m_tracksUpdated;
         uint m_coverartTotal, m_coverartUnchanged, m_coverartAdded, m_coverartRemoved, m_coverartUpdated;
+
+        // msecs spent walking directories, reading tags (summed over all
+        // the readers) and writing to the database
+        qint64 m_findTime, m_readTime, m_dbTime;
+        uint   m_tracksRead;
 };
 
 #endif // _MUSICFILESCANNER_H_
@@ -0,0 +1,3 @@
+#include "test_imagemetadata.h"
+
+QTEST_APPLESS_MAIN(TestImageMetaData)
@@ -0,0 +1,200 @@
+/*
+ *  Class TestImageMetaData
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QDir>
+
+#include "imagemetadata.h"
+
+class TestImageMetaData: public QObject
+{
+    Q_OBJECT
+
+  private:
+    QString m_path;
+    bool    m_bigEndian;
+
+    void Put16(QByteArray &data, quint16 value)
+    {
+        if (m_bigEndian)
+            data.append(char(value >> 8)).append(char(value));
+        else
+            data.append(char(value)).append(char(value >> 8));
+    }
+
+    void Put32(QByteArray &data, quint32 value)
+    {
+        if (m_bigEndian)
+        {
+            Put16(data, value >> 16);
+            Put16(data, value);
+        }
+        else
+        {
+            Put16(data, value);
+            Put16(data, value >> 16);
+        }
+    }
+
+    void Entry(QByteArray &data, quint16 tag, quint16 type, quint32 count,
+               quint32 value)
+    {
+        Put16(data, tag);
+        Put16(data, type);
+        Put32(data, count);
+
+        // Short values are left-justified
+        if (type == 3)
+        {
+            Put16(data, value);
+            Put16(data, 0);
+        }
+        else
+            Put32(data, value);
+    }
+
+    /// Builds TIFF data holding IFD0 (orientation, date) and an Exif IFD
+    /// (comment). The date must be 20 bytes.
+    QByteArray Tiff(int orientation, const QByteArray &date,
+                    const QByteArray &comment)
+    {
+        QByteArray data(m_bigEndian ? "MM\0*" : "II*\0", 4);
+        Put32(data, 8);
+
+        // IFD0 at 8
+        Put16(data, 3);
+        Entry(data, 0x0112, 3, 1, orientation);
+        Entry(data, 0x0132, 2, date.size(), 50);
+        Entry(data, 0x8769, 4, 1, 70);
+        Put32(data, 0);
+        data += date;
+
+        // Exif IFD at 70
+        Put16(data, 1);
+        Entry(data, 0x9286, 7, comment.size(), 88);
+        Put32(data, 0);
+        data += comment;
+
+        return data;
+    }
+
+    void Write(const QByteArray &data)
+    {
+        QFile file(m_path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(data);
+    }
+
+    /// Writes a JPEG header, with a JFIF segment before any Exif
+    void WriteJpeg(const QByteArray &tiff)
+    {
+        QByteArray data("\xFF\xD8", 2);
+        data += QByteArray("\xFF\xE0\x00\x10" "JFIF\0\x01\x01\0\0\x01\0\x01\0\0",
+                           18);
+        if (!tiff.isEmpty())
+        {
+            data += QByteArray("\xFF\xE1", 2);
+            int size = 2 + 6 + tiff.size();
+            data.append(char(size >> 8)).append(char(size));
+            data += QByteArray("Exif\0\0", 6);
+            data += tiff;
+        }
+        data += QByteArray("\xFF\xDA\x00\x04\x01\x02\xFF\xD9", 8);
+        Write(data);
+    }
+
+  private slots:
+    void init(void)
+    {
+        m_path = QDir::tempPath() + QString("/test_imagemetadata.%1")
+            .arg(QCoreApplication::applicationPid());
+        m_bigEndian = true;
+    }
+
+    void cleanup(void)
+    {
+        QFile::remove(m_path);
+    }
+
+    void ReadsBigEndianJpeg(void)
+    {
+        WriteJpeg(Tiff(6, QByteArray("2015:06:01 12:34:56", 20),
+                       QByteArray("ASCII\0\0\0Holiday \0", 17)));
+
+        ImageMetaData *metadata = ImageMetaData::FromPictureHeader(m_path);
+        bool exists = false;
+
+        QVERIFY(metadata->IsValid());
+        QCOMPARE(metadata->GetOrientation(&exists), 6);
+        QVERIFY(exists);
+        QCOMPARE(metadata->GetOriginalDateTime(&exists),
+                 QDateTime(QDate(2015, 6, 1), QTime(12, 34, 56)));
+        QVERIFY(exists);
+        QCOMPARE(metadata->GetComment(&exists), QString("Holiday"));
+        QVERIFY(exists);
+
+        delete metadata;
+    }
+
+    void ReadsLittleEndianJpeg(void)
+    {
+        m_bigEndian = false;
+        WriteJpeg(Tiff(3, QByteArray("2001:02:03 04:05:06", 20),
+                       QByteArray("UNICODE\0H\0i\0", 12)));
+
+        ImageMetaData *metadata = ImageMetaData::FromPictureHeader(m_path);
+
+        QCOMPARE(metadata->GetOrientation(), 3);
+        QCOMPARE(metadata->GetOriginalDateTime(),
+                 QDateTime(QDate(2001, 2, 3), QTime(4, 5, 6)));
+        QCOMPARE(metadata->GetComment(), QString("Hi"));
+
+        delete metadata;
+    }
+
+    void ReadsTiff(void)
+    {
+        Write(Tiff(8, QByteArray("2010:10:10 10:10:10", 20),
+                   QByteArray("ASCII\0\0\0Tiff", 12)));
+
+        ImageMetaData *metadata = ImageMetaData::FromPictureHeader(m_path);
+
+        QCOMPARE(metadata->GetOrientation(), 8);
+        QCOMPARE(metadata->GetComment(), QString("Tiff"));
+
+        delete metadata;
+    }
+
+    void JpegWithoutExifHasNoTags(void)
+    {
+        WriteJpeg(QByteArray());
+
+        ImageMetaData *metadata = ImageMetaData::FromPictureHeader(m_path);
+        bool exists = true;
+
+        QVERIFY(metadata->IsValid());
+        QCOMPARE(metadata->GetOrientation(&exists), 0);
+        QVERIFY(!exists);
+        QVERIFY(!metadata->GetOriginalDateTime(&exists).isValid());
+        QVERIFY(!exists);
+        QVERIFY(metadata->GetComment(&exists).isEmpty());
+        QVERIFY(!exists);
+
+        delete metadata;
+    }
+};
@@ -0,0 +1,4 @@
+
+#include "test_videodirindex.h"
+
+QTEST_APPLESS_MAIN(TestVideoDirIndex)
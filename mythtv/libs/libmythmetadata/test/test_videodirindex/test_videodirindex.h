@@ -0,0 +1,208 @@
+/*
+ *  Class TestVideoDirIndex
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <sys/types.h>
+#include <utime.h>
+
+#include <QtTest/QtTest>
+#include <QDir>
+
+#include "videodirindex.h"
+
+class TestVideoDirIndex: public QObject
+{
+    Q_OBJECT
+
+  private:
+    QString m_root;
+    time_t  m_mtime;
+
+    void AddFile(const QString &path)
+    {
+        QFile file(m_root + "/" + path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    /// Backdates a directory, the index doesn't trust recent changes
+    void Age(const QString &path)
+    {
+        struct utimbuf times;
+        times.actime = times.modtime = m_mtime++;
+        QCOMPARE(utime(QString(m_root + "/" + path).toLocal8Bit().constData(),
+                       &times), 0);
+    }
+
+    static void RemoveTree(const QString &path)
+    {
+        QDir d(path);
+        QFileInfoList list =
+            d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+
+        for (QFileInfoList::const_iterator p = list.begin();
+             p != list.end(); ++p)
+        {
+            if (p->isDir())
+                RemoveTree(p->absoluteFilePath());
+            else
+                d.remove(p->fileName());
+        }
+
+        d.rmdir(path);
+    }
+
+  private slots:
+    void init(void)
+    {
+        m_root = QDir::tempPath() + QString("/test_videodirindex.%1")
+            .arg(QCoreApplication::applicationPid());
+        m_mtime = 1000000000;
+
+        RemoveTree(m_root);
+        QVERIFY(QDir().mkpath(m_root + "/movies/dvd/VIDEO_TS"));
+        AddFile("movies/a.mkv");
+        AddFile("movies/Thumbs.db");
+        Age("movies/dvd");
+        Age("movies");
+        Age("");
+    }
+
+    void cleanup(void)
+    {
+        RemoveTree(m_root);
+    }
+
+    void ListsDirectory(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(dirs, QStringList("dvd"));
+        QCOMPARE(files, QStringList("a.mkv"));
+
+        QVERIFY(!index.List(m_root + "/missing", dirs, files));
+    }
+
+    void UnchangedDirectoryIsNotRead(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 1);
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 0);
+        QCOMPARE(files, QStringList("a.mkv"));
+    }
+
+    void ChangedDirectoryIsRead(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+
+        AddFile("movies/b.mkv");
+        Age("movies");
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 1);
+        QCOMPARE(files, QStringList() << "a.mkv" << "b.mkv");
+    }
+
+    void RecentChangeIsReadAgain(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        AddFile("movies/b.mkv");
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 2);
+    }
+
+    void DirtyDirectoryIsRead(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        index.MarkDirty(m_root + "/movies");
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 1);
+    }
+
+    void SurvivesSaveAndLoad(void)
+    {
+        QStringList dirs, files;
+
+        {
+            VideoDirIndex index(m_root + "/cache/index");
+            QVERIFY(index.List(m_root + "/movies", dirs, files));
+            QVERIFY(index.Save());
+        }
+
+        VideoDirIndex index(m_root + "/cache/index");
+        QVERIFY(index.Load());
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QCOMPARE(index.GetReadCount(), 0);
+        QCOMPARE(dirs, QStringList("dvd"));
+        QCOMPARE(files, QStringList("a.mkv"));
+    }
+
+    void DamagedFileIsIgnored(void)
+    {
+        QFile file(m_root + "/index");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not an index");
+        file.close();
+
+        VideoDirIndex index(m_root + "/index");
+        QVERIFY(!index.Load());
+        QVERIFY(index.GetDirs().isEmpty());
+    }
+
+    void EndScanForgetsUnseenDirectories(void)
+    {
+        VideoDirIndex index(m_root + "/index");
+        QStringList   dirs, files;
+
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        QVERIFY(index.List(m_root + "/movies/dvd", dirs, files));
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        index.EndScan(QStringList("/elsewhere"));
+        QCOMPARE(index.GetDirs().size(), 2);
+
+        index.BeginScan();
+        QVERIFY(index.List(m_root + "/movies", dirs, files));
+        index.EndScan(QStringList(m_root + "/movies"));
+        QCOMPARE(index.GetDirs(), QStringList(m_root + "/movies"));
+    }
+};
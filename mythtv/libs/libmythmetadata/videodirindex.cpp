@@ -0,0 +1,314 @@
+// POSIX headers
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Qt headers
+#include <QMutexLocker>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+// MythTV headers
+#include "videodirindex.h"
+#include "mythlogging.h"
+#include "mythdirs.h"
+
+#define LOC QString("VideoDirIndex: ")
+
+static const quint32 kMagic   = 0x4d564449; // "MVDI"
+static const quint32 kVersion = 1;
+
+/// A directory changed this recently may change again without its
+/// modification time moving on, so it is read again next time.
+static const qint64 kSettleTime = 2000;
+
+static QMutex         s_singletonLock;
+static VideoDirIndex *s_singleton = NULL;
+
+VideoDirIndex *VideoDirIndex::GetSingleton(void)
+{
+    QMutexLocker locker(&s_singletonLock);
+
+    if (!s_singleton)
+    {
+        s_singleton = new VideoDirIndex(GetConfDir() + "/cache/videodirindex");
+        s_singleton->Load();
+    }
+
+    return s_singleton;
+}
+
+VideoDirIndex::VideoDirIndex(const QString &filename) :
+    m_filename(filename), m_readCount(0)
+{
+}
+
+bool VideoDirIndex::Load(void)
+{
+    QFile file(m_filename);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32     magic   = 0;
+    quint32     version = 0;
+    qint32      count   = 0;
+
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Ignoring %1, wrong version")
+            .arg(m_filename));
+        return false;
+    }
+
+    in >> count;
+
+    QHash<QString, Entry> entries;
+
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        Entry   entry;
+
+        in >> path >> entry.mtime >> entry.inode >> entry.dirs >> entry.files;
+        entries.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Ignoring %1, it is damaged")
+            .arg(m_filename));
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_entries = entries;
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC + QString("Loaded %1 directories")
+        .arg(m_entries.size()));
+
+    return true;
+}
+
+bool VideoDirIndex::Save(void)
+{
+    QString tmpname = m_filename + ".tmp";
+
+    QDir().mkpath(QFileInfo(m_filename).absolutePath());
+
+    QFile file(tmpname);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to write %1")
+            .arg(tmpname));
+        return false;
+    }
+
+    {
+        QDataStream out(&file);
+        QMutexLocker locker(&m_lock);
+
+        out << kMagic << kVersion << qint32(m_entries.size());
+
+        QHash<QString, Entry>::const_iterator it = m_entries.begin();
+        for (; it != m_entries.end(); ++it)
+            out << it.key() << it->mtime << it->inode << it->dirs << it->files;
+
+        if (out.status() != QDataStream::Ok)
+        {
+            file.remove();
+            return false;
+        }
+    }
+
+    file.close();
+
+    // Replace the old index in one step, so a crash leaves one or the other
+    QFile::remove(m_filename);
+    return QFile::rename(tmpname, m_filename);
+}
+
+void VideoDirIndex::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_entries.clear();
+}
+
+/** \fn VideoDirIndex::List(const QString&,QStringList&,QStringList&)
+ *  \brief Returns the names of the subdirectories and files in path.
+ *
+ *  The directory is only read if it changed since it was last listed.
+ *  Hidden entries and Thumbs.db are left out, as the scanner always has.
+ *
+ *  \return false if the directory can't be read.
+ */
+bool VideoDirIndex::List(const QString &path, QStringList &dirs,
+                         QStringList &files)
+{
+    qint64  mtime = 0;
+    quint64 inode = 0;
+
+    if (!Stat(path, mtime, inode))
+    {
+        QMutexLocker locker(&m_lock);
+        m_entries.remove(path);
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_seen.insert(path);
+
+        QHash<QString, Entry>::const_iterator it = m_entries.find(path);
+        if (it != m_entries.end() && it->mtime != 0 &&
+            it->mtime == mtime && it->inode == inode)
+        {
+            dirs  = it->dirs;
+            files = it->files;
+            return true;
+        }
+    }
+
+    // Stat before reading, if it changes meanwhile we'll see a newer mtime
+    // next time round.
+    Entry entry;
+
+    if (!Read(path, entry))
+    {
+        QMutexLocker locker(&m_lock);
+        m_entries.remove(path);
+        return false;
+    }
+
+    if (QDateTime::currentMSecsSinceEpoch() - mtime >= kSettleTime)
+        entry.mtime = mtime;
+    entry.inode = inode;
+
+    dirs  = entry.dirs;
+    files = entry.files;
+
+    QMutexLocker locker(&m_lock);
+    m_entries[path] = entry;
+    ++m_readCount;
+
+    return true;
+}
+
+void VideoDirIndex::BeginScan(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_seen.clear();
+    m_readCount = 0;
+}
+
+/** \fn VideoDirIndex::EndScan(const QStringList&)
+ *  \brief Forgets directories under roots that weren't listed this scan.
+ *
+ *  Directories outside the roots belong to other scans and are kept.
+ */
+void VideoDirIndex::EndScan(const QStringList &roots)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+        bool scanned = false;
+
+        QStringList::const_iterator rit = roots.begin();
+        for (; rit != roots.end() && !scanned; ++rit)
+        {
+            scanned = (it.key() == *rit ||
+                       it.key().startsWith(*rit + "/"));
+        }
+
+        if (scanned && !m_seen.contains(it.key()))
+            it = m_entries.erase(it);
+        else
+            ++it;
+    }
+
+    m_seen.clear();
+}
+
+QStringList VideoDirIndex::GetDirs(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_entries.keys();
+}
+
+/// Makes the next List() of path read the directory again.
+void VideoDirIndex::MarkDirty(const QString &path)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, Entry>::iterator it = m_entries.find(path);
+    if (it != m_entries.end())
+        it->mtime = 0;
+}
+
+/// Returns how many directories had to be read since BeginScan().
+int VideoDirIndex::GetReadCount(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_readCount;
+}
+
+bool VideoDirIndex::Stat(const QString &path, qint64 &mtime, quint64 &inode)
+{
+#ifdef _WIN32
+    QFileInfo fi(path);
+
+    if (!fi.isDir())
+        return false;
+
+    mtime = fi.lastModified().toMSecsSinceEpoch();
+    inode = 0;
+#else
+    struct stat st;
+
+    if (stat(path.toLocal8Bit().constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    mtime = qint64(st.st_mtime) * 1000;
+#if defined(__APPLE__)
+    mtime += st.st_mtimespec.tv_nsec / 1000000;
+#elif defined(__linux__)
+    mtime += st.st_mtim.tv_nsec / 1000000;
+#endif
+
+    // A directory replaced by another one may well have the same mtime
+    inode = st.st_ino;
+#endif
+
+    return true;
+}
+
+bool VideoDirIndex::Read(const QString &path, Entry &entry)
+{
+    QDir d(path);
+
+    if (!d.exists())
+        return false;
+
+    d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    QFileInfoList list = d.entryInfoList();
+
+    for (QFileInfoList::const_iterator p = list.begin(); p != list.end(); ++p)
+    {
+        if (p->fileName() == "Thumbs.db")
+            continue;
+
+        if (p->isDir())
+            entry.dirs.push_back(p->fileName());
+        else
+            entry.files.push_back(p->fileName());
+    }
+
+    return true;
+}
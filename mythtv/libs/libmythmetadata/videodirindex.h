@@ -0,0 +1,70 @@
+#ifndef VIDEODIRINDEX_H_
+#define VIDEODIRINDEX_H_
+
+#include <QStringList>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+
+#include "mythmetaexp.h"
+
+/** \class VideoDirIndex
+ *  \brief What the video scanner last found in each local directory.
+ *
+ *  A directory's modification time changes whenever an entry is added to,
+ *  removed from or renamed in it, so while it is unchanged the names found
+ *  there last time are still right and the directory need not be read
+ *  again.  A scan of an unchanged tree then costs one stat() per directory
+ *  rather than reading every one of them.
+ *
+ *  Changes seen some other way, e.g. by a QFileSystemWatcher, are passed
+ *  on with MarkDirty() and make the directory be read regardless.
+ *
+ *  The index is kept in a file between runs, if that can't be read the
+ *  next scan is simply a full one.
+ */
+class META_PUBLIC VideoDirIndex
+{
+  public:
+    static VideoDirIndex *GetSingleton(void);
+
+    explicit VideoDirIndex(const QString &filename);
+
+    bool Load(void);
+    bool Save(void);
+    void Clear(void);
+
+    bool List(const QString &path, QStringList &dirs, QStringList &files);
+
+    void BeginScan(void);
+    void EndScan(const QStringList &roots);
+
+    QStringList GetDirs(void);
+    void        MarkDirty(const QString &path);
+
+    int GetReadCount(void);
+
+  private:
+    class Entry
+    {
+      public:
+        Entry() : mtime(0), inode(0) {}
+
+        qint64      mtime;   ///< msecs since the epoch, 0 to force a read
+        quint64     inode;
+        QStringList dirs;
+        QStringList files;
+    };
+
+    static bool Stat(const QString &path, qint64 &mtime, quint64 &inode);
+    static bool Read(const QString &path, Entry &entry);
+
+    QString               m_filename;
+    QMutex                m_lock;
+    QHash<QString, Entry> m_entries;
+    QSet<QString>         m_seen;      ///< listed during this scan
+    int                   m_readCount; ///< read during this scan
+};
+
+#endif // VIDEODIRINDEX_H_
@@ -1,9 +1,13 @@
 
 #include "videoscan.h"
 
+#include <QFileSystemWatcher>
 #include <QImageReader>
 #include <QApplication>
+#include <QMutex>
+#include <QSet>
 #include <QUrl>
+#include <QDir>
 
 // libmythbase
 #include "mythevent.h"
@@ -26,6 +30,10 @@
 #include "globals.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "videodirindex.h"
+
+/// Stay well clear of the default per user inotify limit of 8192
+static const int kMaxWatches = 4096;
 
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
@@ -85,7 +93,7 @@ class MythUIProgressDialog;
 
 VideoScannerThread::VideoScannerThread(QObject *parent) :
     MThread("VideoScanner"),
-    m_RemoveAll(false), m_KeepAll(false), m_dialog(NULL),
+    m_RemoveAll(false), m_KeepAll(false), m_fullScan(false), m_dialog(NULL),
     m_DBDataChanged(false)
 {
     m_parent = parent;
@@ -171,10 +179,21 @@ void VideoScannerThread::run()
         imageExtensions.push_back(QString(*p));
     }
 
-    LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
+    VideoDirIndex *index = VideoDirIndex::GetSingleton();
+
+    if (m_fullScan)
+    {
+        LOG(VB_GENERAL, LOG_INFO, QString("Beginning full Video Scan."));
+        index->Clear();
+    }
+    else
+        LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
+
+    index->BeginScan();
 
     uint counter = 0;
     FileCheckList fs_files;
+    QStringList localDirs;
 
     if (m_HasGUI)
         SendProgressEvent(counter, (uint)m_directories.size(),
@@ -196,10 +215,18 @@ void VideoScannerThread::run()
                     QString("Failed to scan :%1:").arg(*iter));
             }
         }
+        if (!iter->startsWith("myth://"))
+            localDirs << QDir(*iter).absolutePath();
         if (m_HasGUI)
             SendProgressEvent(++counter);
     }
 
+    LOG(VB_GENERAL, LOG_INFO, QString("Read %1 changed video directories.")
+        .arg(index->GetReadCount()));
+
+    index->EndScan(localDirs);
+    index->Save();
+
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_DBDataChanged = updateDB(fs_files, db_remove);
@@ -405,7 +432,8 @@ bool VideoScannerThread::buildFileList(const QString &directory,
     FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown,
+                              VideoDirIndex::GetSingleton());
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
@@ -422,6 +450,10 @@ void VideoScannerThread::SendProgressEvent(uint progress, uint total,
 VideoScanner::VideoScanner() : m_cancel(false)
 {
     m_scanThread = new VideoScannerThread(this);
+
+    // The watcher outlives this scanner, which is deleted once it is done
+    connect(m_scanThread->qthread(), SIGNAL(finished()),
+            VideoDirWatcher::GetSingleton(), SLOT(updateWatches()));
 }
 
 VideoScanner::~VideoScanner()
@@ -430,7 +462,13 @@ VideoScanner::~VideoScanner()
         delete m_scanThread;
 }
 
-void VideoScanner::doScan(const QStringList &dirs)
+/** \fn VideoScanner::doScan(const QStringList&,bool)
+ *  \brief Scans dirs for added and removed videos.
+ *
+ *  Only directories that changed since the last scan are read, unless
+ *  fullScan is set, which starts again from scratch.
+ */
+void VideoScanner::doScan(const QStringList &dirs, bool fullScan)
 {
     if (m_scanThread->isRunning())
         return;
@@ -467,6 +505,7 @@ void VideoScanner::doScan(const QStringList &dirs)
     }
     m_scanThread->SetHosts(hosts);
     m_scanThread->SetDirs(dirs);
+    m_scanThread->SetFullScan(fullScan);
     m_scanThread->start();
 }
 
@@ -491,4 +530,62 @@ void VideoScanner::finishedScan()
     emit finished(m_scanThread->getDataChanged());
 }
 
+static QMutex           s_watcherLock;
+static VideoDirWatcher *s_watcher = NULL;
+
+VideoDirWatcher *VideoDirWatcher::GetSingleton(void)
+{
+    QMutexLocker locker(&s_watcherLock);
+
+    if (!s_watcher)
+    {
+        s_watcher = new VideoDirWatcher();
+        s_watcher->moveToThread(QCoreApplication::instance()->thread());
+    }
+
+    return s_watcher;
+}
+
+VideoDirWatcher::VideoDirWatcher()
+{
+    // Changes the directory mtime doesn't show, e.g. a file replaced within
+    // the same second, make the next scan read the directory anyway.
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, SIGNAL(directoryChanged(const QString&)),
+            SLOT(directoryChanged(const QString&)));
+}
+
+void VideoDirWatcher::updateWatches(void)
+{
+    QSet<QString> dirs = VideoDirIndex::GetSingleton()->GetDirs().toSet();
+
+    QStringList gone;
+    QStringList watched = m_watcher->directories();
+    for (QStringList::const_iterator it = watched.begin();
+         it != watched.end(); ++it)
+    {
+        if (!dirs.remove(*it))
+            gone << *it;
+    }
+
+    if (!gone.isEmpty())
+        m_watcher->removePaths(gone);
+
+    int room = kMaxWatches - (watched.size() - gone.size());
+    if (room <= 0 || dirs.isEmpty())
+        return;
+
+    QStringList added;
+    QSet<QString>::const_iterator it = dirs.begin();
+    for (; it != dirs.end() && added.size() < room; ++it)
+        added << *it;
+
+    m_watcher->addPaths(added);
+}
+
+void VideoDirWatcher::directoryChanged(const QString &path)
+{
+    VideoDirIndex::GetSingleton()->MarkDirty(path);
+}
+
 ////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@
 #include "mythprogressdialog.h"
 
 class VideoMetadataListManager;
+class QFileSystemWatcher;
 
 class META_PUBLIC VideoScanner : public QObject
 {
@@ -24,7 +25,7 @@ class META_PUBLIC VideoScanner : public QObject
     VideoScanner();
     ~VideoScanner();
 
-    void doScan(const QStringList &dirs);
+    void doScan(const QStringList &dirs, bool fullScan = false);
     void doScanAll(void);
 
   signals:
@@ -38,6 +39,31 @@ class META_PUBLIC VideoScanner : public QObject
     bool                      m_cancel;
 };
 
+/** \class VideoDirWatcher
+ *  \brief Watches the directories in the VideoDirIndex for changes.
+ *
+ *  It lives as long as the application, rather than as long as any one
+ *  VideoScanner, so that changes made between scans are seen.
+ */
+class META_PUBLIC VideoDirWatcher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static VideoDirWatcher *GetSingleton(void);
+
+  public slots:
+    void updateWatches(void);
+
+  private slots:
+    void directoryChanged(const QString &path);
+
+  private:
+    VideoDirWatcher();
+
+    QFileSystemWatcher *m_watcher;
+};
+
 class META_PUBLIC VideoScanChanges : public QEvent
 {
   public:
@@ -65,6 +91,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     void run();
     void SetDirs(QStringList dirs);
     void SetHosts(const QStringList &hosts);
+    void SetFullScan(bool fullScan) { m_fullScan = fullScan; };
     void SetProgressDialog(MythUIProgressDialog *dialog) { m_dialog = dialog; };
     QStringList GetOfflineSGHosts(void) { return m_offlineSGHosts; };
     bool getDataChanged() { return m_DBDataChanged; };
@@ -99,6 +126,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     bool m_RemoveAll;
     bool m_KeepAll;
     bool m_HasGUI;
+    bool m_fullScan;
     QStringList m_directories;
     QStringList m_liveSGHosts;
     QStringList m_offlineSGHosts;
@@ -13,6 +13,7 @@
 
 #include "threadedfilewriter.h"
 #include "fileringbuffer.h"
+#include "filereadcache.h"
 #include "mythcontext.h"
 #include "remotefile.h"
 #include "mythconfig.h" // gives us HAVE_POSIX_FADVISE
@@ -96,6 +97,15 @@ FileRingBuffer::~FileRingBuffer()
     delete tfw;
     tfw = NULL;
 
+    CloseFile();
+}
+
+/// Closes the local file, if any, and leaves the shared read cache.
+void FileRingBuffer::CloseFile(void)
+{
+    FileReadCache::GetSingleton()->RemoveReader(readcachekey);
+    readcachekey.clear();
+
     if (fd2 >= 0)
     {
         close(fd2);
@@ -196,11 +206,7 @@ bool FileRingBuffer::OpenFile(const QString &lfilename, uint retry_ms)
         remotefile = NULL;
     }
 
-    if (fd2 >= 0)
-    {
-        close(fd2);
-        fd2 = -1;
-    }
+    CloseFile();
 
     bool is_local =
         (!filename.startsWith("/dev")) &&
@@ -288,6 +294,9 @@ bool FileRingBuffer::OpenFile(const QString &lfilename, uint retry_ms)
         {
             case 0:
             {
+                readcachekey =
+                    FileReadCache::GetSingleton()->AddReader(filename, fd2);
+
                 QFileInfo fi(filename);
                 oldfile = QDateTime(fi.lastModified().toUTC())
                     .secsTo(MythDate::current()) > 60;
@@ -501,7 +510,26 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
         {
             LOG(VB_FILE, LOG_DEBUG, LOC +
                 QString("read(%1) -- begin").arg(toread));
-            ret = read(fd2, (char *)data + tot, toread);
+            if (FileReadCache::GetSingleton()->IsShared(readcachekey))
+            {
+                // Someone else is streaming this file as well, share the
+                // read-ahead with them. The cache doesn't move our file
+                // position, so read from wherever it is (ReadDirect() in
+                // ignorereadpos mode doesn't keep internalreadpos) and
+                // catch it up afterwards.
+                long long pos = lseek64(fd2, 0, SEEK_CUR);
+                if (pos < 0)
+                    ret = -1;
+                else
+                {
+                    ret = FileReadCache::GetSingleton()->Read(
+                        readcachekey, fd2, pos, (char *)data + tot, toread);
+                    if (ret > 0 && lseek64(fd2, pos + ret, SEEK_SET) < 0)
+                        ret = -1;
+                }
+            }
+            else
+                ret = read(fd2, (char *)data + tot, toread);
             LOG(VB_FILE, LOG_DEBUG, LOC +
                 QString("read(%1) -> %2 end").arg(toread).arg(ret));
         }
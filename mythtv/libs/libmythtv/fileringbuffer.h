@@ -39,4 +39,8 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     int safe_read(RemoteFile *rf, void *data, uint sz);
     virtual long long GetRealFileSizeInternal(void) const;
     virtual long long SeekInternal(long long pos, int whence);
+
+    void CloseFile(void);
+
+    QString readcachekey;         // protected by rwlock
 };
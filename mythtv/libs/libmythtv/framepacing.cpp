@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#include "framepacing.h"
+
+/// Frames whose spacing must agree with the model before it is trusted.
+#define LOCK_SAMPLES    64
+/// Weight of each new refresh interval measurement, as 1/N.
+#define REFRESH_WEIGHT  32
+/// Gaps longer than this (usec) are pauses or seeks, not pacing errors.
+#define MAX_INTERVAL    1000000
+
+FramePacing::FramePacing()
+  : m_lastShown(-1), m_frameInterval(0), m_refreshNominal(0),
+    m_lockSamples(0)
+{
+    m_clock.start();
+}
+
+/**
+ * \fn FramePacing::Reset(int, int)
+ *  Discards all samples and restarts the display model from the nominal
+ *  refresh interval. Both intervals are in usec.
+ */
+void FramePacing::Reset(int frame_interval, int refresh_interval)
+{
+    if (refresh_interval <= 0)
+        refresh_interval = frame_interval;
+
+    m_lastShown      = -1;
+    m_frameInterval  = frame_interval;
+    m_refreshNominal = refresh_interval;
+    m_lockSamples    = 0;
+
+    m_refresh.storeRelease(refresh_interval * 16);
+    m_locked.storeRelease(0);
+    m_missed.storeRelease(0);
+    m_written.storeRelease(0);
+    m_writing.storeRelease(0);
+}
+
+void FramePacing::SetFrameInterval(int frame_interval)
+{
+    m_frameInterval = frame_interval;
+}
+
+/**
+ * \fn FramePacing::RecordFrame(int, int, bool)
+ *  Records a frame shown (or dropped) now.
+ *
+ * \param vsync_delay delay returned by VideoSync::WaitForFrame(), in usec
+ * \param av_delay    how far video is ahead of audio, in usec
+ * \param dropped     the frame was not shown
+ */
+void FramePacing::RecordFrame(int vsync_delay, int av_delay, bool dropped)
+{
+    RecordFrameAt(m_clock.nsecsElapsed() / 1000, vsync_delay, av_delay,
+                  dropped);
+}
+
+/**
+ * \fn FramePacing::RecordFrameAt(int64_t, int, int, bool)
+ *  Records a frame shown (or dropped) at a given time in usec. This must
+ *  always be called from the same thread.
+ */
+void FramePacing::RecordFrameAt(int64_t shown, int vsync_delay, int av_delay,
+                                bool dropped)
+{
+    int interval = 0;
+
+    if (!dropped)
+    {
+        int64_t gap = (m_lastShown < 0) ? 0 : shown - m_lastShown;
+        m_lastShown = shown;
+
+        if (gap > 0 && gap < MAX_INTERVAL)
+        {
+            interval = (int)gap;
+
+            // Each gap should be a whole number of refresh periods; if it
+            // is close enough to one, use it to refine the refresh interval.
+            double refresh = m_refresh.loadAcquire() / 16.0;
+            int vblanks = (int)(interval / refresh + 0.5);
+            if (vblanks >= 1)
+            {
+                double sample = (double)interval / vblanks;
+                if (fabs(sample - refresh) < refresh / 8)
+                {
+                    refresh += (sample - refresh) / REFRESH_WEIGHT;
+                    m_refresh.storeRelease((int)(refresh * 16 + 0.5));
+                    if (++m_lockSamples >= LOCK_SAMPLES)
+                        m_locked.storeRelease(1);
+                }
+            }
+
+            // Allow for 3:2 and similar cadences; anything more than half
+            // a refresh beyond the longest legitimate gap is a missed vsync.
+            int cadence = (int)ceil(m_frameInterval / refresh - 0.05);
+            if (interval > (cadence + 0.5) * refresh)
+                m_missed.fetchAndAddOrdered(1);
+        }
+    }
+
+    int written = m_written.loadAcquire();
+    int slot = (uint)written % kRingSize;
+    m_writing.storeRelease(written + 1);
+    m_interval[slot].storeRelease(interval);
+    m_vsyncDelay[slot].storeRelease(vsync_delay);
+    m_avDelay[slot].storeRelease(av_delay);
+    m_dropped[slot].storeRelease(dropped ? 1 : 0);
+    m_written.storeRelease(written + 1);
+}
+
+bool FramePacing::IsLocked(void) const
+{
+    return m_locked.loadAcquire();
+}
+
+/**
+ * \fn FramePacing::PredictedRefreshInterval(void) const
+ *  Returns the measured refresh interval in usec once the model has
+ *  locked, and the nominal one until then.
+ */
+int FramePacing::PredictedRefreshInterval(void) const
+{
+    if (!IsLocked())
+        return m_refreshNominal;
+    return (m_refresh.loadAcquire() + 8) / 16;
+}
+
+static int percentile(const vector<int> &sorted, int pct)
+{
+    if (sorted.empty())
+        return 0;
+    size_t rank = (sorted.size() * pct + 99) / 100;
+    return sorted[max(rank, (size_t)1) - 1];
+}
+
+/**
+ * \fn FramePacing::GetStats(void) const
+ *  Returns statistics over the last kRingSize frames. Times are in usec.
+ *  May be called from any thread.
+ */
+QVariantMap FramePacing::GetStats(void) const
+{
+    struct Sample { int interval, vsync_delay, av_delay, dropped; };
+
+    int end = m_written.loadAcquire();
+    int begin = max(end - kRingSize, 0);
+
+    vector<Sample> samples;
+    samples.reserve(end - begin);
+    for (int i = begin; i < end; i++)
+    {
+        int slot = (uint)i % kRingSize;
+        Sample sample = { m_interval[slot].loadAcquire(),
+                          m_vsyncDelay[slot].loadAcquire(),
+                          m_avDelay[slot].loadAcquire(),
+                          m_dropped[slot].loadAcquire() };
+        samples.push_back(sample);
+    }
+
+    // Skip any slot the writer may have started reusing while we copied,
+    // and everything if the samples were reset meanwhile.
+    int now = m_writing.loadAcquire();
+    int first = (now < end) ? end : max(begin, now - kRingSize);
+
+    vector<int> shown;
+    double sum = 0, sum_sq = 0, av_sum = 0, vsync_sum = 0;
+    int av_max = 0, dropped = 0, frames = 0;
+    for (int i = first; i < end; i++)
+    {
+        const Sample &sample = samples[i - begin];
+        frames++;
+        av_sum += sample.av_delay;
+        av_max = max(av_max, abs(sample.av_delay));
+        vsync_sum += sample.vsync_delay;
+        if (sample.dropped)
+        {
+            dropped++;
+            continue;
+        }
+        if (sample.interval <= 0)
+            continue;
+        shown.push_back(sample.interval);
+        sum += sample.interval;
+        sum_sq += (double)sample.interval * sample.interval;
+    }
+    sort(shown.begin(), shown.end());
+
+    double mean = shown.empty() ? 0 : sum / shown.size();
+    double var = (shown.size() < 2) ? 0 :
+        (sum_sq - sum * mean) / (shown.size() - 1);
+
+    QVariantMap stats;
+    stats.insert("frames",          frames);
+    stats.insert("dropped",         dropped);
+    stats.insert("missedvsyncs",    MissedVSyncs());
+    stats.insert("intervalmean",    mean);
+    stats.insert("intervalp50",     percentile(shown, 50));
+    stats.insert("intervalp95",     percentile(shown, 95));
+    stats.insert("intervalp99",     percentile(shown, 99));
+    stats.insert("intervalmax",     shown.empty() ? 0 : shown.back());
+    stats.insert("jitter",          sqrt(max(var, 0.0)));
+    stats.insert("vsyncdelay",      frames ? vsync_sum / frames : 0.0);
+    stats.insert("avdrift",         frames ? av_sum / frames : 0.0);
+    stats.insert("avdriftmax",      av_max);
+    stats.insert("refreshmeasured", m_refresh.loadAcquire() / 16.0);
+    stats.insert("refreshlocked",   IsLocked());
+    return stats;
+}
+
+/**
+ * \fn FramePacing::GetSummary(void) const
+ *  Returns a one line summary for the playback data OSD.
+ */
+QString FramePacing::GetSummary(void) const
+{
+    QVariantMap stats = GetStats();
+    return QString("%1/%2/%3 ms, %4 missed, A/V %5 ms")
+        .arg(stats["intervalp50"].toInt() / 1000.0, 0, 'f', 2)
+        .arg(stats["intervalp95"].toInt() / 1000.0, 0, 'f', 2)
+        .arg(stats["intervalp99"].toInt() / 1000.0, 0, 'f', 2)
+        .arg(stats["missedvsyncs"].toUInt())
+        .arg(stats["avdrift"].toDouble() / 1000.0, 0, 'f', 1);
+}
@@ -0,0 +1,68 @@
+#ifndef FRAMEPACING_H
+#define FRAMEPACING_H
+
+#include <stdint.h>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVariantMap>
+
+#include "mythtvexp.h"
+
+/** \class FramePacing
+ *  \brief Records how each frame was presented and derives pacing statistics.
+ *
+ *  MythPlayer::AVSync() calls RecordFrame() once for every frame it shows
+ *  or drops. The samples are kept in a fixed size ring which is only
+ *  written by the output thread but may be read by any thread without
+ *  locking, see GetStats().
+ *
+ *  From the spacing of the shown frames it also measures the display's
+ *  refresh interval. Once the measurement has locked,
+ *  PredictedRefreshInterval() can be used in place of the nominal rate
+ *  reported by the display.
+ */
+class MTV_PUBLIC FramePacing
+{
+  public:
+    FramePacing();
+
+    void    Reset(int frame_interval, int refresh_interval);
+    void    SetFrameInterval(int frame_interval);
+
+    void    RecordFrame(int vsync_delay, int av_delay, bool dropped);
+    void    RecordFrameAt(int64_t shown, int vsync_delay, int av_delay,
+                          bool dropped);
+
+    bool    IsLocked(void) const;
+    int     PredictedRefreshInterval(void) const;
+    uint    MissedVSyncs(void) const { return m_missed.loadAcquire(); }
+
+    QVariantMap GetStats(void) const;
+    QString     GetSummary(void) const;
+
+    /// Number of frames the statistics are calculated over.
+    static const int kRingSize = 512;
+
+  private:
+    QElapsedTimer m_clock;
+
+    // Written by the output thread only
+    int64_t    m_lastShown;
+    int        m_frameInterval;
+    int        m_refreshNominal;
+    int        m_lockSamples;
+
+    // Readable from any thread
+    QAtomicInt m_written;     ///< samples completely written
+    QAtomicInt m_writing;     ///< samples written or being written
+    QAtomicInt m_missed;
+    QAtomicInt m_refresh;     ///< measured refresh interval, usec * 16
+    QAtomicInt m_locked;
+    QAtomicInt m_interval[kRingSize];   ///< usec since last shown frame
+    QAtomicInt m_vsyncDelay[kRingSize]; ///< usec, as returned by WaitForFrame
+    QAtomicInt m_avDelay[kRingSize];    ///< usec, video minus audio
+    QAtomicInt m_dropped[kRingSize];
+};
+
+#endif // FRAMEPACING_H
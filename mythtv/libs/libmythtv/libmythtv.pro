@@ -132,6 +132,7 @@ HEADERS += signalmonitorvalue.h     signalmonitorlistener.h
 HEADERS += livetvchain.h            playgroup.h
 HEADERS += channelsettings.h
 HEADERS += previewgenerator.h       previewgeneratorqueue.h
+HEADERS += previewcache.h
 HEADERS += transporteditor.h        listingsources.h
 HEADERS += channelgroup.h
 HEADERS += recordingrule.h
@@ -162,6 +163,7 @@ SOURCES += signalmonitorvalue.cpp
 SOURCES += livetvchain.cpp          playgroup.cpp
 SOURCES += channelsettings.cpp
 SOURCES += previewgenerator.cpp     previewgeneratorqueue.cpp
+SOURCES += previewcache.cpp
 SOURCES += transporteditor.cpp
 SOURCES += channelgroup.cpp
 SOURCES += recordingrule.cpp
@@ -402,6 +404,7 @@ using_frontend {
     HEADERS += videooutbase.h           videoout_null.h
     HEADERS += videobuffers.h           vsync.h
     HEADERS += jitterometer.h           yuv2rgb.h
+    HEADERS += framepacing.h
     HEADERS += videodisplayprofile.h    mythcodecid.h
     HEADERS += videoouttypes.h          util-osd.h
     HEADERS += videooutwindow.h         videocolourspace.h
@@ -410,6 +413,7 @@ using_frontend {
     SOURCES += videooutbase.cpp         videoout_null.cpp
     SOURCES += videobuffers.cpp         vsync.cpp
     SOURCES += jitterometer.cpp         yuv2rgb.cpp
+    SOURCES += framepacing.cpp
     SOURCES += videodisplayprofile.cpp  mythcodecid.cpp
     SOURCES += videooutwindow.cpp       util-osd.cpp
     SOURCES += videocolourspace.cpp
@@ -32,8 +32,22 @@
 
 extern "C" {
 #include "libavcodec/avcodec.h"
+#include "libavutil/cpu.h"
 }
 
+#if ARCH_X86 && HAVE_AVX2 && defined(__GNUC__)
+#define MYTH_AVX2 1
+#include <immintrin.h>
+// Built with the function target attribute so the rest of the file doesn't
+// require -mavx2; only ever called after a runtime check.
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if (ARCH_ARM || ARCH_AARCH64) && HAVE_NEON && HAVE_INTRINSICS_NEON
+#define MYTH_NEON 1
+#include <arm_neon.h>
+#endif
+
 #ifndef __MAX
 #   define __MAX(a, b)   ( ((a) > (b)) ? (a) : (b) )
 #endif
@@ -43,102 +57,35 @@ extern "C" {
 
 #if ARCH_X86
 
-static int has_sse2     = -1;
-static int has_sse3     = -1;
-static int has_ssse3    = -1;
-static int has_sse4     = -1;
-
-#if defined _WIN32 && !defined __MINGW32__
-//  Windows
-#define cpuid    __cpuid
-
-#else
-inline void cpuid(int CPUInfo[4],int InfoType)
-{
-    __asm__ __volatile__ (
-    // pic requires to save ebx/rbx
-#if ARCH_X86_32
-    "push       %%ebx\n"
-#endif
-    "cpuid\n"
-    "movl %%ebx ,%[ebx]\n"
-#if ARCH_X86_32
-    "pop        %%ebx\n"
-#endif
-    :"=a" (CPUInfo[0]),
-    [ebx] "=r"(CPUInfo[1]),
-    "=c" (CPUInfo[2]),
-    "=d" (CPUInfo[3])
-    :"a" (InfoType)
-    );
-}
-#endif
-
+// Use FFmpeg's CPU detection: it checks for OS support of the extended
+// registers and honours av_force_cpu_flags(), which lets tests exercise
+// every code path.
 static inline bool sse2_check()
 {
-    if (has_sse2 != -1)
-    {
-        return has_sse2;
-    }
-
-    int info[4];
-    cpuid(info, 0);
-    int nIds = info[0];
-
-    //  Detect Features
-    if (nIds >= 0x00000001)
-    {
-        cpuid(info,0x00000001);
-        has_sse2  = (info[3] & ((int)1 << 26)) != 0;
-        has_sse3  = (info[2] & ((int)1 <<  0)) != 0;
-        has_ssse3 = (info[2] & ((int)1 <<  9)) != 0;
-        has_sse4  = (info[2] & ((int)1 << 19)) != 0;
-    }
-    else
-    {
-        has_sse2  = 0;
-        has_sse3  = 0;
-        has_ssse3 = 0;
-        has_sse4  = 0;
-    }
-    return has_sse2;
+    return av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
 }
 
 static inline bool sse3_check()
 {
-    if (has_sse3 != -1)
-    {
-        return has_sse3;
-    }
-
-    sse2_check();
-
-    return has_sse3;
+    return av_get_cpu_flags() & AV_CPU_FLAG_SSE3;
 }
 
 static inline bool ssse3_check()
 {
-    if (has_ssse3 != -1)
-    {
-        return has_ssse3;
-    }
-
-    sse2_check();
-
-    return has_ssse3;
+    return av_get_cpu_flags() & AV_CPU_FLAG_SSSE3;
 }
 
 static inline bool sse4_check()
 {
-    if (has_sse4 != -1)
-    {
-        return has_sse4;
-    }
-
-    sse2_check();
+    return av_get_cpu_flags() & AV_CPU_FLAG_SSE4;
+}
 
-    return has_sse4;
+#ifdef MYTH_AVX2
+static inline bool avx2_check()
+{
+    return av_get_cpu_flags() & AV_CPU_FLAG_AVX2;
 }
+#endif
 
 static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
                                    uint8_t* dstv, int dstv_pitch,
@@ -284,8 +231,187 @@ static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
 #undef LOAD64U
 #undef LOAD64A
 }
+
+#ifdef MYTH_AVX2
+AVX2_TARGET
+static void AVX2_copyplane(uint8_t* dst, int dst_pitch,
+                           const uint8_t* src, int src_pitch,
+                           int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+
+        for (; x < (width & ~127); x += 128)
+        {
+            const __m256i *s = (const __m256i*)&src[x];
+            __m256i *d = (__m256i*)&dst[x];
+            __m256i a = _mm256_loadu_si256(s + 0);
+            __m256i b = _mm256_loadu_si256(s + 1);
+            __m256i c = _mm256_loadu_si256(s + 2);
+            __m256i e = _mm256_loadu_si256(s + 3);
+            _mm256_storeu_si256(d + 0, a);
+            _mm256_storeu_si256(d + 1, b);
+            _mm256_storeu_si256(d + 2, c);
+            _mm256_storeu_si256(d + 3, e);
+        }
+        for (; x < (width & ~31); x += 32)
+        {
+            _mm256_storeu_si256((__m256i*)&dst[x],
+                                _mm256_loadu_si256((const __m256i*)&src[x]));
+        }
+        if (x < width)
+        {
+            memcpy(&dst[x], &src[x], width - x);
+        }
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+/*
+ * Deinterleave 32 UV pairs per iteration: pshufb gathers U and V into the
+ * two halves of each 128 bits lane, then the lanes are recombined across
+ * the two source registers.
+ */
+AVX2_TARGET
+static void AVX2_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height)
+{
+    const __m256i shuffle =
+        _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                         0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+
+        for (; x < (width & ~31); x += 32)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)&src[2*x]);
+            __m256i b = _mm256_loadu_si256((const __m256i*)&src[2*x+32]);
+            // [U0-7 V0-7 | U8-15 V8-15] -> [U0-15 | V0-15]
+            a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuffle),
+                                         _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuffle),
+                                         _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)&dstu[x],
+                                _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256((__m256i*)&dstv[x],
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+
+        for (; x < width; x++)
+        {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+AVX2_TARGET
+static void AVX2_interleaveplanes(uint8_t* dst, int dst_pitch,
+                                  const uint8_t* srcu, int srcu_pitch,
+                                  const uint8_t* srcv, int srcv_pitch,
+                                  int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+
+        for (; x < (width & ~31); x += 32)
+        {
+            __m256i u  = _mm256_loadu_si256((const __m256i*)&srcu[x]);
+            __m256i v  = _mm256_loadu_si256((const __m256i*)&srcv[x]);
+            // unpack works per 128 bits lane: lo = [0-7 | 16-23], hi = [8-15 | 24-31]
+            __m256i lo = _mm256_unpacklo_epi8(u, v);
+            __m256i hi = _mm256_unpackhi_epi8(u, v);
+            _mm256_storeu_si256((__m256i*)&dst[2*x],
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i*)&dst[2*x+32],
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+
+        for (; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+#endif // MYTH_AVX2
 #endif /* ARCH_X86 */
 
+#ifdef MYTH_NEON
+static inline bool neon_check()
+{
+    return av_get_cpu_flags() & AV_CPU_FLAG_NEON;
+}
+
+static void NEON_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+
+        for (; x < (width & ~15); x += 16)
+        {
+            uint8x16x2_t uv = vld2q_u8(&src[2*x]);
+            vst1q_u8(&dstu[x], uv.val[0]);
+            vst1q_u8(&dstv[x], uv.val[1]);
+        }
+
+        for (; x < width; x++)
+        {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void NEON_interleaveplanes(uint8_t* dst, int dst_pitch,
+                                  const uint8_t* srcu, int srcu_pitch,
+                                  const uint8_t* srcv, int srcv_pitch,
+                                  int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+
+        for (; x < (width & ~15); x += 16)
+        {
+            uint8x16x2_t uv;
+            uv.val[0] = vld1q_u8(&srcu[x]);
+            uv.val[1] = vld1q_u8(&srcv[x]);
+            vst2q_u8(&dst[2*x], uv);
+        }
+
+        for (; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+#endif // MYTH_NEON
+
 static inline void copyplane(uint8_t* dst, int dst_pitch,
                              const uint8_t* src, int src_pitch,
                              int width, int height)
@@ -316,11 +442,116 @@ static void splitplanes(uint8_t* dstu, int dstu_pitch,
     }
 }
 
+static void interleaveplanes(uint8_t* dst, int dst_pitch,
+                             const uint8_t* srcu, int srcu_pitch,
+                             const uint8_t* srcv, int srcv_pitch,
+                             int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+/*
+ * Runtime dispatchers: pick the widest implementation the CPU supports,
+ * falling back to plain C when simd is false.
+ */
+static void simd_copyplane(uint8_t* dst, int dst_pitch,
+                           const uint8_t* src, int src_pitch,
+                           int width, int height, bool simd)
+{
+#ifdef MYTH_AVX2
+    if (simd && avx2_check())
+    {
+        AVX2_copyplane(dst, dst_pitch, src, src_pitch, width, height);
+        return;
+    }
+#else
+    (void)simd;
+#endif
+    // libc memcpy is already vectorised for the remaining architectures
+    copyplane(dst, dst_pitch, src, src_pitch, width, height);
+}
+
+static void simd_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height, bool simd)
+{
+    if (simd)
+    {
+#ifdef MYTH_AVX2
+        if (avx2_check())
+        {
+            AVX2_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                             src, src_pitch, width, height);
+            return;
+        }
+#endif
+#if ARCH_X86
+        if (sse2_check())
+        {
+            SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                            src, src_pitch, width, height);
+            asm volatile ("emms");
+            return;
+        }
+#endif
+#ifdef MYTH_NEON
+        if (neon_check())
+        {
+            NEON_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                             src, src_pitch, width, height);
+            return;
+        }
+#endif
+    }
+    splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                src, src_pitch, width, height);
+}
+
+static void simd_interleaveplanes(uint8_t* dst, int dst_pitch,
+                                  const uint8_t* srcu, int srcu_pitch,
+                                  const uint8_t* srcv, int srcv_pitch,
+                                  int width, int height, bool simd)
+{
+    if (simd)
+    {
+#ifdef MYTH_AVX2
+        if (avx2_check())
+        {
+            AVX2_interleaveplanes(dst, dst_pitch, srcu, srcu_pitch,
+                                  srcv, srcv_pitch, width, height);
+            return;
+        }
+#endif
+#ifdef MYTH_NEON
+        if (neon_check())
+        {
+            NEON_interleaveplanes(dst, dst_pitch, srcu, srcu_pitch,
+                                  srcv, srcv_pitch, width, height);
+            return;
+        }
+#endif
+    }
+    interleaveplanes(dst, dst_pitch, srcu, srcu_pitch,
+                     srcv, srcv_pitch, width, height);
+}
+
 void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
 {
     VideoFrameType codec = dst->codec;
     if (!(dst->codec == src->codec ||
-          (src->codec == FMT_NV12 && dst->codec == FMT_YV12)))
+          (src->codec == FMT_NV12 && dst->codec == FMT_YV12) ||
+          (src->codec == FMT_YV12 && dst->codec == FMT_NV12)))
         return;
 
     dst->interlaced_frame = src->interlaced_frame;
@@ -337,24 +568,13 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
         if (src->codec == FMT_NV12 &&
             height == dheight && width == dwidth)
         {
-            copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                      src->buf + src->offsets[0], src->pitches[0],
-                      width, height);
-#if ARCH_X86
-            if (useSSE && sse2_check())
-            {
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
-                asm volatile ("emms");
-                return;
-            }
-#endif
-            splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                        dst->buf + dst->offsets[2], dst->pitches[2],
-                        src->buf + src->offsets[1], src->pitches[1],
-                        (width+1) / 2, (height+1) / 2);
+            simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                           src->buf + src->offsets[0], src->pitches[0],
+                           width, height, useSSE);
+            simd_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                             dst->buf + dst->offsets[2], dst->pitches[2],
+                             src->buf + src->offsets[1], src->pitches[1],
+                             (width+1) / 2, (height+1) / 2, useSSE);
             return;
         }
 
@@ -366,15 +586,15 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
             // drop the garbage data
             height = (dst->height < src->height) ? dst->height : src->height;
             width = (dst->width < src->width) ? dst->width : src->width;
-            copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                      src->buf + src->offsets[0], src->pitches[0],
-                      width, height);
-            copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
-                      src->buf + src->offsets[1], src->pitches[1],
-                      (width+1) / 2, (height+1) / 2);
-            copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
-                      src->buf + src->offsets[2], src->pitches[2],
-                      (width+1) / 2, (height+1) / 2);
+            simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                           src->buf + src->offsets[0], src->pitches[0],
+                           width, height, useSSE);
+            simd_copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
+                           src->buf + src->offsets[1], src->pitches[1],
+                           (width+1) / 2, (height+1) / 2, useSSE);
+            simd_copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
+                           src->buf + src->offsets[2], src->pitches[2],
+                           (width+1) / 2, (height+1) / 2, useSSE);
             return;
         }
 
@@ -395,6 +615,28 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
         memcpy(dst->buf + dst->offsets[2],
                src->buf + src->offsets[2], pitch2 * height2);
     }
+    else if (FMT_NV12 == codec)
+    {
+        int height = (dst->height < src->height) ? dst->height : src->height;
+        int width  = (dst->width < src->width) ? dst->width : src->width;
+
+        simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                       src->buf + src->offsets[0], src->pitches[0],
+                       width, height, useSSE);
+
+        if (src->codec == FMT_YV12)
+        {
+            simd_interleaveplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                                  src->buf + src->offsets[1], src->pitches[1],
+                                  src->buf + src->offsets[2], src->pitches[2],
+                                  (width+1) / 2, (height+1) / 2, useSSE);
+            return;
+        }
+
+        simd_copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
+                       src->buf + src->offsets[1], src->pitches[1],
+                       ((width+1) / 2) * 2, (height+1) / 2, useSSE);
+    }
 }
 
 /***************************************
@@ -566,8 +808,8 @@ static void SSE_splitplanes(uint8_t *dstu, int dstu_pitch,
                      2*width, hblock);
 
         /* Copy from our cache to the destination */
-        SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
-                        cache, w16, width, hblock);
+        simd_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                         cache, w16, width, hblock, true);
 
         /* */
         src  += src_pitch  * hblock;
@@ -643,13 +885,13 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
                     // if shorter, use it in the future
                     long duration = timer->nsecsElapsed();
                     timer->restart();
-                    copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                              src->buf + src->offsets[0], src->pitches[0],
-                              width, height);
-                    SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                    dst->buf + dst->offsets[2], dst->pitches[2],
-                                    src->buf + src->offsets[1], src->pitches[1],
-                                    (width+1) / 2, (height+1) / 2);
+                    simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                                   src->buf + src->offsets[0], src->pitches[0],
+                                   width, height, true);
+                    simd_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                                     dst->buf + dst->offsets[2], dst->pitches[2],
+                                     src->buf + src->offsets[1], src->pitches[1],
+                                     (width+1) / 2, (height+1) / 2, true);
                     m_uswc = timer->nsecsElapsed() < duration;
                     if (m_uswc == 0)
                     {
@@ -660,25 +902,25 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
             }
             else
             {
-                copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                          src->buf + src->offsets[0], src->pitches[0],
-                          width, height);
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
+                simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                               src->buf + src->offsets[0], src->pitches[0],
+                               width, height, true);
+                simd_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                                 dst->buf + dst->offsets[2], dst->pitches[2],
+                                 src->buf + src->offsets[1], src->pitches[1],
+                                 (width+1) / 2, (height+1) / 2, true);
             }
             asm volatile ("emms");
             return;
         }
 #endif
-        copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                  src->buf + src->offsets[0], src->pitches[0],
-                  width, height);
-        splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                    dst->buf + dst->offsets[2], dst->pitches[2],
-                    src->buf + src->offsets[1], src->pitches[1],
-                    (width+1) / 2, (height+1) / 2);
+        simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                       src->buf + src->offsets[0], src->pitches[0],
+                       width, height, true);
+        simd_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                         dst->buf + dst->offsets[2], dst->pitches[2],
+                         src->buf + src->offsets[1], src->pitches[1],
+                         (width+1) / 2, (height+1) / 2, true);
         return;
     }
 
@@ -709,15 +951,15 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
             // if shorter, use it in the future
             long duration = timer->nsecsElapsed();
             timer->restart();
-            copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                      src->buf + src->offsets[0], src->pitches[0],
-                      width, height);
-            copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
-                      src->buf + src->offsets[1], src->pitches[1],
-                      (width+1) / 2, (height+1) / 2);
-            copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
-                      src->buf + src->offsets[2], src->pitches[2],
-                      (width+1) / 2, (height+1) / 2);
+            simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                           src->buf + src->offsets[0], src->pitches[0],
+                           width, height, true);
+            simd_copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
+                           src->buf + src->offsets[1], src->pitches[1],
+                           (width+1) / 2, (height+1) / 2, true);
+            simd_copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
+                           src->buf + src->offsets[2], src->pitches[2],
+                           (width+1) / 2, (height+1) / 2, true);
             m_uswc = timer->nsecsElapsed() < duration;
             if (m_uswc == 0)
             {
@@ -729,15 +971,15 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
         return;
     }
 #endif
-    copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-              src->buf + src->offsets[0], src->pitches[0],
-              width, height);
-    copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
-              src->buf + src->offsets[1], src->pitches[1],
-              (width+1) / 2, (height+1) / 2);
-    copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
-              src->buf + src->offsets[2], src->pitches[2],
-              (width+1) / 2, (height+1) / 2);
+    simd_copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                   src->buf + src->offsets[0], src->pitches[0],
+                   width, height, true);
+    simd_copyplane(dst->buf + dst->offsets[1], dst->pitches[1],
+                   src->buf + src->offsets[1], src->pitches[1],
+                   (width+1) / 2, (height+1) / 2, true);
+    simd_copyplane(dst->buf + dst->offsets[2], dst->pitches[2],
+                   src->buf + src->offsets[2], src->pitches[2],
+                   (width+1) / 2, (height+1) / 2, true);
 }
 
 /**
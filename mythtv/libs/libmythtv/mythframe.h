@@ -245,7 +245,7 @@ static inline bool compatible(const VideoFrame *a, const VideoFrame *b)
  * copy: copy one frame into another
  * copy only works with the following assumptions:
  * frames are of the same resolution
- * destination frame is in YV12 format
+ * destination frame is in YV12 or NV12 format
  * source frame is either YV12 or NV12 format
  */
 static inline void copy(VideoFrame *dst, const VideoFrame *src)
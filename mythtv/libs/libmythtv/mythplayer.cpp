@@ -1777,6 +1777,7 @@ void MythPlayer::SetFrameInterval(FrameScanType scan, double frame_period)
     if (!avsync_predictor_enabled)
         avsync_predictor = 0;
     avsync_predictor_enabled = false;
+    output_pacing.SetFrameInterval(frame_interval);
 
     LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("SetFrameInterval ps:%1 scan:%2")
             .arg(play_speed).arg(scan));
@@ -1806,6 +1807,7 @@ void MythPlayer::InitAVSync(void)
     repeat_delay = 0;
 
     refreshrate = MythDisplay::GetDisplayInfo(frame_interval).Rate();
+    output_pacing.Reset(frame_interval, refreshrate);
 
     // Number of frames over which to average time divergence
     avsync_averaging=4;
@@ -1902,11 +1904,15 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
 
     if (avsync_predictor_enabled)
     {
+        // The nominal refresh rate is often slightly off, which makes
+        // the predictor drop frames at the wrong moments, so use the
+        // rate measured from the shown frames once it is known.
+        int refresh = output_pacing.PredictedRefreshInterval();
         avsync_predictor += frame_interval;
-        if (avsync_predictor >= refreshrate)
+        if (avsync_predictor >= refresh)
         {
-            int refreshperiodsinframe = avsync_predictor/refreshrate;
-            avsync_predictor -= refreshrate * refreshperiodsinframe;
+            int refreshperiodsinframe = avsync_predictor/refresh;
+            avsync_predictor -= refresh * refreshperiodsinframe;
         }
         else
         {
@@ -2024,11 +2030,15 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
         //currentaudiotime = AVSyncGetAudiotime();
     }
 
+    // avsync_delay is the last measured one, this frame's is below
+    output_pacing.RecordFrame(vsync_delay_clock, avsync_delay, dropframe);
+
     if (output_jmeter && output_jmeter->RecordCycleTime())
     {
         LOG(VB_PLAYBACK | VB_TIMESTAMP, LOG_INFO, LOC +
-            QString("A/V avsync_delay: %1, avsync_avg: %2")
-                .arg(avsync_delay / 1000).arg(avsync_avg / 1000));
+            QString("A/V avsync_delay: %1, avsync_avg: %2, pacing: %3")
+                .arg(avsync_delay / 1000).arg(avsync_avg / 1000)
+                .arg(output_pacing.GetSummary()));
     }
 
     avsync_adjustment = 0;
@@ -4935,6 +4945,7 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
             .arg(output_jmeter->GetLastSD(), 0, 'f', 2);
         infoMap["load"] = output_jmeter->GetLastCPUStats();
     }
+    infoMap["framepacing"] = output_pacing.GetSummary();
     GetCodecDescription(infoMap);
 }
 
@@ -26,6 +26,7 @@
 #include "commbreakmap.h"
 #include "audioplayer.h"
 #include "audiooutputgraph.h"
+#include "framepacing.h"
 #include "mthread.h"                    // for MThread
 #include "mythavutil.h"                 // for VideoFrame
 #include "mythtypes.h"                  // for InfoMap
@@ -173,6 +174,8 @@ class MTV_PUBLIC MythPlayer
     float   GetVideoAspect(void) const        { return video_aspect; }
     float   GetFrameRate(void) const          { return video_frame_rate; }
     void    GetPlaybackData(InfoMap &infoMap);
+    QVariantMap GetFramePacingStats(void) const
+        { return output_pacing.GetStats(); }
     bool    IsAudioNeeded(void)
         { return !(FlagIsSet(kVideoIsNull)) && player_ctx->IsAudioNeeded(); }
     uint    GetVolume(void) { return audio.GetVolume(); }
@@ -831,6 +834,7 @@ class MTV_PUBLIC MythPlayer
     int        avsync_averaging; // Number of frames to average
     int        avsync_interval;  // Number of frames skip between sync checks
     int        avsync_next;      // Frames till next sync check
+    FramePacing output_pacing;   ///< presentation statistics, vblank model
 
     // Time Code stuff
     int        prevtc;        ///< 32 bit timecode if last VideoFrame shown
@@ -0,0 +1,205 @@
+// POSIX headers
+#include <sys/types.h> // for utime
+#include <utime.h>     // for utime
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QMultiMap>
+#include <QMutex>
+#include <QTemporaryFile>
+
+// MythTV headers
+#include "previewcache.h"
+#include "programinfo.h"
+#include "mythcorecontext.h"
+#include "mythmiscutil.h"
+#include "mythlogging.h"
+#include "mythdirs.h"
+#include "mythdate.h"
+
+#define LOC QString("PreviewCache: ")
+
+/// Minimum time between two prunes of the cache, in seconds
+#define PRUNE_INTERVAL 300
+
+static QMutex    s_pruneLock;
+static QDateTime s_lastPrune;
+
+QString PreviewCache::GetCacheDir(void)
+{
+    return GetConfDir() + "/cache/previews";
+}
+
+/**
+ *  \brief Returns the cache key for a preview.
+ *
+ *  \param pginfo     Recording the preview is of.
+ *  \param filename   Local path of the recording, used to detect changes.
+ *  \param time       Capture position, or -1 for the default position.
+ *  \param in_seconds true if time is in seconds, false for frames.
+ *  \param size       Image size, 0 for the size of the video.
+ *  \param format     Image format, e.g. "png".
+ */
+QString PreviewCache::GetKey(const ProgramInfo &pginfo,
+                             const QString &filename,
+                             long long time, bool in_seconds,
+                             const QSize &size, const QString &format)
+{
+    QFileInfo fi(filename);
+    QString id = QString("%1|%2|%3|%4|%5|%6%7|%8x%9|")
+        .arg(pginfo.GetRecordingID())
+        .arg(pginfo.GetChanID())
+        .arg(pginfo.GetRecordingStartTime(MythDate::ISODate))
+        .arg(fi.size())
+        .arg(fi.lastModified().toTime_t())
+        .arg(time).arg(in_seconds ? "s" : "f")
+        .arg(size.width()).arg(size.height());
+    id += format.toLower();
+
+    // The default position follows the bookmark
+    if (time < 0)
+        id += "|" + pginfo.GetBookmarkUpdate().toString(Qt::ISODate);
+
+    return QCryptographicHash::hash(id.toUtf8(),
+                                    QCryptographicHash::Sha1).toHex();
+}
+
+/**
+ *  \brief Returns where the entry for key is, or will be, stored.
+ *         Creates the directory it goes into.
+ */
+QString PreviewCache::GetPath(const QString &key, const QString &format)
+{
+    QString dirname = GetCacheDir() + "/" + key.left(2);
+    QDir dir(dirname);
+    if (!dir.exists() && !dir.mkpath(dirname))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to create '%1'").arg(dirname));
+    }
+
+    return QString("%1/%2.%3").arg(dirname).arg(key).arg(format.toLower());
+}
+
+/**
+ *  \brief Returns the path of a cached preview, or an empty string if
+ *         there is none. Marks the entry as recently used.
+ *
+ *  \param source Image the entry was made from, if any. The entry is
+ *                treated as missing if the source has changed since.
+ */
+QString PreviewCache::Find(const QString &key, const QString &format,
+                           const QString &source)
+{
+    QString path = GetPath(key, format);
+    QFileInfo fi(path);
+    if (!fi.isReadable())
+        return QString();
+
+    // Must be checked before the touch below moves our time forward
+    if (!source.isEmpty() &&
+        QFileInfo(source).lastModified() > fi.lastModified())
+        return QString();
+
+    // Pruning goes by modification time
+    utime(path.toLocal8Bit().constData(), NULL);
+
+    return path;
+}
+
+/**
+ *  \brief Saves an image under key and returns its path, or an empty
+ *         string on failure.
+ */
+QString PreviewCache::Store(const QString &key, const QString &format,
+                            const QImage &image)
+{
+    QString path = GetPath(key, format);
+
+    // Write to a temporary file first so a reader never sees a partial
+    // image.
+    QTemporaryFile f(path + ".XXXXXX");
+    f.setAutoRemove(false);
+    if (!f.open() || !image.save(&f, format.toUpper().toLocal8Bit()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to save '%1'")
+            .arg(path));
+        f.remove();
+        return QString();
+    }
+    f.close();
+
+    if (!makeFileAccessible(f.fileName().toLocal8Bit().constData()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Unable to change permissions on "
+                                 "preview image. Backends and frontends "
+                                 "running under different users will be "
+                                 "unable to access it");
+    }
+
+    QFile::remove(path);
+    if (!f.rename(path))
+    {
+        f.remove();
+        return QString();
+    }
+
+    Prune((qint64)gCoreContext->GetNumSetting("PreviewCacheSize", 512) << 20);
+
+    return path;
+}
+
+/**
+ *  \brief Deletes the least recently used entries until the cache takes
+ *         no more than max_bytes. Does nothing if it ran recently.
+ */
+void PreviewCache::Prune(qint64 max_bytes)
+{
+    QMutexLocker locker(&s_pruneLock);
+
+    QDateTime now = MythDate::current();
+    if (s_lastPrune.isValid() && s_lastPrune.secsTo(now) < PRUNE_INTERVAL)
+        return;
+    s_lastPrune = now;
+
+    QFileInfoList files;
+    QDir top(GetCacheDir());
+    QFileInfoList dirs = top.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < dirs.size(); i++)
+    {
+        QDir dir(dirs[i].absoluteFilePath());
+        files += dir.entryInfoList(QDir::Files, QDir::Time);
+    }
+
+    qint64 total = 0;
+    for (int i = 0; i < files.size(); i++)
+        total += files[i].size();
+
+    if (total <= max_bytes)
+        return;
+
+    // Oldest first
+    QMultiMap<QDateTime, int> byage;
+    for (int i = 0; i < files.size(); i++)
+        byage.insert(files[i].lastModified(), i);
+
+    uint removed = 0;
+    QMultiMap<QDateTime, int>::const_iterator it = byage.begin();
+    for (; it != byage.end() && total > max_bytes; ++it)
+    {
+        const QFileInfo &fi = files[*it];
+        if (QFile::remove(fi.absoluteFilePath()))
+        {
+            total -= fi.size();
+            removed++;
+        }
+    }
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Pruned %1 previews, %2 MB remain")
+            .arg(removed).arg(total >> 20));
+}
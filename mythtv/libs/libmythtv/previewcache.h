@@ -0,0 +1,40 @@
+// -*- Mode: c++ -*-
+#ifndef PREVIEW_CACHE_H_
+#define PREVIEW_CACHE_H_
+
+#include <QString>
+#include <QSize>
+
+#include "mythtvexp.h"
+
+class ProgramInfo;
+class QImage;
+
+/** \class PreviewCache
+ *  \brief On disk cache for preview images other than a recording's
+ *         default preview.
+ *
+ *   Entries are named after a hash of everything that determines the
+ *   image: the recording, the size and modification time of its file, the
+ *   capture position, the image size and the format. A changed recording
+ *   simply gets new names, so entries are never invalidated, only pruned
+ *   once the cache grows beyond the PreviewCacheSize setting.
+ */
+class MTV_PUBLIC PreviewCache
+{
+  public:
+    static QString GetKey(const ProgramInfo &pginfo, const QString &filename,
+                          long long time, bool in_seconds,
+                          const QSize &size, const QString &format);
+    static QString GetPath(const QString &key, const QString &format);
+    static QString Find(const QString &key, const QString &format,
+                        const QString &source = QString());
+    static QString Store(const QString &key, const QString &format,
+                         const QImage &image);
+    static void    Prune(qint64 max_bytes);
+
+  private:
+    static QString GetCacheDir(void);
+};
+
+#endif // PREVIEW_CACHE_H_
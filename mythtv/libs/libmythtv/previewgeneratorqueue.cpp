@@ -49,11 +49,11 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     m_running(0), m_maxThreads(2),
     m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds)
 {
-    if (PreviewGenerator::kLocal & mode)
-    {
-        int idealThreads = QThread::idealThreadCount();
-        m_maxThreads = (idealThreads >= 1) ? idealThreads * 2 : 2;
-    }
+    // Remote generators mostly wait on the backend, which has its own
+    // limit, so there is no reason to allow fewer of them than local ones.
+    // With only two a fresh frontend fetched its previews nearly serially.
+    int idealThreads = QThread::idealThreadCount();
+    m_maxThreads = (idealThreads >= 1) ? max(idealThreads * 2, 4) : 4;
 
     moveToThread(qthread());
     start();
@@ -463,7 +463,7 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
 {
     QMutexLocker locker(&m_lock);
     QStringList &q = m_queue;
-    if (!q.empty() && (m_running < m_maxThreads))
+    while (!q.empty() && (m_running < m_maxThreads))
     {
         QString fn = q.back();
         q.pop_back();
@@ -23,6 +23,7 @@ using namespace std;
 #include "mythsystemevent.h"
 #include "mythlogging.h"
 #include "programinfo.h"
+#include "mythdbcon.h"
 #include "asichannel.h"
 #include "dtvchannel.h"
 #include "dvbchannel.h"
@@ -483,6 +484,8 @@ void RecorderBase::FinishRecording(void)
             LOG(VB_GENERAL, LOG_CRIT, "RecordingFile object is NULL. No video file metadata can be stored");
 
         SavePositionMap(true, true); // Save Position Map only, not file size
+        // The deltas are queued, have them all in the DB before we're done
+        MSqlQuery::FlushQueuedWrites();
 
         if (ringBuffer)
             curRecording->SaveFilesize(ringBuffer->GetRealFileSize());
@@ -24,6 +24,10 @@
 #include "mythframe.h"
 #include "mythavutil.h"
 
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #define MSKIP(MSG) QSKIP(MSG, SkipSingle)
 #else
@@ -38,6 +42,163 @@ class TestCopyFrames: public QObject
 {
     Q_OBJECT
 
+    // One row per SIMD implementation available on this CPU and per
+    // resolution, so that every code path is both verified and timed.
+    static void addSIMDRows(void)
+    {
+        QTest::addColumn<int>("cpuflags");
+        QTest::addColumn<int>("width");
+        QTest::addColumn<int>("height");
+
+        int flags = av_get_cpu_flags();
+        QList<QPair<QString,int> > impls;
+        impls << qMakePair(QString("C"), 0);
+        if (flags & AV_CPU_FLAG_SSE2)
+            impls << qMakePair(QString("SSE"), flags & ~AV_CPU_FLAG_AVX2);
+        if (flags & AV_CPU_FLAG_AVX2)
+            impls << qMakePair(QString("AVX2"), flags);
+        if (flags & AV_CPU_FLAG_NEON)
+            impls << qMakePair(QString("NEON"), flags);
+
+        const int sizes[][2] =
+            { { 720, 576 }, { 1366, 768 }, { 1920, 1080 }, { 3840, 2160 } };
+        for (int i = 0; i < impls.size(); i++)
+        {
+            for (uint j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+            {
+                QString name = QString("%1 %2x%3").arg(impls[i].first)
+                    .arg(sizes[j][0]).arg(sizes[j][1]);
+                QTest::newRow(name.toLatin1().constData())
+                    << impls[i].second << sizes[j][0] << sizes[j][1];
+            }
+        }
+    }
+
+    // Keep the amount of data copied per benchmark roughly constant
+    static int iterations(int width, int height)
+    {
+        return qMax(1, (ITER * WIDTH / width) * HEIGHT / height);
+    }
+
+    // Distinct Y, U and V patterns, so swapped or shifted samples show up
+    static uint8_t lumaval(int i, int j)  { return (i * 7 + j) & 0xff; }
+    static uint8_t uval(int i, int j)     { return (i + j * 3) & 0xff; }
+    static uint8_t vval(int i, int j)     { return (255 - i - j) & 0xff; }
+
+    static void fillframe(VideoFrame *frame)
+    {
+        int cwidth  = (frame->width + 1) / 2;
+        int cheight = (frame->height + 1) / 2;
+
+        for (int i = 0; i < frame->height; i++)
+        {
+            uint8_t *y = frame->buf + frame->offsets[0] + frame->pitches[0] * i;
+            for (int j = 0; j < frame->width; j++)
+                y[j] = lumaval(i, j);
+        }
+        for (int i = 0; i < cheight; i++)
+        {
+            uint8_t *u = frame->buf + frame->offsets[1] + frame->pitches[1] * i;
+            uint8_t *v = frame->buf + frame->offsets[2] + frame->pitches[2] * i;
+            for (int j = 0; j < cwidth; j++)
+            {
+                if (frame->codec == FMT_NV12)
+                {
+                    u[j * 2]     = uval(i, j);
+                    u[j * 2 + 1] = vval(i, j);
+                }
+                else
+                {
+                    u[j] = uval(i, j);
+                    v[j] = vval(i, j);
+                }
+            }
+        }
+    }
+
+    // Returns an empty string if frame holds the pattern set by fillframe()
+    static QString checkframe(const VideoFrame *frame)
+    {
+        int cwidth  = (frame->width + 1) / 2;
+        int cheight = (frame->height + 1) / 2;
+
+        for (int i = 0; i < frame->height; i++)
+        {
+            const uint8_t *y =
+                frame->buf + frame->offsets[0] + frame->pitches[0] * i;
+            for (int j = 0; j < frame->width; j++)
+            {
+                if (y[j] != lumaval(i, j))
+                    return QString("Y mismatch at %1,%2").arg(j).arg(i);
+            }
+        }
+        for (int i = 0; i < cheight; i++)
+        {
+            const uint8_t *u =
+                frame->buf + frame->offsets[1] + frame->pitches[1] * i;
+            const uint8_t *v =
+                frame->buf + frame->offsets[2] + frame->pitches[2] * i;
+            for (int j = 0; j < cwidth; j++)
+            {
+                bool nv12 = frame->codec == FMT_NV12;
+                if ((nv12 ? u[j * 2] : u[j]) != uval(i, j))
+                    return QString("U mismatch at %1,%2").arg(j).arg(i);
+                if ((nv12 ? u[j * 2 + 1] : v[j]) != vval(i, j))
+                    return QString("V mismatch at %1,%2").arg(j).arg(i);
+            }
+        }
+        return QString();
+    }
+
+    // Convert between the given formats with the selected CPU features
+    static void runSIMDcopy(VideoFrameType srctype, VideoFrameType dsttype,
+                            bool uswc = false)
+    {
+        QFETCH(int, cpuflags);
+        QFETCH(int, width);
+        QFETCH(int, height);
+        VideoFrame src, dst;
+
+        av_force_cpu_flags(cpuflags);
+
+        int sizesrc = buffersize(srctype, width, height, 64);
+        unsigned char* bufsrc = (unsigned char*)av_malloc(sizesrc);
+        init(&src, srctype, bufsrc, width, height, sizesrc,
+             NULL, NULL, 0, 0, 64);
+        fillframe(&src);
+
+        // unaligned destination stride for planar output
+        int aligndst = dsttype == FMT_YV12 ? 0 : 16;
+        int sizedst = buffersize(dsttype, width, height, aligndst);
+        unsigned char* bufdst = (unsigned char*)av_malloc(sizedst);
+        init(&dst, dsttype, bufdst, width, height, sizedst,
+             NULL, NULL, 0, 0, aligndst);
+        memset(bufdst, 0, sizedst);
+
+        MythUSWCCopy mythcopy(width);
+        mythcopy.setUSWC(true);
+        int iter = iterations(width, height);
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < iter; i++)
+            {
+                if (uswc)
+                    mythcopy.copy(&dst, &src);
+                else
+                    framecopy(&dst, &src, true);
+            }
+        }
+
+        QString error = checkframe(&dst);
+
+        av_freep(&bufsrc);
+        av_freep(&bufdst);
+        av_force_cpu_flags(-1);
+
+        QVERIFY2(error.isEmpty(), error.toLatin1().constData());
+    }
+
   private slots:
     // called at the beginning of these sets of tests
     void initTestCase(void)
@@ -1267,4 +1428,48 @@ class TestCopyFrames: public QObject
         av_freep(&bufsrc);
         av_freep(&bufdst);
     }
+
+    void NV12toYV12SIMD_data(void)
+    {
+        addSIMDRows();
+    }
+
+    // NV12 -> YV12, every SIMD implementation available
+    void NV12toYV12SIMD(void)
+    {
+        runSIMDcopy(FMT_NV12, FMT_YV12);
+    }
+
+    void NV12toYV12USWCSIMD_data(void)
+    {
+        addSIMDRows();
+    }
+
+    // NV12 -> YV12 through the USWC cache
+    void NV12toYV12USWCSIMD(void)
+    {
+        runSIMDcopy(FMT_NV12, FMT_YV12, true);
+    }
+
+    void YV12toNV12SIMD_data(void)
+    {
+        addSIMDRows();
+    }
+
+    // YV12 -> NV12, every SIMD implementation available
+    void YV12toNV12SIMD(void)
+    {
+        runSIMDcopy(FMT_YV12, FMT_NV12);
+    }
+
+    void NV12toNV12SIMD_data(void)
+    {
+        addSIMDRows();
+    }
+
+    // NV12 -> NV12 with different strides
+    void NV12toNV12SIMD(void)
+    {
+        runSIMDcopy(FMT_NV12, FMT_NV12);
+    }
 };
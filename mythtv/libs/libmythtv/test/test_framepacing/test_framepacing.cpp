@@ -0,0 +1,3 @@
+#include "test_framepacing.h"
+
+QTEST_APPLESS_MAIN(TestFramePacing)
@@ -0,0 +1,127 @@
+/*
+ *  Class TestFramePacing
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "framepacing.h"
+
+// 23.976 fps on a 59.94 Hz display, in usec
+#define FILM_INTERVAL    41708
+#define NTSC_REFRESH     16683
+// what the display claims to be
+#define NOMINAL_REFRESH  16667
+
+class TestFramePacing: public QObject
+{
+    Q_OBJECT
+
+  private:
+    /// Shows frames with a 3:2 cadence, returns the time of the last one.
+    static int64_t play_32(FramePacing &pacing, int64_t start, int frames,
+                           int av_delay = 0)
+    {
+        int64_t t = start;
+        for (int i = 0; i < frames; i++)
+        {
+            t += ((i & 1) ? 2 : 3) * NTSC_REFRESH;
+            pacing.RecordFrameAt(t, 500, av_delay, false);
+        }
+        return t;
+    }
+
+  private slots:
+
+    void Cadence32(void)
+    {
+        FramePacing pacing;
+        pacing.Reset(FILM_INTERVAL, NOMINAL_REFRESH);
+        QVERIFY(!pacing.IsLocked());
+        QCOMPARE(pacing.PredictedRefreshInterval(), NOMINAL_REFRESH);
+
+        play_32(pacing, 0, 400);
+
+        // The model locks onto the real refresh rather than the nominal one
+        QVERIFY(pacing.IsLocked());
+        QVERIFY(abs(pacing.PredictedRefreshInterval() - NTSC_REFRESH) <= 2);
+        QCOMPARE(pacing.MissedVSyncs(), 0U);
+
+        QVariantMap stats = pacing.GetStats();
+        QCOMPARE(stats["frames"].toInt(), 400);
+        QCOMPARE(stats["dropped"].toInt(), 0);
+        QCOMPARE(stats["intervalp50"].toInt(), 2 * NTSC_REFRESH);
+        QCOMPARE(stats["intervalp95"].toInt(), 3 * NTSC_REFRESH);
+        QCOMPARE(stats["intervalmax"].toInt(), 3 * NTSC_REFRESH);
+        QVERIFY(stats["jitter"].toDouble() > NTSC_REFRESH / 3);
+    }
+
+    void MissedVSync(void)
+    {
+        FramePacing pacing;
+        pacing.Reset(FILM_INTERVAL, NOMINAL_REFRESH);
+
+        int64_t t = play_32(pacing, 0, 200);
+        // Two frames which each miss a vblank
+        t += 4 * NTSC_REFRESH;
+        pacing.RecordFrameAt(t, -NTSC_REFRESH, 0, false);
+        t = play_32(pacing, t, 20);
+        t += 4 * NTSC_REFRESH;
+        pacing.RecordFrameAt(t, -NTSC_REFRESH, 0, false);
+        // A dropped frame is not shown, so it is no pacing error itself
+        pacing.RecordFrameAt(t + 1000, 0, 0, true);
+        // A pause is not a missed vsync either
+        play_32(pacing, t + 5000000, 20);
+
+        QCOMPARE(pacing.MissedVSyncs(), 2U);
+        QVariantMap stats = pacing.GetStats();
+        QCOMPARE(stats["dropped"].toInt(), 1);
+        QCOMPARE(stats["intervalmax"].toInt(), 4 * NTSC_REFRESH);
+    }
+
+    void Window(void)
+    {
+        FramePacing pacing;
+        pacing.Reset(FILM_INTERVAL, NOMINAL_REFRESH);
+
+        // Old A/V drift falls out of the window
+        int64_t t = play_32(pacing, 0, FramePacing::kRingSize, 40000);
+        play_32(pacing, t, FramePacing::kRingSize, -2000);
+
+        QVariantMap stats = pacing.GetStats();
+        QCOMPARE(stats["frames"].toInt(), (int)FramePacing::kRingSize);
+        QCOMPARE(stats["avdrift"].toDouble(), -2000.0);
+        QCOMPARE(stats["avdriftmax"].toInt(), 2000);
+
+        pacing.Reset(FILM_INTERVAL, NOMINAL_REFRESH);
+        stats = pacing.GetStats();
+        QCOMPARE(stats["frames"].toInt(), 0);
+        QCOMPARE(stats["intervalp99"].toInt(), 0);
+    }
+
+    void RecordFrameBenchmark(void)
+    {
+        FramePacing pacing;
+        pacing.Reset(FILM_INTERVAL, NOMINAL_REFRESH);
+        int64_t t = 0;
+
+        QBENCHMARK
+        {
+            t += NTSC_REFRESH * 2;
+            pacing.RecordFrameAt(t, 0, 0, false);
+        }
+    }
+};
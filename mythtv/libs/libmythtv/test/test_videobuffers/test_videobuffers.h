@@ -0,0 +1,216 @@
+/*
+ *  Class TestVideoBuffers
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <atomic>
+#include <chrono> // for microseconds
+#include <thread> // for thread, sleep_for
+
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+
+#include "videobuffers.h"
+
+#define NUM_DECODE      16
+#define DISPLAY_FPS     120
+#define DISPLAY_FRAMES  (DISPLAY_FPS * 2)
+
+class TestVideoBuffers: public QObject
+{
+    Q_OBJECT
+
+  private:
+    static void init_buffers(VideoBuffers &vbuffers)
+    {
+        // 16 decode frames plus a pause frame, like the software outputs
+        vbuffers.Init(NUM_DECODE, true, 1, 4, 2, 2);
+    }
+
+    static uint total(const VideoBuffers &vbuffers)
+    {
+        return vbuffers.Size(kVideoBuffer_avail) +
+               vbuffers.Size(kVideoBuffer_limbo) +
+               vbuffers.Size(kVideoBuffer_used) +
+               vbuffers.Size(kVideoBuffer_finished) +
+               vbuffers.Size(kVideoBuffer_displayed);
+    }
+
+  private slots:
+
+    void Queues(void)
+    {
+        VideoBuffers vbuffers;
+        init_buffers(vbuffers);
+
+        QCOMPARE(vbuffers.Size(), (uint)NUM_DECODE + 1);
+        QCOMPARE(vbuffers.FreeVideoFrames(), (uint)NUM_DECODE);
+        QCOMPARE(vbuffers.Size(kVideoBuffer_pause), 1U);
+        QVERIFY(vbuffers.Contains(kVideoBuffer_pause, vbuffers.At(NUM_DECODE)));
+
+        VideoFrame *frame = vbuffers.GetNextFreeFrame();
+        QVERIFY(frame);
+        QVERIFY(vbuffers.Contains(kVideoBuffer_limbo, frame));
+        QVERIFY(!vbuffers.Contains(kVideoBuffer_avail, frame));
+        QCOMPARE(vbuffers.FreeVideoFrames(), (uint)NUM_DECODE - 1);
+
+        frame->directrendering = 1;
+        vbuffers.ReleaseFrame(frame);
+        QVERIFY(!vbuffers.Contains(kVideoBuffer_limbo, frame));
+        QVERIFY(vbuffers.Contains(kVideoBuffer_used, frame));
+        QVERIFY(vbuffers.Contains(kVideoBuffer_decode, frame));
+        QCOMPARE(vbuffers.ValidVideoFrames(), 1U);
+        QCOMPARE(vbuffers.GetLastDecodedFrame(), frame);
+
+        // Still referenced by the decoder, so it must wait in finished
+        vbuffers.StartDisplayingFrame();
+        QCOMPARE(vbuffers.GetLastShownFrame(), frame);
+        vbuffers.DoneDisplayingFrame(frame);
+        QVERIFY(vbuffers.Contains(kVideoBuffer_finished, frame));
+        QCOMPARE(vbuffers.ValidVideoFrames(), 0U);
+
+        vbuffers.DeLimboFrame(frame);
+        QVERIFY(!vbuffers.Contains(kVideoBuffer_decode, frame));
+        QCOMPARE(vbuffers.Size(kVideoBuffer_decode), 0U);
+
+        // The next finished frame releases it back to available
+        VideoFrame *next = vbuffers.GetNextFreeFrame();
+        vbuffers.ReleaseFrame(next);
+        vbuffers.StartDisplayingFrame();
+        vbuffers.DoneDisplayingFrame(next);
+        QVERIFY(vbuffers.Contains(kVideoBuffer_avail, frame));
+        QVERIFY(vbuffers.Contains(kVideoBuffer_avail, next));
+        QCOMPARE(vbuffers.FreeVideoFrames(), (uint)NUM_DECODE);
+        QCOMPARE(total(vbuffers), (uint)NUM_DECODE);
+
+        vbuffers.DiscardFrames(true);
+        QCOMPARE(vbuffers.FreeVideoFrames(), (uint)NUM_DECODE);
+
+        vbuffers.Reset();
+        for (uint i = 0; i < kVideoBuffer_queues; i++)
+            QCOMPARE(vbuffers.Size((BufferType)(1 << i)), 0U);
+        QVERIFY(!vbuffers.Contains(kVideoBuffer_avail, frame));
+    }
+
+    /**
+     * A decoder thread filling frames as fast as the free queue allows and
+     * a display thread consuming them at 120 fps, with a third thread
+     * polling the queue state the way the A/V sync code does. Frames must be
+     * shown in decode order and none may be lost.
+     */
+    void DecodeDisplayStress(void)
+    {
+        VideoBuffers vbuffers;
+        init_buffers(vbuffers);
+
+        std::atomic<bool> done(false);
+        std::atomic<int>  decoded(0);
+        std::atomic<long long> polls(0);
+        int  shown = 0;
+        int  out_of_order = 0;
+
+        std::thread decoder([&]()
+        {
+            VideoFrame *held = NULL;
+            for (long long num = 0; !done; num++)
+            {
+                while (!vbuffers.EnoughFreeFrames() && !done)
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                if (done)
+                    break;
+
+                VideoFrame *frame = vbuffers.GetNextFreeFrame();
+                frame->frameNumber = num;
+                // Every other frame stays referenced by the decoder
+                // until the next one, as a reference frame would.
+                frame->directrendering = num & 1;
+                vbuffers.ReleaseFrame(frame);
+                decoded++;
+
+                if (num & 1)
+                {
+                    if (held)
+                        vbuffers.DeLimboFrame(held);
+                    held = frame;
+                }
+            }
+        });
+
+        std::thread poller([&]()
+        {
+            while (!done)
+            {
+                if (vbuffers.EnoughDecodedFrames() ||
+                    vbuffers.Contains(kVideoBuffer_used,
+                                      vbuffers.At(polls % NUM_DECODE)))
+                {
+                    polls++;
+                }
+                polls++;
+            }
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        long long expected = 0;
+        const qint64 interval = 1000000 / DISPLAY_FPS;
+        for (shown = 0; shown < DISPLAY_FRAMES; shown++)
+        {
+            qint64 due = shown * interval;
+            qint64 now = timer.nsecsElapsed() / 1000;
+            if (now < due)
+                std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+
+            while (!vbuffers.ValidVideoFrames())
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+            vbuffers.StartDisplayingFrame();
+            VideoFrame *frame = vbuffers.GetLastShownFrame();
+            if (frame->frameNumber != expected)
+                out_of_order++;
+            expected = frame->frameNumber + 1;
+            vbuffers.DoneDisplayingFrame(frame);
+        }
+
+        done = true;
+        decoder.join();
+        poller.join();
+
+        QCOMPARE(out_of_order, 0);
+        QVERIFY(decoded >= DISPLAY_FRAMES);
+        QCOMPARE(total(vbuffers), (uint)NUM_DECODE);
+        QCOMPARE(vbuffers.Size(kVideoBuffer_pause), 1U);
+    }
+
+    /// One frame through decode, display and back to available
+    void DecodeDisplayCycle(void)
+    {
+        VideoBuffers vbuffers;
+        init_buffers(vbuffers);
+
+        QBENCHMARK
+        {
+            VideoFrame *frame = vbuffers.GetNextFreeFrame();
+            frame->directrendering = 0;
+            vbuffers.ReleaseFrame(frame);
+            vbuffers.StartDisplayingFrame();
+            vbuffers.DoneDisplayingFrame(vbuffers.GetLastShownFrame());
+        }
+
+        QCOMPARE(vbuffers.FreeVideoFrames(), (uint)NUM_DECODE);
+        QCOMPARE(total(vbuffers), (uint)NUM_DECODE);
+    }
+};
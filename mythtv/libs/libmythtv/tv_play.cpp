@@ -1661,6 +1661,7 @@ void TV::GetStatus(void)
 
         status.insert("playspeed", ctx->player->GetPlaySpeed());
         status.insert("audiosyncoffset", (long long)ctx->player->GetAudioTimecodeOffset());
+        status.insert("framepacing", ctx->player->GetFramePacingStats());
         if (ctx->player->GetAudio()->ControlsVolume())
         {
             status.insert("volume", ctx->player->GetVolume());
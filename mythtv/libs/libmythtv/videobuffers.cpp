@@ -21,6 +21,21 @@ extern "C" {
 
 int next_dbg_str = 0;
 
+static inline int queue_index(BufferType type)
+{
+    switch (type)
+    {
+        case kVideoBuffer_avail:     return 0;
+        case kVideoBuffer_limbo:     return 1;
+        case kVideoBuffer_used:      return 2;
+        case kVideoBuffer_pause:     return 3;
+        case kVideoBuffer_displayed: return 4;
+        case kVideoBuffer_finished:  return 5;
+        case kVideoBuffer_decode:    return 6;
+        default:                     return -1;
+    }
+}
+
 YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o,
                  int aligned)
     : width(w), height(h), size(sz)
@@ -131,6 +146,13 @@ YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o,
  *        decoder (in the decode queue) then it is placed in the finished queue
  *        until the decoder is no longer using it (not in the decode queue).
  *
+ *  The queues themselves are only modified with the lock held, and only
+ *  through Push(), Pop(), Erase() and ClearQueue(). These keep an atomic
+ *  length for each queue and a count of how often each frame appears in
+ *  each queue, so Size(), Contains() and the Enough*Frames() checks the
+ *  decoder and display threads poll every frame do not take the lock, and
+ *  membership tests made with the lock held are O(1) rather than a search.
+ *
  * \see VideoOutput
  */
 
@@ -189,7 +211,6 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
         At(i)->codec            = FMT_NONE;
         At(i)->interlaced_frame = -1;
         At(i)->top_field_first  = +1;
-        vbufferMap[At(i)]       = i;
     }
 
     needfreeframes              = need_free;
@@ -222,14 +243,13 @@ void VideoBuffers::Reset()
         av_freep(&it->qscale_table);
     }
 
-    available.clear();
-    used.clear();
-    limbo.clear();
-    finished.clear();
-    decode.clear();
-    pause.clear();
-    displayed.clear();
-    vbufferMap.clear();
+    ClearQueue(kVideoBuffer_avail);
+    ClearQueue(kVideoBuffer_used);
+    ClearQueue(kVideoBuffer_limbo);
+    ClearQueue(kVideoBuffer_finished);
+    ClearQueue(kVideoBuffer_decode);
+    ClearQueue(kVideoBuffer_pause);
+    ClearQueue(kVideoBuffer_displayed);
 }
 
 /**
@@ -251,19 +271,19 @@ VideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType enqueue_to)
     // Try to get a frame not being used by the decoder
     for (uint i = 0; i < available.size(); i++)
     {
-        frame = available.dequeue();
-        if (decode.contains(frame))
-            available.enqueue(frame);
+        frame = Pop(kVideoBuffer_avail);
+        if (InQueue(kVideoBuffer_decode, frame))
+            Push(kVideoBuffer_avail, frame);
         else
             break;
     }
 
-    while (frame && used.contains(frame))
+    while (frame && InQueue(kVideoBuffer_used, frame))
     {
         LOG(VB_PLAYBACK, LOG_NOTICE,
             QString("GetNextFreeFrame() served a busy frame %1. Dropping. %2")
                 .arg(DebugString(frame, true)).arg(GetStatus()));
-        frame = available.dequeue();
+        frame = Pop(kVideoBuffer_avail);
     }
 
     if (frame)
@@ -282,7 +302,11 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(BufferType enqueue_to)
 {
     for (uint tries = 1; true; tries++)
     {
-        VideoFrame *frame = VideoBuffers::GetNextFreeFrameInternal(enqueue_to);
+        // Don't contend with the display thread for the lock while
+        // there is nothing to hand out.
+        VideoFrame *frame = NULL;
+        if (Size(kVideoBuffer_avail))
+            frame = VideoBuffers::GetNextFreeFrameInternal(enqueue_to);
 
         if (frame)
             return frame;
@@ -319,12 +343,12 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
 
-    vpos = vbufferMap[frame];
-    limbo.remove(frame);
+    vpos = max(Index(frame), 0);
+    Erase(kVideoBuffer_limbo, frame);
     //non directrendering frames are ffmpeg handled
     if (frame->directrendering != 0)
-        decode.enqueue(frame);
-    used.enqueue(frame);
+        Push(kVideoBuffer_decode, frame);
+    Push(kVideoBuffer_used, frame);
 }
 
 /**
@@ -335,17 +359,16 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
 void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
-    if (limbo.contains(frame))
-        limbo.remove(frame);
+    Erase(kVideoBuffer_limbo, frame);
 
     // if decoder didn't release frame and the buffer is getting released by
     // the decoder assume that the frame is lost and return to available
-    if (!decode.contains(frame))
+    if (!InQueue(kVideoBuffer_decode, frame))
         SafeEnqueue(kVideoBuffer_avail, frame);
 
     // remove from decode queue since the decoder is finished
-    while (decode.contains(frame))
-        decode.remove(frame);
+    while (InQueue(kVideoBuffer_decode, frame))
+        Erase(kVideoBuffer_decode, frame);
 }
 
 /**
@@ -355,7 +378,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 void VideoBuffers::StartDisplayingFrame(void)
 {
     QMutexLocker locker(&global_lock);
-    rpos = vbufferMap[used.head()];
+    rpos = max(Index(used.head()), 0);
 }
 
 /**
@@ -366,7 +389,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
 {
     QMutexLocker locker(&global_lock);
 
-    if(used.contains(frame))
+    if (InQueue(kVideoBuffer_used, frame))
         Remove(kVideoBuffer_used, frame);
 
     Enqueue(kVideoBuffer_finished, frame);
@@ -376,7 +399,7 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *frame)
     frame_queue_t::iterator it = ula.begin();
     for (; it != ula.end(); ++it)
     {
-        if (!decode.contains(*it))
+        if (!InQueue(kVideoBuffer_decode, *it))
         {
             Remove(kVideoBuffer_finished, *it);
             Enqueue(kVideoBuffer_avail, *it);
@@ -446,13 +469,7 @@ const frame_queue_t *VideoBuffers::Queue(BufferType type) const
 VideoFrame *VideoBuffers::Dequeue(BufferType type)
 {
     QMutexLocker locker(&global_lock);
-
-    frame_queue_t *q = Queue(type);
-
-    if (!q)
-        return NULL;
-
-    return q->dequeue();
+    return Pop(type);
 }
 
 VideoFrame *VideoBuffers::Head(BufferType type)
@@ -490,16 +507,12 @@ void VideoBuffers::Enqueue(BufferType type, VideoFrame *frame)
     if (!frame)
         return;
 
-    frame_queue_t *q = Queue(type);
-    if (!q)
+    if (queue_index(type) < 0)
         return;
 
-    global_lock.lock();
-    q->remove(frame);
-    q->enqueue(frame);
-    global_lock.unlock();
-
-    return;
+    QMutexLocker locker(&global_lock);
+    Erase(type, frame);
+    Push(type, frame);
 }
 
 void VideoBuffers::Remove(BufferType type, VideoFrame *frame)
@@ -510,19 +523,19 @@ void VideoBuffers::Remove(BufferType type, VideoFrame *frame)
     QMutexLocker locker(&global_lock);
 
     if ((type & kVideoBuffer_avail) == kVideoBuffer_avail)
-        available.remove(frame);
+        Erase(kVideoBuffer_avail, frame);
     if ((type & kVideoBuffer_used) == kVideoBuffer_used)
-        used.remove(frame);
+        Erase(kVideoBuffer_used, frame);
     if ((type & kVideoBuffer_displayed) == kVideoBuffer_displayed)
-        displayed.remove(frame);
+        Erase(kVideoBuffer_displayed, frame);
     if ((type & kVideoBuffer_limbo) == kVideoBuffer_limbo)
-        limbo.remove(frame);
+        Erase(kVideoBuffer_limbo, frame);
     if ((type & kVideoBuffer_pause) == kVideoBuffer_pause)
-        pause.remove(frame);
+        Erase(kVideoBuffer_pause, frame);
     if ((type & kVideoBuffer_decode) == kVideoBuffer_decode)
-        decode.remove(frame);
+        Erase(kVideoBuffer_decode, frame);
     if ((type & kVideoBuffer_finished) == kVideoBuffer_finished)
-        finished.remove(frame);
+        Erase(kVideoBuffer_finished, frame);
 }
 
 void VideoBuffers::Requeue(BufferType dst, BufferType src, int num)
@@ -573,26 +586,120 @@ frame_queue_t::iterator VideoBuffers::end(BufferType type)
     return it;
 }
 
+/**
+ * \fn VideoBuffers::Size(BufferType) const
+ *  Returns the number of frames in a single queue without locking.
+ */
 uint VideoBuffers::Size(BufferType type) const
 {
-    QMutexLocker locker(&global_lock);
+    int q = queue_index(type);
+    if (q < 0)
+        return 0;
 
-    const frame_queue_t *q = Queue(type);
-    if (q)
-        return q->size();
-
-    return 0;
+    return queue_size[q].loadAcquire();
 }
 
+/**
+ * \fn VideoBuffers::Contains(BufferType, VideoFrame*) const
+ *  Returns true if the frame is in the queue. This only locks
+ *  for frames that were not allocated by Init().
+ */
 bool VideoBuffers::Contains(BufferType type, VideoFrame *frame) const
 {
+    if (queue_index(type) < 0)
+        return false;
+
+    return InQueue(type, frame);
+}
+
+/// Returns the frame's position in buffers, or -1 if it is not one of ours.
+int VideoBuffers::Index(const VideoFrame *frame) const
+{
+    if (!frame || buffers.empty())
+        return -1;
+
+    const VideoFrame *first = &buffers[0];
+    if (frame < first || frame >= first + buffers.size())
+        return -1;
+
+    return frame - first;
+}
+
+bool VideoBuffers::InQueue(BufferType type, const VideoFrame *frame) const
+{
+    int q = queue_index(type);
+    int i = Index(frame);
+    if (q < 0 || !frame)
+        return false;
+
+    if (i >= 0 && i < kVideoBuffer_tracked)
+        return frame_refs[i][q].loadAcquire() > 0;
+
     QMutexLocker locker(&global_lock);
+    return Queue(type)->contains(const_cast<VideoFrame*>(frame));
+}
 
-    const frame_queue_t *q = Queue(type);
-    if (q)
-        return q->contains(frame);
+void VideoBuffers::Track(BufferType type, const VideoFrame *frame, int delta)
+{
+    int q = queue_index(type);
+    int i = Index(frame);
+
+    queue_size[q].fetchAndAddOrdered(delta);
+    if (i >= 0 && i < kVideoBuffer_tracked)
+        frame_refs[i][q].fetchAndAddOrdered(delta);
+}
+
+/// Appends the frame to a single queue. Caller must hold global_lock.
+void VideoBuffers::Push(BufferType type, VideoFrame *frame)
+{
+    frame_queue_t *q = Queue(type);
+    if (!q || !frame)
+        return;
+
+    q->enqueue(frame);
+    Track(type, frame, +1);
+}
+
+/// Takes the head of a single queue. Caller must hold global_lock.
+VideoFrame *VideoBuffers::Pop(BufferType type)
+{
+    frame_queue_t *q = Queue(type);
+    if (!q)
+        return NULL;
+
+    VideoFrame *frame = q->dequeue();
+    if (frame)
+        Track(type, frame, -1);
+    return frame;
+}
+
+/// Removes one occurrence of the frame from a single queue.
+/// Caller must hold global_lock.
+void VideoBuffers::Erase(BufferType type, VideoFrame *frame)
+{
+    frame_queue_t *q = Queue(type);
+    if (!q)
+        return;
+
+    frame_queue_t::iterator it = q->find(frame);
+    if (it == q->end())
+        return;
+
+    q->erase(it);
+    Track(type, frame, -1);
+}
+
+/// Empties a single queue. Caller must hold global_lock.
+void VideoBuffers::ClearQueue(BufferType type)
+{
+    frame_queue_t *q = Queue(type);
+    if (!q)
+        return;
 
-    return false;
+    frame_queue_t::iterator it = q->begin();
+    for (; it != q->end(); ++it)
+        Track(type, *it, -1);
+    q->clear();
 }
 
 VideoFrame *VideoBuffers::GetScratchFrame(void)
@@ -616,7 +723,7 @@ void VideoBuffers::SetLastShownFrameToScratch(void)
     }
 
     VideoFrame *pause = Head(kVideoBuffer_pause);
-    rpos = vbufferMap[pause];
+    rpos = max(Index(pause), 0);
 }
 
 /**
@@ -660,9 +767,9 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
     {
         for (uint i=0; i < Size(); i++)
         {
-            if (!available.contains(At(i)) &&
-                !pause.contains(At(i)) &&
-                !displayed.contains(At(i)))
+            if (!InQueue(kVideoBuffer_avail, At(i)) &&
+                !InQueue(kVideoBuffer_pause, At(i)) &&
+                !InQueue(kVideoBuffer_displayed, At(i)))
             {
                 // This message is DEBUG because it does occur
                 // after Reset is called.
@@ -683,8 +790,8 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
     for (it = decode.begin(); it != decode.end(); ++it)
         Remove(kVideoBuffer_all, *it);
     for (it = decode.begin(); it != decode.end(); ++it)
-        available.enqueue(*it);
-    decode.clear();
+        Push(kVideoBuffer_avail, *it);
+    ClearQueue(kVideoBuffer_decode);
 
     LOG(VB_PLAYBACK, LOG_INFO,
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
@@ -701,15 +808,15 @@ void VideoBuffers::ClearAfterSeek(void)
 
         while (used.count() > 1)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
+            VideoFrame *buffer = Pop(kVideoBuffer_used);
+            Push(kVideoBuffer_avail, buffer);
         }
 
         if (used.count() > 0)
         {
-            VideoFrame *buffer = used.dequeue();
-            available.enqueue(buffer);
-            vpos = vbufferMap[buffer];
+            VideoFrame *buffer = Pop(kVideoBuffer_used);
+            Push(kVideoBuffer_avail, buffer);
+            vpos = max(Index(buffer), 0);
             rpos = vpos;
         }
         else
@@ -790,7 +897,6 @@ uint VideoBuffers::AddBuffer(int width, int height, void* data,
     memset(&buffers[num], 0, sizeof(VideoFrame));
     buffers[num].interlaced_frame = -1;
     buffers[num].top_field_first  = 1;
-    vbufferMap[At(num)] = num;
     if (!data)
     {
         int size = buffersize(fmt, width, height);
@@ -7,6 +7,7 @@
 #include <map>
 using namespace std;
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QString>
 #include <QWaitCondition>
@@ -22,7 +23,6 @@ class MythXDisplay;
 typedef MythDeque<VideoFrame*>                frame_queue_t;
 typedef vector<VideoFrame>                    frame_vector_t;
 typedef map<const unsigned char*, void*>      buffer_map_t;
-typedef map<const VideoFrame*, uint>          vbuffer_map_t;
 typedef map<const VideoFrame*, QMutex*>       frame_lock_map_t;
 typedef vector<unsigned char*>                uchar_vector_t;
 
@@ -44,6 +44,11 @@ enum BufferType
     kVideoBuffer_all       = 0x0000003F,
 };
 
+/// Number of queues named in BufferType, excluding kVideoBuffer_all
+#define kVideoBuffer_queues      7
+/// Frames beyond this index fall back to locked queue searches
+#define kVideoBuffer_tracked   128
+
 class YUVInfo
 {
   public:
@@ -134,8 +139,21 @@ class MTV_PUBLIC VideoBuffers
     const frame_queue_t   *Queue(BufferType type) const;
     VideoFrame            *GetNextFreeFrameInternal(BufferType enqueue_to);
 
+    int                    Index(const VideoFrame *frame) const;
+    bool                   InQueue(BufferType type,
+                                   const VideoFrame *frame) const;
+    void                   Push(BufferType type, VideoFrame *frame);
+    VideoFrame            *Pop(BufferType type);
+    void                   Erase(BufferType type, VideoFrame *frame);
+    void                   ClearQueue(BufferType type);
+    void                   Track(BufferType type, const VideoFrame *frame,
+                                 int delta);
+
     frame_queue_t          available, used, limbo, pause, displayed, decode, finished;
-    vbuffer_map_t          vbufferMap; // videobuffers to buffer's index
+    // Queue lengths and per frame queue membership counts. These are only
+    // changed with global_lock held, but may be read without it.
+    QAtomicInt             queue_size[kVideoBuffer_queues];
+    QAtomicInt             frame_refs[kVideoBuffer_tracked][kVideoBuffer_queues];
     frame_vector_t         buffers;
     uchar_vector_t         allocated_arrays;  // for DeleteBuffers
 
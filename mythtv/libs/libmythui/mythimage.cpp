@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 // QT headers
+#include <QBuffer>
 #include <QImageReader>
 #include <QPainter>
 #include <QMatrix>
@@ -304,7 +305,46 @@ bool MythImage::Load(MythImageReader *reader)
     return false;
 }
 
-bool MythImage::Load(const QString &filename)
+/**
+ * Decodes an image, asking the reader to scale it to fit \p size when it is
+ * smaller than the image. Formats that support it (JPEG) then decode at a
+ * fraction of the full resolution instead of scaling afterwards.
+ */
+static QImage *ReadScaled(QImageReader &reader, const QSize &size,
+                          bool preserveAspect)
+{
+    if (size.isValid())
+    {
+        QSize full = reader.size();
+        if (full.isValid())
+        {
+            QSize target = full.scaled(size, preserveAspect ?
+                                       Qt::KeepAspectRatio :
+                                       Qt::IgnoreAspectRatio);
+            if (target.width() < full.width() &&
+                target.height() < full.height())
+                reader.setScaledSize(target);
+        }
+    }
+
+    return new QImage(reader.read());
+}
+
+static QImage *ReadScaled(QByteArray &data, const QSize &size,
+                          bool preserveAspect)
+{
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer);
+    return ReadScaled(reader, size, preserveAspect);
+}
+
+/**
+ * Loads a local, myth:// or http(s)/ftp image. When \p size is valid the
+ * image may be decoded at a reduced size, no smaller than needed to fill it.
+ * The caller is still responsible for resizing it exactly.
+ */
+bool MythImage::Load(const QString &filename, const QSize &size,
+                     bool preserveAspect)
 {
     if (filename.isEmpty())
         return false;
@@ -332,10 +372,7 @@ bool MythImage::Load(const QString &filename)
             delete rf;
 
             if (ret)
-            {
-                im = new QImage();
-                im->loadFromData(data);
-            }
+                im = ReadScaled(data, size, preserveAspect);
         }
 #if 0
         else
@@ -351,17 +388,17 @@ bool MythImage::Load(const QString &filename)
     {
         QByteArray data;
         if (GetMythDownloadManager()->download(filename, &data))
-        {
-            im = new QImage();
-            im->loadFromData(data);
-        }
+            im = ReadScaled(data, size, preserveAspect);
     }
     else
     {
         QString path = filename;
         if (path.startsWith('/') ||
             GetMythUI()->FindThemeFile(path))
-            im = new QImage(path);
+        {
+            QImageReader reader(path);
+            im = ReadScaled(reader, size, preserveAspect);
+        }
     }
 
     if (im && im->isNull())
@@ -56,7 +56,8 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     void Assign(const QPixmap &pix);
 
     bool Load(MythImageReader *reader);
-    bool Load(const QString &filename);
+    bool Load(const QString &filename, const QSize &size = QSize(),
+              bool preserveAspect = false);
 
     void Orientation(int orientation);
     void Resize(const QSize &newSize, bool preserveAspect = false);
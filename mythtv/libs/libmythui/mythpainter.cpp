@@ -5,6 +5,9 @@
 // QT headers
 #include <QRect>
 #include <QPainter>
+#include <QGlyphRun>
+#include <QRawFont>
+#include <QTextLine>
 
 // libmythbase headers
 #include "mythlogging.h"
@@ -19,9 +22,12 @@
 // Own header
 #include "mythpainter.h"
 
+/// Bytes of glyph images kept for composing strings
+static const int kGlyphCacheSize = 4 * 1024 * 1024;
+
 MythPainter::MythPainter()
   : m_Parent(0), m_HardwareCacheSize(0), m_SoftwareCacheSize(0),
-    m_showBorders(false), m_showNames(false)
+    m_showBorders(false), m_showNames(false), m_glyphCache(kGlyphCacheSize)
 {
     SetMaximumCacheSizes(
         gCoreContext->GetNumSetting("UIPainterMaxCacheHW",64),
@@ -31,6 +37,7 @@ MythPainter::MythPainter()
 void MythPainter::Teardown(void)
 {
     ExpireImages(0);
+    m_glyphCache.clear();
 
     QMutexLocker locker(&m_allocationLock);
 
@@ -311,6 +318,135 @@ void MythPainter::DrawTextPriv(MythImage *im, const QString &msg, int flags,
     im->Assign(pm);
 }
 
+/**
+ * \brief Draws text like DrawTextPriv() does, from cached glyph images
+ *
+ * Only plain fonts on a single line are drawn this way, the text is laid
+ * out as QPainter would and each glyph is drawn once and then copied into
+ * every string that uses it.  Fonts with an outline, a shadow or a
+ * gradient are left to DrawTextPriv(), as is anything that wraps.
+ *
+ * \return false if DrawTextPriv() should draw the text instead.
+ */
+bool MythPainter::DrawTextGlyphs(MythImage *im, const QString &msg, int flags,
+                                 const QRect &r,
+                                 const MythFontProperties &font)
+{
+    if (!im || font.hasOutline() || font.hasShadow() ||
+        font.GetBrush().style() != Qt::SolidPattern)
+        return false;
+
+    if (flags & (Qt::TextWordWrap | Qt::TextWrapAnywhere |
+                 Qt::TextShowMnemonic | Qt::TextExpandTabs |
+                 Qt::AlignJustify))
+        return false;
+
+    if (msg.isRightToLeft() || msg.contains('\n') || msg.contains('\t') ||
+        msg.contains(QChar::LineSeparator))
+        return false;
+
+    QImage pm(r.size(), QImage::Format_ARGB32_Premultiplied);
+    pm.fill(0);
+
+    QFont tmpfont = font.face();
+    tmpfont.setStyleStrategy(QFont::OpenGLCompatible);
+
+    // Lay it out on the image, as QPainter::drawText() would
+    QTextOption option(Qt::Alignment(QFlag(flags)) &
+                       Qt::AlignHorizontal_Mask);
+    option.setWrapMode(QTextOption::NoWrap);
+
+    QTextLayout layout(msg, tmpfont, &pm);
+    layout.setTextOption(option);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    if (!line.isValid())
+    {
+        layout.endLayout();
+        return false;
+    }
+    line.setLineWidth(r.width());
+    line.setPosition(QPointF(0, 0));
+    layout.endLayout();
+
+    // DrawTextPriv() centres the font height in r, then aligns in that
+    int yoff = (r.height() - QFontMetrics(tmpfont).height()) / 2;
+    if (flags & Qt::AlignBottom)
+        yoff += r.height() - qRound(line.height());
+    else if (flags & Qt::AlignVCenter)
+        yoff += (r.height() - qRound(line.height())) / 2;
+
+    QColor color = font.color();
+    QPainter painter(&pm);
+
+    QList<QGlyphRun> runs = line.glyphRuns();
+    for (QList<QGlyphRun>::const_iterator run = runs.begin();
+         run != runs.end(); ++run)
+    {
+        QRawFont raw = run->rawFont();
+        QString  prefix = font.GetHash() + ':' + raw.familyName() + ':' +
+                          raw.styleName() + ':' +
+                          QString::number(raw.pixelSize()) + ':' +
+                          QString::number(color.rgba()) + ':';
+
+        QVector<quint32> indexes   = run->glyphIndexes();
+        QVector<QPointF> positions = run->positions();
+
+        for (int i = 0; i < indexes.size() && i < positions.size(); ++i)
+        {
+            QString      key   = prefix + QString::number(indexes[i]);
+            CachedGlyph *glyph = m_glyphCache.object(key);
+            bool         drawn = (glyph == NULL);
+
+            if (drawn)
+            {
+                glyph = new CachedGlyph;
+
+                QRectF br = raw.boundingRect(indexes[i]);
+                if (!br.isEmpty())
+                {
+                    // A pixel to spare all round for antialiasing
+                    QRect area = br.toAlignedRect().adjusted(-1, -1, 1, 1);
+
+                    glyph->offset = area.topLeft();
+                    glyph->image  = QImage(area.size(),
+                                           QImage::Format_ARGB32_Premultiplied);
+                    glyph->image.fill(0);
+
+                    QGlyphRun one;
+                    one.setRawFont(raw);
+                    one.setGlyphIndexes(QVector<quint32>() << indexes[i]);
+                    one.setPositions(QVector<QPointF>()
+                                     << -QPointF(area.topLeft()));
+
+                    QPainter gp(&glyph->image);
+                    gp.setPen(color);
+                    gp.drawGlyphRun(QPointF(0, 0), one);
+                }
+            }
+
+            if (!glyph->image.isNull())
+            {
+                QPoint at(qRound(positions[i].x()), qRound(positions[i].y()));
+                painter.drawImage(at + glyph->offset + QPoint(0, yoff),
+                                  glyph->image);
+            }
+
+            // The cache deletes glyphs it has no room for, so this is last
+            if (drawn)
+            {
+                int cost = glyph->image.bytesPerLine() * glyph->image.height();
+                m_glyphCache.insert(key, glyph, std::max(cost, 1));
+            }
+        }
+    }
+
+    painter.end();
+    im->Assign(pm);
+
+    return true;
+}
+
 void MythPainter::DrawRectPriv(MythImage *im, const QRect &area, int radius,
                                int ellipse,
                                const QBrush &fillBrush, const QPen &linePen)
@@ -350,31 +486,20 @@ MythImage *MythPainter::GetImageFromString(const QString &msg,
                                            int flags, const QRect &r,
                                            const MythFontProperties &font)
 {
-    QString incoming = font.GetHash() + QString::number(r.width()) +
-                       QString::number(r.height()) +
-                       QString::number(flags) +
-                       QString::number(font.color().rgba()) + msg;
+    QString incoming = font.GetHash() + ':' + QString::number(r.width()) +
+                       'x' + QString::number(r.height()) +
+                       ':' + QString::number(flags) +
+                       ':' + QString::number(font.color().rgba()) + ':' + msg;
 
-    MythImage *im = NULL;
-    if (m_StringToImageMap.contains(incoming))
-    {
-        m_StringExpireList.remove(incoming);
-        m_StringExpireList.push_back(incoming);
-        im = m_StringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
-    }
-    else
+    MythImage *im = GetCachedImage(incoming);
+    if (!im)
     {
         im = GetFormatImage();
         im->SetFileName(QString("GetImageFromString: %1").arg(msg));
-        DrawTextPriv(im, msg, flags, r, font);
+        if (!DrawTextGlyphs(im, msg, flags, r, font))
+            DrawTextPriv(im, msg, flags, r, font);
 
-        im->IncrRef();
-        m_SoftwareCacheSize += im->bytesPerLine() * im->height();
-        m_StringToImageMap[incoming] = im;
-        m_StringExpireList.push_back(incoming);
-        ExpireImages(m_MaxSoftwareCacheSize);
+        InsertCachedImage(incoming, im);
     }
     return im;
 }
@@ -387,26 +512,18 @@ MythImage *MythPainter::GetImageFromTextLayout(const LayoutVector &layouts,
     LayoutVector::const_iterator Ipara;
 
     QString incoming = QString::number(canvas.x()) +
-                       QString::number(canvas.y()) +
-                       QString::number(canvas.width()) +
-                       QString::number(canvas.height()) +
-                       QString::number(dest.width()) +
-                       QString::number(dest.height()) +
-                       font.GetHash();
+                       ',' + QString::number(canvas.y()) +
+                       ':' + QString::number(canvas.width()) +
+                       'x' + QString::number(canvas.height()) +
+                       ':' + QString::number(dest.width()) +
+                       'x' + QString::number(dest.height()) +
+                       ':' + font.GetHash();
 
     for (Ipara = layouts.begin(); Ipara != layouts.end(); ++Ipara)
-        incoming += (*Ipara)->text();
+        incoming += '\n' + (*Ipara)->text();
 
-    MythImage *im = NULL;
-    if (m_StringToImageMap.contains(incoming))
-    {
-        m_StringExpireList.remove(incoming);
-        m_StringExpireList.push_back(incoming);
-        im = m_StringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
-    }
-    else
+    MythImage *im = GetCachedImage(incoming);
+    if (!im)
     {
         im = GetFormatImage();
         im->SetFileName("GetImageFromTextLayout");
@@ -460,11 +577,7 @@ MythImage *MythPainter::GetImageFromTextLayout(const LayoutVector &layouts,
         pm.setOffset(canvas.topLeft());
         im->Assign(pm.copy(0, 0, dest.width(), dest.height()));
 
-        im->IncrRef();
-        m_SoftwareCacheSize += im->bytesPerLine() * im->height();
-        m_StringToImageMap[incoming] = im;
-        m_StringExpireList.push_back(incoming);
-        ExpireImages(m_MaxSoftwareCacheSize);
+        InsertCachedImage(incoming, im);
     }
     return im;
 }
@@ -508,32 +621,53 @@ MythImage* MythPainter::GetImageFromRect(const QRect &area, int radius,
         }
     }
 
-    incoming += QString::number(hash1) + QString::number(hash2);
+    incoming += ':' + QString::number(hash1) + ':' + QString::number(hash2);
 
-    MythImage *im = NULL;
-    if (m_StringToImageMap.contains(incoming))
-    {
-        m_StringExpireList.remove(incoming);
-        m_StringExpireList.push_back(incoming);
-        im = m_StringToImageMap[incoming];
-        if (im)
-            im->IncrRef();
-    }
-    else
+    MythImage *im = GetCachedImage(incoming);
+    if (!im)
     {
         im = GetFormatImage();
         im->SetFileName("GetImageFromRect");
         DrawRectPriv(im, area, radius, ellipse, fillBrush, linePen);
 
-        im->IncrRef();
-        m_SoftwareCacheSize += (im->bytesPerLine() * im->height());
-        m_StringToImageMap[incoming] = im;
-        m_StringExpireList.push_back(incoming);
-        ExpireImages(m_MaxSoftwareCacheSize);
+        InsertCachedImage(incoming, im);
     }
     return im;
 }
 
+/**
+ * \brief Returns a rendered image from the cache, marking it most recently
+ *        used. The reference count is set for one use, call DecrRef().
+ */
+MythImage *MythPainter::GetCachedImage(const QString &key)
+{
+    QHash<QString, CachedImage>::iterator it = m_StringToImageMap.find(key);
+    if (it == m_StringToImageMap.end())
+        return NULL;
+
+    m_StringExpireList.splice(m_StringExpireList.end(),
+                              m_StringExpireList, it->expire);
+    it->image->IncrRef();
+    return it->image;
+}
+
+/**
+ * \brief Adds a rendered image to the cache, expiring the least recently
+ *        used images if it is full
+ */
+void MythPainter::InsertCachedImage(const QString &key, MythImage *im)
+{
+    im->IncrRef();
+    m_SoftwareCacheSize += im->bytesPerLine() * im->height();
+
+    CachedImage cached;
+    cached.image  = im;
+    cached.expire = m_StringExpireList.insert(m_StringExpireList.end(), key);
+    m_StringToImageMap.insert(key, cached);
+
+    ExpireImages(m_MaxSoftwareCacheSize);
+}
+
 MythImage *MythPainter::GetFormatImage(void)
 {
     QMutexLocker locker(&m_allocationLock);
@@ -571,15 +705,15 @@ void MythPainter::ExpireImages(int64_t max)
         QString oldmsg = m_StringExpireList.front();
         m_StringExpireList.pop_front();
 
-        QMap<QString, MythImage*>::iterator it =
+        QHash<QString, CachedImage>::iterator it =
             m_StringToImageMap.find(oldmsg);
         if (it == m_StringToImageMap.end())
         {
             recompute = true;
             continue;
         }
-        MythImage *oldim = *it;
-        it = m_StringToImageMap.erase(it);
+        MythImage *oldim = it->image;
+        m_StringToImageMap.erase(it);
 
         if (oldim)
         {
@@ -595,9 +729,10 @@ void MythPainter::ExpireImages(int64_t max)
     if (recompute)
     {
         m_SoftwareCacheSize = 0;
-        QMap<QString, MythImage*>::iterator it = m_StringToImageMap.begin();
+        QHash<QString, CachedImage>::iterator it = m_StringToImageMap.begin();
         for (; it != m_StringToImageMap.end(); ++it)
-            m_SoftwareCacheSize += (*it)->bytesPerLine() * (*it)->height();
+            m_SoftwareCacheSize +=
+                it->image->bytesPerLine() * it->image->height();
     }
 }
 
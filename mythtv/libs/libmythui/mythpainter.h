@@ -2,6 +2,9 @@
 #define MYTHPAINTER_H_
 
 #include <QMap>
+#include <QHash>
+#include <QCache>
+#include <QImage>
 #include <QString>
 #include <QTextLayout>
 #include <QWidget>
@@ -101,6 +104,8 @@ class MUI_PUBLIC MythPainter
   protected:
     void DrawTextPriv(MythImage *im, const QString &msg, int flags,
                       const QRect &r, const MythFontProperties &font);
+    bool DrawTextGlyphs(MythImage *im, const QString &msg, int flags,
+                        const QRect &r, const MythFontProperties &font);
     void DrawRectPriv(MythImage *im, const QRect &area, int radius, int ellipse,
                       const QBrush &fillBrush, const QPen &linePen);
 
@@ -113,6 +118,8 @@ class MUI_PUBLIC MythPainter
     MythImage *GetImageFromRect(const QRect &area, int radius, int ellipse,
                                 const QBrush &fillBrush,
                                 const QPen &linePen);
+    MythImage *GetCachedImage(const QString &key);
+    void       InsertCachedImage(const QString &key, MythImage *im);
 
     /// Creates a reference counted image, call DecrRef() to delete.
     virtual MythImage* GetFormatImagePriv(void) = 0;
@@ -136,8 +143,30 @@ class MUI_PUBLIC MythPainter
     QMutex           m_allocationLock;
     QSet<MythImage*> m_allocatedImages;
 
-    QMap<QString, MythImage *> m_StringToImageMap;
-    std::list<QString>         m_StringExpireList;
+    typedef std::list<QString> StringExpireList;
+
+    /// A rendered image and its key's place in the expiry list, so that
+    /// cache hits can be moved to the back without a search
+    struct CachedImage
+    {
+        MythImage                 *image;
+        StringExpireList::iterator expire;
+    };
+
+    QHash<QString, CachedImage> m_StringToImageMap;
+    StringExpireList            m_StringExpireList;
+
+    /// A glyph drawn on its own, and where its top left is relative to
+    /// the glyph's origin on the baseline
+    struct CachedGlyph
+    {
+        QImage image;
+        QPoint offset;
+    };
+
+    /// Glyphs of plain fonts, costed in bytes, that strings not yet in
+    /// m_StringToImageMap are composed from
+    QCache<QString, CachedGlyph> m_glyphCache;
 
     bool m_showBorders;
     bool m_showNames;
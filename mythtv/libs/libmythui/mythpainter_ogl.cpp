@@ -62,14 +62,12 @@ void MythOpenGLPainter::ClearCache(void)
     LOG(VB_GENERAL, LOG_INFO, "Clearing OpenGL painter cache.");
 
     QMutexLocker locker(&m_textureDeleteLock);
-    QMapIterator<MythImage *, unsigned int> it(m_ImageIntMap);
-    while (it.hasNext())
-    {
-        it.next();
-        m_textureDeleteList.push_back(m_ImageIntMap[it.key()]);
-        m_ImageExpireList.remove(it.key());
-    }
+    QHash<MythImage *, CachedTexture>::const_iterator it =
+        m_ImageIntMap.constBegin();
+    for (; it != m_ImageIntMap.constEnd(); ++it)
+        m_textureDeleteList.push_back(it->texture);
     m_ImageIntMap.clear();
+    m_ImageExpireList.clear();
 }
 
 void MythOpenGLPainter::Begin(QPaintDevice *parent)
@@ -138,13 +136,15 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     if (!realRender)
         return 0;
 
-    if (m_ImageIntMap.contains(im))
+    QHash<MythImage *, CachedTexture>::iterator it = m_ImageIntMap.find(im);
+    if (it != m_ImageIntMap.end())
     {
         if (!im->IsChanged())
         {
-            m_ImageExpireList.remove(im);
-            m_ImageExpireList.push_back(im);
-            return m_ImageIntMap[im];
+            // Move to the back of the expiry list
+            m_ImageExpireList.splice(m_ImageExpireList.end(),
+                                     m_ImageExpireList, it->expire);
+            return it->texture;
         }
         else
         {
@@ -177,11 +177,10 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
                 "Shrinking UIPainterMaxCacheHW to %1KB")
             .arg(m_MaxHardwareCacheSize / 1024));
 
-        while (m_HardwareCacheSize > m_MaxHardwareCacheSize)
+        while (m_HardwareCacheSize > m_MaxHardwareCacheSize &&
+               !m_ImageExpireList.empty())
         {
-            MythImage *expiredIm = m_ImageExpireList.front();
-            m_ImageExpireList.pop_front();
-            DeleteFormatImagePriv(expiredIm);
+            DeleteFormatImagePriv(m_ImageExpireList.front());
             DeleteTextures();
         }
     }
@@ -191,14 +190,16 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     realRender->GetTextureBuffer(tx_id, false);
     realRender->UpdateTexture(tx_id, tx.bits());
 
-    m_ImageIntMap[im] = tx_id;
-    m_ImageExpireList.push_back(im);
+    CachedTexture cached;
+    cached.texture = tx_id;
+    cached.expire  = m_ImageExpireList.insert(m_ImageExpireList.end(), im);
+    m_ImageIntMap.insert(im, cached);
 
-    while (m_HardwareCacheSize > m_MaxHardwareCacheSize)
+    // Never expire the texture just created
+    while (m_HardwareCacheSize > m_MaxHardwareCacheSize &&
+           m_ImageExpireList.front() != im)
     {
-        MythImage *expiredIm = m_ImageExpireList.front();
-        m_ImageExpireList.pop_front();
-        DeleteFormatImagePriv(expiredIm);
+        DeleteFormatImagePriv(m_ImageExpireList.front());
         DeleteTextures();
     }
 
@@ -244,12 +245,13 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
 
 void MythOpenGLPainter::DeleteFormatImagePriv(MythImage *im)
 {
-    if (m_ImageIntMap.contains(im))
+    QHash<MythImage *, CachedTexture>::iterator it = m_ImageIntMap.find(im);
+    if (it != m_ImageIntMap.end())
     {
         QMutexLocker locker(&m_textureDeleteLock);
-        m_textureDeleteList.push_back(m_ImageIntMap[im]);
-        m_ImageIntMap.remove(im);
-        m_ImageExpireList.remove(im);
+        m_textureDeleteList.push_back(it->texture);
+        m_ImageExpireList.erase(it->expire);
+        m_ImageIntMap.erase(it);
     }
 }
 
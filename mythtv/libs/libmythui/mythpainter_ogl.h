@@ -2,6 +2,7 @@
 #define MYTHPAINTER_OPENGL_H_
 
 #include <QMutex>
+#include <QHash>
 
 #include <list>
 
@@ -52,8 +53,18 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     int               target;
     bool              swapControl;
 
-    QMap<MythImage *, uint>    m_ImageIntMap;
-    std::list<MythImage *>     m_ImageExpireList;
+    typedef std::list<MythImage *> ImageExpireList;
+
+    /// A texture and the image's place in the expiry list, so that
+    /// cache hits can be moved to the back without a search
+    struct CachedTexture
+    {
+        uint                      texture;
+        ImageExpireList::iterator expire;
+    };
+
+    QHash<MythImage *, CachedTexture> m_ImageIntMap;
+    ImageExpireList            m_ImageExpireList;
     std::list<uint>            m_textureDeleteList;
     QMutex                     m_textureDeleteLock;
 };
@@ -881,9 +881,8 @@ bool MythThemedMenu::findDepends(const QString &fileList)
         if (!filename.isEmpty() && filename.endsWith(".xml"))
             return true;
 
-        // Has plugin by this name been successfully loaded
-        MythPlugin *plugin = pluginManager->GetPlugin(*it);
-        if (plugin)
+        // Has plugin by this name been loaded, or is it still to be
+        if (pluginManager->HasPlugin(*it))
             return true;
     }
 
@@ -99,6 +99,11 @@ void MythUIButtonList::Const(void)
     m_buttontemplate = NULL;
 
     m_nextItemLoaded = 0;
+    m_prefetchMargin = 0;
+    m_prefetchTop    = -1;
+    m_loadedFirst    = 0;
+    m_loadedLast     = 0;
+    m_loadedCount    = 0;
 
     SetCanTakeFocus(true);
 
@@ -158,6 +163,8 @@ void MythUIButtonList::SetActive(bool active)
 void MythUIButtonList::Reset()
 {
     m_ButtonToItem.clear();
+    m_prefetchTop = -1;
+    m_loadedFirst = m_loadedLast = m_loadedCount = 0;
 
     if (m_itemList.isEmpty())
         return;
@@ -1468,6 +1475,14 @@ void MythUIButtonList::CalculateArrowStates()
 
     m_needsUpdate = false;
 
+    // Load the items around those now shown
+    if (m_prefetchMargin > 0 && m_topPosition != m_prefetchTop)
+    {
+        m_prefetchTop = m_topPosition;
+        StopLoad();
+        LoadInBackground();
+    }
+
     if (!m_downArrow || !m_upArrow)
         return;
 
@@ -1495,8 +1510,86 @@ void MythUIButtonList::CalculateArrowStates()
 
 void MythUIButtonList::ItemVisible(MythUIButtonListItem *item)
 {
-    if (item)
-        emit itemVisible(item);
+    if (!item)
+        return;
+
+    if (m_prefetchMargin > 0 && !item->m_loaded)
+    {
+        // Items shown are at or after the top one, unless the list wraps
+        int pos = m_itemList.indexOf(item, qMax(m_topPosition, 0));
+        if (pos < 0)
+            pos = m_itemList.indexOf(item);
+        LoadItem(pos);
+    }
+
+    emit itemVisible(item);
+}
+
+/**
+ *  \brief Has the item at \p pos filled in by the screen, unless it
+ *         already is
+ *
+ *   Only used when items are loaded on demand, see SetPrefetchMargin()
+ */
+void MythUIButtonList::LoadItem(int pos)
+{
+    MythUIButtonListItem *item = GetItemAt(pos);
+
+    if (!item || item->m_loaded)
+        return;
+
+    item->m_loaded = true;
+
+    if (m_loadedCount++ == 0)
+    {
+        m_loadedFirst = pos;
+        m_loadedLast  = pos + 1;
+    }
+    else
+    {
+        m_loadedFirst = qMin(m_loadedFirst, pos);
+        m_loadedLast  = qMax(m_loadedLast, pos + 1);
+    }
+
+    emit itemLoaded(item);
+}
+
+void MythUIButtonList::UnloadItem(int pos)
+{
+    MythUIButtonListItem *item = m_itemList.at(pos);
+
+    if (!item->m_loaded)
+        return;
+
+    item->Unload();
+    --m_loadedCount;
+}
+
+/**
+ *  \brief Unloads the items that are no longer near those shown, once more
+ *         than twice the prefetch window is loaded
+ */
+void MythUIButtonList::RecycleItems(void)
+{
+    int window = qMax((int)m_itemsVisible, 1) + 2 * m_prefetchMargin;
+    int first  = m_topPosition - m_prefetchMargin;
+    int last   = first + window;
+
+    if (m_loadedCount <= 2 * window)
+        return;
+
+    // Only the positions loaded outside the window need looking at
+    for (int pos = m_loadedFirst; pos < qMin(first, m_loadedLast); ++pos)
+        UnloadItem(pos);
+
+    for (int pos = qMax(last, m_loadedFirst); pos < m_loadedLast; ++pos)
+        UnloadItem(pos);
+
+    m_loadedFirst = qMax(m_loadedFirst, first);
+    m_loadedLast  = qMin(m_loadedLast, last);
+
+    if (m_loadedCount == 0 || m_loadedFirst >= m_loadedLast)
+        m_loadedFirst = m_loadedLast = 0;
 }
 
 void MythUIButtonList::InsertItem(MythUIButtonListItem *item, int listPosition)
@@ -1507,6 +1600,14 @@ void MythUIButtonList::InsertItem(MythUIButtonListItem *item, int listPosition)
     {
         m_itemList.insert(listPosition, item);
 
+        if (listPosition < m_loadedFirst)
+        {
+            ++m_loadedFirst;
+            ++m_loadedLast;
+        }
+        else if (listPosition < m_loadedLast)
+            ++m_loadedLast;
+
         if (listPosition <= m_selPosition)
             ++m_selPosition;
 
@@ -1566,6 +1667,20 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     m_itemList.removeAt(curIndex);
     --m_itemCount;
 
+    if (item->m_loaded)
+        --m_loadedCount;
+
+    if (curIndex < m_loadedFirst)
+    {
+        --m_loadedFirst;
+        --m_loadedLast;
+    }
+    else if (curIndex < m_loadedLast)
+        --m_loadedLast;
+
+    if (m_loadedCount == 0)
+        m_loadedFirst = m_loadedLast = 0;
+
     Update();
 
     if (m_selPosition < m_itemCount)
@@ -2366,6 +2481,13 @@ bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
     m_itemList.removeAt(oldpos);
     m_itemList.insert(insertat, item);
 
+    // Keep both swapped positions within the loaded range
+    if (m_loadedCount > 0)
+    {
+        m_loadedFirst = qMin(m_loadedFirst, qMin(oldpos, insertat));
+        m_loadedLast  = qMax(m_loadedLast, qMax(oldpos, insertat) + 1);
+    }
+
     if (up)
     {
         MoveUp();
@@ -2768,6 +2890,18 @@ void MythUIButtonList::customEvent(QEvent *event)
         NextButtonListPageEvent *npe =
             static_cast<NextButtonListPageEvent*>(event);
         int cur = npe->m_start;
+
+        if (m_prefetchMargin > 0)
+        {
+            // Only the window around the items shown is kept loaded
+            for (; cur < npe->m_start + npe->m_pageSize && cur < GetCount();
+                 ++cur)
+                LoadItem(cur);
+            m_nextItemLoaded = cur;
+            RecycleItems();
+            return;
+        }
+
         for (; cur < npe->m_start + npe->m_pageSize && cur < GetCount(); ++cur)
         {
             const int loginterval = (cur < 1000 ? 100 : 500);
@@ -2784,6 +2918,13 @@ void MythUIButtonList::customEvent(QEvent *event)
 
 void MythUIButtonList::LoadInBackground(int start, int pageSize)
 {
+    if (m_prefetchMargin > 0)
+    {
+        // Only the items around those shown are needed
+        start    = qMax(m_topPosition - m_prefetchMargin, 0);
+        pageSize = qMax((int)m_itemsVisible, 1) + 2 * m_prefetchMargin;
+    }
+
     m_nextItemLoaded = start;
     QCoreApplication::
         postEvent(this, new NextButtonListPageEvent(start, pageSize));
@@ -2796,6 +2937,23 @@ int MythUIButtonList::StopLoad(void)
     return m_nextItemLoaded;
 }
 
+/**
+ *  \brief Loads items on demand rather than all of them in the background
+ *
+ *   Only items within \p margin of those shown are loaded, through the
+ *   itemLoaded() signal. Items far from the view are recycled: their text
+ *   maps, images and states are dropped and they will be loaded again when
+ *   next needed. The screen must therefore fill in items from itemLoaded()
+ *   or itemVisible() only. Their text, data and check state are kept.
+ *
+ *  \param margin Items to load either side of those shown, 0 to load all
+ */
+void MythUIButtonList::SetPrefetchMargin(int margin)
+{
+    m_prefetchMargin = qMax(margin, 0);
+    m_prefetchTop    = -1;
+}
+
 QPoint MythUIButtonList::GetButtonPosition(int column, int row) const
 {
     int x = m_contentsRect.x() +
@@ -3205,6 +3363,10 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
 
     while (true)
     {
+        // Fields of unloaded items aren't known yet
+        if (m_prefetchMargin > 0)
+            LoadItem(currPos);
+
         found = GetItemAt(currPos)->FindText(m_searchStr, m_searchFields, m_searchStartsWith);
 
         if (found)
@@ -3255,6 +3417,7 @@ MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype,
     m_data      = 0;
     m_isVisible = false;
     m_enabled   = true;
+    m_loaded    = false;
 
     if (state >= NotChecked)
         m_checkable = true;
@@ -3281,6 +3444,7 @@ MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype,
     m_showArrow = false;
     m_isVisible = false;
     m_enabled   = true;
+    m_loaded    = false;
 
     if (m_parent)
         m_parent->InsertItem(this, listPosition);
@@ -3303,6 +3467,25 @@ MythUIButtonListItem::~MythUIButtonListItem()
     m_images.clear();
 }
 
+/**
+ *  \brief Drops the text maps, images and states of a recycled item
+ */
+void MythUIButtonListItem::Unload(void)
+{
+    QMap<QString, MythImage*>::iterator it;
+    for (it = m_images.begin(); it != m_images.end(); ++it)
+    {
+        if (*it)
+            (*it)->DecrRef();
+    }
+    m_images.clear();
+
+    m_strings.clear();
+    m_imageFilenames.clear();
+    m_states.clear();
+    m_loaded = false;
+}
+
 void MythUIButtonListItem::SetText(const QString &text, const QString &name,
                                    const QString &state)
 {
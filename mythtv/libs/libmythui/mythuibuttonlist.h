@@ -106,6 +106,8 @@ class MUI_PUBLIC MythUIButtonListItem
     virtual void SetToRealButton(MythUIStateType *button, bool selected);
 
   protected:
+    void Unload(void);
+
     MythUIButtonList *m_parent;
     QString         m_text;
     QString         m_fontState;
@@ -117,6 +119,7 @@ class MUI_PUBLIC MythUIButtonListItem
     bool            m_showArrow;
     bool            m_isVisible;
     bool            m_enabled;
+    bool            m_loaded;
 
     QMap<QString, TextProperties> m_strings;
     QMap<QString, MythImage*> m_images;
@@ -208,6 +211,7 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
 
     void LoadInBackground(int start = 0, int pageSize = 20);
     int  StopLoad(void);
+    void SetPrefetchMargin(int margin);
 
   public slots:
     void Select();
@@ -258,6 +262,9 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     void CalculateArrowStates(void);
     void SetScrollBarPosition(void);
     void ItemVisible(MythUIButtonListItem *item);
+    void LoadItem(int pos);
+    void UnloadItem(int pos);
+    void RecycleItems(void);
 
     void SetActive(bool active);
 
@@ -334,6 +341,15 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     QList<MythUIButtonListItem*> m_itemList;
     int m_nextItemLoaded;
 
+    /// Items loaded either side of those shown, 0 to load every item
+    int m_prefetchMargin;
+    int m_prefetchTop;
+    /// When only some items are kept loaded, they all lie within
+    /// [m_loadedFirst, m_loadedLast)
+    int m_loadedFirst;
+    int m_loadedLast;
+    int m_loadedCount;
+
     bool m_drawFromBottom;
 
     QString     m_lcdTitle;
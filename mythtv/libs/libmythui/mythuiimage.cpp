@@ -14,6 +14,8 @@
 #include <QDomDocument>
 #include <QImageReader>
 #include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QAtomicInt>
 #include <QRunnable>
 #include <QEvent>
 #include <QCoreApplication>
@@ -302,10 +304,17 @@ class ImageLoader
             image = painter->GetFormatImage();
             bool ok = false;
 
+            // Decode straight to the forced size when nothing done to the
+            // image before the resize below changes its dimensions
+            QSize decodeSize;
+            if (bResize && w > 0 && h > 0 &&
+                !imProps.isReflected && !imProps.isOriented)
+                decodeSize = QSize(w, h);
+
             if (imageReader)
                 ok = image->Load(imageReader);
             else
-                ok = image->Load(filename);
+                ok = image->Load(filename, decodeSize, imProps.preserveAspect);
 
             if (!ok)
             {
@@ -506,6 +515,15 @@ QEvent::Type ImageLoadEvent::kEventType =
 
 /*!
 * \class ImageLoadThread
+* \brief Loads an image in the background.
+*
+* Loads are queued by priority, see MythUIImage::Load(). A load that is no
+* longer wanted by the time it reaches the front of the queue, because its
+* MythUIImage has since moved on to another file or been deleted, is dropped
+* without reading anything.
+*
+* Images are tracked by their serial number rather than their address, which
+* a new MythUIImage may well reuse while loads for a deleted one are queued.
 */
 class ImageLoadThread : public QRunnable
 {
@@ -513,12 +531,70 @@ class ImageLoadThread : public QRunnable
     ImageLoadThread(const MythUIImage *parent, MythPainter *painter,
                     const ImageProperties &imProps, const QString &basefile,
                     int number, ImageCacheMode mode) :
-        m_parent(parent), m_painter(painter), m_imageProperties(imProps),
+        m_parent(parent), m_serial(parent->m_serial), m_painter(painter),
+        m_imageProperties(imProps),
         m_basefile(basefile), m_number(number), m_cacheMode(mode)
     {
     }
 
+    /// Records the file a MythUIImage now shows, cancelling queued loads
+    /// of any other
+    static void SetWanted(const MythUIImage *parent, const QString &basefile)
+    {
+        QMutexLocker locker(&s_wantedLock);
+        s_wanted[parent->m_serial] = basefile;
+    }
+
+    /// Cancels all queued loads for a MythUIImage that is being deleted and
+    /// waits for any that are already running
+    static void Forget(const MythUIImage *parent)
+    {
+        QMutexLocker locker(&s_wantedLock);
+        s_wanted.remove(parent->m_serial);
+        while (s_running.contains(parent->m_serial))
+            s_runningCond.wait(&s_wantedLock);
+    }
+
     void run()
+    {
+        s_wantedLock.lock();
+
+        QHash<uint, QString>::const_iterator it = s_wanted.find(m_serial);
+        if (it == s_wanted.end())
+        {
+            // The image has been deleted
+            s_wantedLock.unlock();
+            return;
+        }
+
+        if (*it != m_basefile)
+        {
+            LOG(VB_GUI | VB_FILE, LOG_DEBUG,
+                QString("ImageLoadThread: Dropping queued load of %1")
+                .arg(m_imageProperties.filename));
+
+            // Posted under the lock, so the image can't be deleted meanwhile
+            ImageLoadEvent *le = new ImageLoadEvent(m_parent, NULL, m_basefile,
+                                                    m_imageProperties.filename,
+                                                    m_number, true);
+            QCoreApplication::postEvent(const_cast<MythUIImage*>(m_parent), le);
+            s_wantedLock.unlock();
+            return;
+        }
+
+        s_running[m_serial]++;
+        s_wantedLock.unlock();
+
+        Load();
+
+        QMutexLocker locker(&s_wantedLock);
+        if (--s_running[m_serial] == 0)
+            s_running.remove(m_serial);
+        s_runningCond.wakeAll();
+    }
+
+  private:
+    void Load(void)
     {
         bool aborted = false;
         QString filename =  m_imageProperties.filename;
@@ -558,8 +634,13 @@ class ImageLoadThread : public QRunnable
         QCoreApplication::postEvent(const_cast<MythUIImage*>(m_parent), le);
     }
 
-private:
+    static QHash<uint, QString> s_wanted;  ///< by MythUIImage serial
+    static QHash<uint, int>     s_running; ///< by MythUIImage serial
+    static QMutex               s_wantedLock;
+    static QWaitCondition       s_runningCond;
+
     const MythUIImage    *m_parent;
+    uint                  m_serial;
     MythPainter       *m_painter;
     ImageProperties m_imageProperties;
     QString         m_basefile;
@@ -567,6 +648,13 @@ private:
     ImageCacheMode  m_cacheMode;
 };
 
+QHash<uint, QString> ImageLoadThread::s_wanted;
+QHash<uint, int>     ImageLoadThread::s_running;
+QMutex               ImageLoadThread::s_wantedLock;
+QWaitCondition       ImageLoadThread::s_runningCond;
+
+static QAtomicInt s_nextImageSerial;
+
 /////////////////////////////////////////////////////////////////
 class MythUIImagePrivate
 {
@@ -632,13 +720,9 @@ MythUIImage::MythUIImage(MythUIType *parent, const QString &name)
 
 MythUIImage::~MythUIImage()
 {
-    // Wait until all image loading threads are complete or bad things
-    // may happen if this MythUIImage disappears when a queued thread
-    // needs it.
-    if (m_runningThreads > 0)
-    {
-        GetMythUI()->GetImageThreadPool()->waitForDone();
-    }
+    // Drop our queued loads and wait for any running ones, or bad things
+    // may happen if this MythUIImage disappears when a thread needs it.
+    ImageLoadThread::Forget(this);
 
     Clear();
 
@@ -709,6 +793,8 @@ void MythUIImage::Reset(void)
  */
 void MythUIImage::Init(void)
 {
+    m_serial = s_nextImageSerial.fetchAndAddOrdered(1);
+
     m_CurPos = 0;
     m_LastDisplay = QTime::currentTime();
 
@@ -718,8 +804,6 @@ void MythUIImage::Init(void)
     m_animationReverse = false;
     m_animatedImage = false;
 
-    m_runningThreads = 0;
-
     m_showingRandomImage = false;
 }
 
@@ -1035,6 +1119,8 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
 
     QString filename = bFilename;
 
+    ImageLoadThread::SetWanted(this, bFilename);
+
     if (bFilename.isEmpty())
     {
         Clear();
@@ -1101,13 +1187,16 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
             LOG(VB_GUI | VB_FILE, LOG_DEBUG, LOC +
                 QString("Load(), spawning thread to load '%1'").arg(filename));
 
-            m_runningThreads++;
+            // Images on screen are loaded before hidden ones
+            int priority = IsVisible(true) ? 0 : 1;
+
             ImageLoadThread *bImgThread;
             bImgThread = new ImageLoadThread(this, GetPainter(),
                                              imProps,
                                              bFilename, i,
                                              static_cast<ImageCacheMode>(cacheMode2));
-            GetMythUI()->GetImageThreadPool()->start(bImgThread, "ImageLoad");
+            GetMythUI()->GetImageThreadPool()->start(bImgThread, "ImageLoad",
+                                                     priority);
         }
         else
         {
@@ -1610,8 +1699,6 @@ void MythUIImage::customEvent(QEvent *event)
         animationFrames = le->GetAnimationFrames();
         aborted         = le->GetAbortState();
 
-        m_runningThreads--;
-
         d->m_UpdateLock.lockForRead();
         QString propFilename = m_imageProperties.filename;
         d->m_UpdateLock.unlock();
@@ -183,7 +183,7 @@ class MUI_PUBLIC MythUIImage : public MythUIType
 
     ImageProperties m_imageProperties;
 
-    int m_runningThreads;
+    uint m_serial; ///< Identifies this image to ImageLoadThread
 
     bool m_showingRandomImage;
     QString m_imageDirectory;
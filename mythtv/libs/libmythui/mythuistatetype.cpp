@@ -234,10 +234,12 @@ bool MythUIStateType::ParseElement(
         else
             statename = name;
 
-        element.setAttribute("name", statename);
-
+        // The element may be a cached theme document's, so it is left as
+        // it is and the name passed on instead
         MythUIGroup *uitype = dynamic_cast<MythUIGroup *>
-                              (ParseUIType(filename, element, "group", this, NULL, showWarnings, dependsMap));
+                              (ParseUIType(filename, element, "group", this,
+                                           NULL, showWarnings, dependsMap,
+                                           statename));
 
         if (!type.isEmpty())
         {
@@ -7,7 +7,11 @@
 
 // QT headers
 #include <QFile>
+#include <QFileInfo>
 #include <QDomDocument>
+#include <QDateTime>
+#include <QCache>
+#include <QMutex>
 #include <QString>
 #include <QBrush>
 #include <QLinearGradient>
@@ -330,6 +334,74 @@ QString XMLParseBase::parseText(QDomElement &element)
 static MythUIType *globalObjectStore = NULL;
 static QStringList loadedBaseFiles;
 
+/// A parsed theme file. Screens are created far more often than themes are
+/// edited, so theme files are only read and parsed again when they change.
+class ThemeFile
+{
+  public:
+    ThemeFile(const QFileInfo &fi, const QDomDocument &doc)
+        : m_modified(fi.lastModified()), m_size(fi.size()), m_doc(doc) {}
+
+    bool IsCurrent(const QFileInfo &fi) const
+    { return m_modified == fi.lastModified() && m_size == fi.size(); }
+
+    QDateTime    m_modified;
+    qint64       m_size;
+    QDomDocument m_doc;
+};
+
+/// Parsed theme files by path, costed by their size in KB
+static QCache<QString, ThemeFile> themeFileCache(2048);
+static QMutex themeFileLock;
+
+/**
+ *  \brief Returns the parsed document of a theme file
+ *
+ *   The document is shared with the cache, which widgets may parse
+ *   repeatedly but must not change.
+ *
+ *  \return false if the file doesn't exist or isn't valid XML
+ */
+static bool LoadThemeFile(const QString &filename, QDomDocument &doc)
+{
+    QFileInfo fi(filename);
+
+    QMutexLocker locker(&themeFileLock);
+
+    ThemeFile *cached = themeFileCache.object(filename);
+    if (cached && cached->IsCurrent(fi))
+    {
+        doc = cached->m_doc;
+        return true;
+    }
+
+    QFile f(filename);
+
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QString errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+
+    if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Location: '%1' @ %2 column: %3"
+                    "\n\t\t\tError: %4")
+                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
+                .arg(qPrintable(errorMsg)));
+        f.close();
+        return false;
+    }
+
+    f.close();
+
+    themeFileCache.insert(filename, new ThemeFile(fi, doc),
+                          qMax(fi.size() / 1024, qint64(1)));
+    return true;
+}
+
 MythUIType *XMLParseBase::GetGlobalObjectStore(void)
 {
     if (!globalObjectStore)
@@ -345,6 +417,10 @@ void XMLParseBase::ClearGlobalObjectStore(void)
 
     // clear any loaded base xml files which will force a reload the next time they are used
     loadedBaseFiles.clear();
+
+    // and any parsed theme files, as the theme may have changed
+    QMutexLocker locker(&themeFileLock);
+    themeFileCache.clear();
 }
 
 void XMLParseBase::ParseChildren(const QString &filename,
@@ -423,9 +499,12 @@ MythUIType *XMLParseBase::ParseUIType(
     MythUIType *parent,
     MythScreenType *screen,
     bool showWarnings,
-    QMap<QString, QString> &parentDependsMap)
+    QMap<QString, QString> &parentDependsMap,
+    const QString &elementName)
 {
-    QString name = element.attribute("name", "");
+    QString name = elementName;
+    if (name.isEmpty())
+        name = element.attribute("name", "");
     if (name.isEmpty())
     {
         VERBOSE_XML(VB_GENERAL, LOG_ERR, filename, element,
@@ -636,28 +715,10 @@ bool XMLParseBase::WindowExists(const QString &xmlfile,
     for (; it != searchpath.end(); ++it)
     {
         QString themefile = *it + xmlfile;
-        QFile f(themefile);
-
-        if (!f.open(QIODevice::ReadOnly))
-            continue;
-
         QDomDocument doc;
-        QString errorMsg;
-        int errorLine = 0;
-        int errorColumn = 0;
 
-        if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Location: '%1' @ %2 column: %3"
-                        "\n\t\t\tError: %4")
-                    .arg(qPrintable(themefile)).arg(errorLine).arg(errorColumn)
-                    .arg(qPrintable(errorMsg)));
-            f.close();
+        if (!LoadThemeFile(themefile, doc))
             continue;
-        }
-
-        f.close();
 
         QDomElement docElem = doc.documentElement();
         QDomNode n = docElem.firstChild();
@@ -718,28 +779,10 @@ bool XMLParseBase::doLoad(const QString &windowname,
                           bool showWarnings)
 {
     QDomDocument doc;
-    QFile f(filename);
 
-    if (!f.open(QIODevice::ReadOnly))
+    if (!LoadThemeFile(filename, doc))
         return false;
 
-    QString errorMsg;
-    int errorLine = 0;
-    int errorColumn = 0;
-
-    if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC +
-            QString("Location: '%1' @ %2 column: %3"
-                    "\n\t\t\tError: %4")
-                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
-                .arg(qPrintable(errorMsg)));
-        f.close();
-        return false;
-    }
-
-    f.close();
-
     QDomElement docElem = doc.documentElement();
     QDomNode n = docElem.firstChild();
     while (!n.isNull())
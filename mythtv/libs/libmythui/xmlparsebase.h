@@ -42,13 +42,15 @@ class MUI_PUBLIC XMLParseBase
         const QString &filename, QDomElement &element,
         MythUIType *parent, bool showWarnings);
 
-    // parse one and return it.
+    // parse one and return it, named by its "name" attribute unless
+    // another name is given.
     static MythUIType *ParseUIType(
         const QString &filename,
         QDomElement &element, const QString &type,
         MythUIType *parent, MythScreenType *screen,
         bool showWarnings,
-        QMap<QString, QString> &parentDependsMap);
+        QMap<QString, QString> &parentDependsMap,
+        const QString &elementName = QString());
 
     static bool WindowExists(const QString &xmlfile, const QString &windowname);
     static bool LoadWindowFromXML(const QString &xmlfile,
@@ -0,0 +1,268 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkedstream.cpp
+//
+// Purpose     : Streams a response body using chunked transfer encoding
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httpchunkedstream.h"
+#include "httprequest.h"
+
+#include <zlib.h>
+
+#include "mythlogging.h"
+
+#define LOC QString("HTTPChunkedStream: ")
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedStream::HTTPChunkedStream( HTTPRequest *pRequest, bool bCompress )
+                 : m_pRequest  ( pRequest  ),
+                   m_bCompress ( bCompress ),
+                   m_bStarted  ( false     ),
+                   m_bFinished ( false     ),
+                   m_bFailed   ( false     ),
+                   m_pZStream  ( NULL      ),
+                   m_nBytesSent( 0         )
+{
+    open( QIODevice::WriteOnly );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedStream::~HTTPChunkedStream()
+{
+    if (m_pZStream != NULL)
+    {
+        deflateEnd( m_pZStream );
+        delete m_pZStream;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+QByteArray HTTPChunkedStream::TakeBuffer()
+{
+    QByteArray buffer = m_buffer;
+
+    m_buffer.clear();
+
+    return buffer;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void HTTPChunkedStream::SetTrailer( const QString &sName, const QString &sValue )
+{
+    m_trailer += QString( "%1: %2\r\n" ).arg( sName ).arg( sValue ).toUtf8();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedStream::writeData( const char *pData, qint64 nLen )
+{
+    // Once the socket has failed there's nobody to send to, so just swallow
+    // the rest of the serializer's output rather than buffering it.
+
+    if (m_bFailed || m_bFinished)
+        return nLen;
+
+    m_buffer.append( pData, nLen );
+
+    if (!m_bStarted)
+    {
+        if (m_buffer.size() < kStartThreshold)
+            return nLen;
+
+        if (!Start())
+            return nLen;
+    }
+
+    if (m_buffer.size() >= kChunkSize)
+        Flush( false );
+
+    return nLen;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedStream::Finish()
+{
+    if (!m_bStarted)
+        return 0;
+
+    if (!m_bFinished && !m_bFailed)
+    {
+        m_bFinished = true;
+
+        if (Flush( true ))
+            WriteLastChunk();
+
+        LOG(VB_HTTP, LOG_DEBUG, LOC + QString("Sent %1 bytes%2")
+                .arg(m_nBytesSent).arg(m_bCompress ? " (gzip)" : ""));
+    }
+
+    return m_bFailed ? -1 : m_nBytesSent;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::Start()
+{
+    m_bStarted = true;
+
+    if (m_bCompress)
+    {
+        m_pZStream = new z_stream;
+
+        m_pZStream->zalloc = Z_NULL;
+        m_pZStream->zfree  = Z_NULL;
+        m_pZStream->opaque = Z_NULL;
+
+        if (deflateInit2( m_pZStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                          15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK) // gzip
+        {
+            LOG(VB_HTTP, LOG_WARNING, LOC +
+                "deflateInit2 failed, sending uncompressed");
+
+            delete m_pZStream;
+            m_pZStream  = NULL;
+            m_bCompress = false;
+        }
+    }
+
+    qint64 nBytes = m_pRequest->SendChunkedHeader( m_bCompress );
+
+    if (nBytes < 0)
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + "Error writing response header");
+        m_bFailed = true;
+        m_buffer.clear();
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::Flush( bool bFinish )
+{
+    if (!m_bCompress)
+    {
+        bool bOk = m_buffer.isEmpty() || WriteChunk( m_buffer );
+
+        m_buffer.clear();
+
+        return bOk;
+    }
+
+    char out[ kChunkSize ];
+
+    m_pZStream->next_in  = (Bytef*)m_buffer.data();
+    m_pZStream->avail_in = m_buffer.size();
+
+    do
+    {
+        m_pZStream->next_out  = (Bytef*)out;
+        m_pZStream->avail_out = sizeof(out);
+
+        deflate( m_pZStream, bFinish ? Z_FINISH : Z_NO_FLUSH );
+
+        m_chunk.append( out, sizeof(out) - m_pZStream->avail_out );
+
+        if (m_chunk.size() >= kChunkSize)
+        {
+            if (!WriteChunk( m_chunk ))
+                return false;
+
+            m_chunk.clear();
+        }
+    }
+    while (m_pZStream->avail_out == 0);
+
+    m_buffer.clear();
+
+    if (bFinish && !m_chunk.isEmpty())
+    {
+        if (!WriteChunk( m_chunk ))
+            return false;
+
+        m_chunk.clear();
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// An empty chunk is the terminator, followed by any trailer fields
+// (RFC 7230 section 4.1)
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::WriteLastChunk()
+{
+    QByteArray chunk = "0\r\n" + m_trailer + "\r\n";
+
+    qint64 nBytes = m_pRequest->WriteBlock( chunk.constData(), chunk.size() );
+
+    if (nBytes != chunk.size())
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + "Error writing the last chunk");
+        m_bFailed = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::WriteChunk( const QByteArray &data )
+{
+    QByteArray chunk = QByteArray::number( data.size(), 16 );
+
+    chunk.reserve( chunk.size() + data.size() + 6 );
+    chunk += "\r\n";
+    chunk += data;
+    chunk += "\r\n";
+
+    qint64 nBytes = m_pRequest->WriteBlock( chunk.constData(), chunk.size() );
+
+    if (nBytes != chunk.size())
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + QString("Incomplete write, %1 of %2")
+                .arg(nBytes).arg(chunk.size()));
+        m_bFailed = true;
+        m_buffer.clear();
+        m_chunk.clear();
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
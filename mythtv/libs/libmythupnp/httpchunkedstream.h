@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkedstream.h
+//
+// Purpose     : Streams a response body using chunked transfer encoding
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPCHUNKEDSTREAM_H_
+#define HTTPCHUNKEDSTREAM_H_
+
+#include <QIODevice>
+#include <QByteArray>
+
+class HTTPRequest;
+struct z_stream_s;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Write only device handed to a Serializer in place of the request's response
+// buffer.  Output is held in memory until it passes kStartThreshold; a
+// response that never gets that big is given back to HTTPRequest untouched
+// so it still gets a Content-Length, an ETag and 304 handling.  Past the
+// threshold the header is sent with "Transfer-Encoding: chunked" and the body
+// follows in chunks of about kChunkSize, gzip'd on the fly if the client
+// accepts it, so memory use per request stays bounded however large the
+// result is.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+class HTTPChunkedStream : public QIODevice
+{
+    public:
+
+        static const int kStartThreshold = 128 * 1024;
+        static const int kChunkSize      =  32 * 1024;
+
+                 HTTPChunkedStream( HTTPRequest *pRequest, bool bCompress );
+        virtual ~HTTPChunkedStream();
+
+        virtual bool isSequential() const { return true; }
+
+        bool        IsStarted  () const { return m_bStarted; }
+        QByteArray  TakeBuffer ();
+
+        // Sent after the last chunk, must have been announced in the
+        // "Trailer" header
+        void        SetTrailer ( const QString &sName, const QString &sValue );
+
+        // Writes the remaining data and the terminating chunk. Returns the
+        // total bytes written to the socket, or -1 on a write error.
+        qint64      Finish     ();
+
+    protected:
+
+        virtual qint64 readData ( char *, qint64 ) { return -1; }
+        virtual qint64 writeData( const char *pData, qint64 nLen );
+
+    private:
+
+        bool        Start      ();
+        bool        Flush      ( bool bFinish );
+        bool        WriteChunk ( const QByteArray &data );
+        bool        WriteLastChunk ();
+
+        HTTPRequest        *m_pRequest;
+        bool                m_bCompress;
+        bool                m_bStarted;
+        bool                m_bFinished;
+        bool                m_bFailed;
+
+        QByteArray          m_buffer;   // Not yet compressed
+        QByteArray          m_chunk;    // Compressed, not yet sent
+        QByteArray          m_trailer;  // Header lines after the last chunk
+        struct z_stream_s  *m_pZStream;
+
+        qint64              m_nBytesSent;
+};
+
+#endif
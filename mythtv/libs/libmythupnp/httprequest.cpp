@@ -11,6 +11,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "httprequest.h"
+#include "httpchunkedstream.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -36,6 +37,7 @@
 
 #ifndef _WIN32
 #include <netinet/tcp.h>
+#include <poll.h>
 #endif
 
 #include "upnp.h"
@@ -47,6 +49,7 @@
 #include "mythcorecontext.h"
 #include "mythtimer.h"
 #include "mythcoreutil.h"
+#include "filereadcache.h"
 
 #include "serializers/xmlSerializer.h"
 #include "serializers/soapSerializer.h"
@@ -170,6 +173,7 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_bSOAPRequest   ( false ),
                              m_eResponseType  ( ResponseTypeUnknown),
                              m_nResponseStatus( 200 ),
+                             m_pChunkedStream ( NULL ),
                              m_pPostProcess   ( NULL ),
                              m_bKeepAlive     ( true ),
                              m_nKeepAliveTimeout ( 0 )
@@ -181,6 +185,15 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    delete m_pChunkedStream;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 RequestType HTTPRequest::SetRequestType( const QString &sType )
 {
     // HTTP
@@ -251,7 +264,10 @@ QString HTTPRequest::BuildResponseHeader( long long nSize )
             SetResponseHeader("Content-Disposition", QString("inline; filename=\"%2\"").arg(QString(filename.toLatin1())));
         }
 
-        SetResponseHeader("Content-Length", QString::number(nSize));
+        if (nSize < 0)
+            SetResponseHeader("Transfer-Encoding", "chunked");
+        else
+            SetResponseHeader("Content-Length", QString::number(nSize));
 
         // See DLNA  7.4.1.3.11.4.3 Tolerance to unavailable contentFeatures.dlna.org header
         //
@@ -319,6 +335,15 @@ qint64 HTTPRequest::SendResponse( void )
 {
     qint64      nBytes    = 0;
 
+    // The header and most of the body have already gone out
+    if (m_pChunkedStream != NULL && m_pChunkedStream->IsStarted())
+    {
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponse( Chunked ) :%1 -> %2:")
+                .arg(GetResponseStatus()) .arg(GetPeerAddress()));
+        return m_pChunkedStream->Finish();
+    }
+
     switch( m_eResponseType )
     {
         // The following are all eligable for gzip compression
@@ -722,11 +747,146 @@ qint64 HTTPRequest::SendData( QIODevice *pDevice, qint64 llStart, qint64 llBytes
 
 qint64 HTTPRequest::SendFile( QFile &file, qint64 llStart, qint64 llBytes )
 {
-    qint64 sent = SendData( (QIODevice *)(&file), llStart, llBytes );
+    if (!file.isOpen() && !file.open( QIODevice::ReadOnly ))
+        return -1;
+
+    // ----------------------------------------------------------------------
+    // Clients streaming the same file share one read-ahead, so the disk
+    // isn't seeking between them. Whether anyone else is reading it can
+    // change as we go, so it's checked for every block.
+    // ----------------------------------------------------------------------
+
+    FileReadCache *pCache    = FileReadCache::GetSingleton();
+    QString        sCacheKey = pCache->AddReader( file.fileName(),
+                                                 file.handle() );
+    qint64         llBlock   = pCache->GetChunkSize();
+    qint64         sent      = 0;
+
+    while (sent < llBytes)
+    {
+        qint64 llCount = std::min( llBytes - sent, llBlock );
+        qint64 nSent;
+
+        if (pCache->IsShared( sCacheKey ))
+            nSent = SendFileCached( file, sCacheKey, llStart + sent, llCount );
+        else
+            nSent = SendFileDirect( file, llStart + sent, llCount );
+
+        if (nSent < 0)
+        {
+            sent = -1;
+            break;
+        }
+
+        sent += nSent;
+
+        if (nSent < llCount)    // The file is shorter than we were told
+            break;
+    }
+
+    pCache->RemoveReader( sCacheKey );
 
     return( sent );
 }
 
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPRequest::SendFileDirect( QFile &file, qint64 llStart, qint64 llBytes )
+{
+#ifdef USE_SETSOCKOPT
+    // ----------------------------------------------------------------------
+    // Plain sockets can have the kernel copy the file straight from the
+    // page cache, rather than reading it through a buffer here.
+    // ----------------------------------------------------------------------
+
+    int nSocket = getSocketHandle();
+
+    if (!m_bEncrypted && (nSocket >= 0) && (file.handle() >= 0) &&
+        FlushBlock( 5000 ))
+    {
+        off_t  offset = llStart;
+        qint64 sent   = 0;
+
+        while (sent < llBytes)
+        {
+            ssize_t nSent = sendfile( nSocket, file.handle(), &offset,
+                                      llBytes - sent );
+
+            if (nSent > 0)
+            {
+                sent += nSent;
+                continue;
+            }
+
+            if (nSent == 0)     // The file is shorter than we were told
+                break;
+
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Same idle allowance as the worker gives writes
+
+                struct pollfd polls;
+                polls.fd      = nSocket;
+                polls.events  = POLLOUT;
+                polls.revents = 0;
+
+                if (poll( &polls, 1, 5000 ) > 0 && !(polls.revents & POLLERR))
+                    continue;
+
+                return -1;
+            }
+
+            // Not supported for this file, fall back to copying it ourselves
+
+            if (sent == 0 && (errno == EINVAL || errno == ENOSYS))
+                break;
+
+            return -1;
+        }
+
+        if (sent > 0 || llBytes == 0)
+            return sent;
+    }
+#endif
+
+    return SendData( (QIODevice *)(&file), llStart, llBytes );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPRequest::SendFileCached( QFile &file, const QString &sCacheKey,
+                                    qint64 llStart, qint64 llBytes )
+{
+    char   aBuffer[ SENDFILE_BUFFER_SIZE ];
+    qint64 sent = 0;
+
+    while (sent < llBytes)
+    {
+        qint64 llCount = std::min( (qint64)SENDFILE_BUFFER_SIZE, llBytes - sent );
+        qint64 llRead  = FileReadCache::GetSingleton()->Read(
+            sCacheKey, file.handle(), llStart + sent, aBuffer, llCount );
+
+        if (llRead < 0)
+            return (sent > 0) ? sent : -1;
+
+        if (llRead == 0)
+            break;
+
+        if (WriteBlock( aBuffer, llRead ) == -1)
+            return -1;
+
+        sent += llRead;
+    }
+
+    return sent;
+}
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -776,6 +936,23 @@ void HTTPRequest::FormatActionResponse( Serializer *pSer )
     m_sResponseTypeText = pSer->GetContentType();
     m_nResponseStatus   = 200;
 
+    if (m_pChunkedStream != NULL)
+    {
+        // Already streaming. The body wasn't hashed until after the header
+        // went out, so the ETag follows it as a trailer, unless the service
+        // set its own, which went out with the header.
+
+        if (m_pChunkedStream->IsStarted())
+        {
+            if (!m_mapRespHeaders.contains( "ETag" ))
+                m_pChunkedStream->SetTrailer( "ETag", pSer->GetETag() );
+            return;
+        }
+
+        // Small enough to send the usual way
+        m_response.buffer() = m_pChunkedStream->TakeBuffer();
+    }
+
     pSer->AddHeaders( m_mapRespHeaders );
 
     //m_response << pFormatter->ToString();
@@ -1757,32 +1934,100 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 Serializer *HTTPRequest::GetSerializer()
 {
     Serializer *pSerializer = NULL;
+    QIODevice  *pDevice     = &m_response;
+
+    if (CanStreamResponse())
+    {
+        m_pChunkedStream = new HTTPChunkedStream( this,
+                              m_mapHeaders[ "accept-encoding" ].contains( "gzip" ));
+        pDevice = m_pChunkedStream;
+    }
 
     if (m_bSOAPRequest)
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetRequestHeader( "Accept", "*/*" );
 
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
+
+    // The stream may need to send the header part way through Serialize()
+
+    if (m_pChunkedStream != NULL)
+    {
+        m_eResponseType     = ResponseTypeOther;
+        m_sResponseTypeText = pSerializer->GetContentType();
+        m_nResponseStatus   = 200;
+
+        pSerializer->AddCacheControl( m_mapRespHeaders );
+    }
 
     return pSerializer;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Chunked encoding needs HTTP/1.1, and there's no ETag to match against
+// until the whole body has been serialized.  SOAP clients are mostly
+// embedded UPnP devices, so they keep getting a Content-Length.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::CanStreamResponse()
+{
+    if (m_pChunkedStream != NULL || m_bSOAPRequest)
+        return false;
+
+    if (m_eType == RequestTypeHead)
+        return false;
+
+    if (m_nMajor < 1 || (m_nMajor == 1 && m_nMinor < 1))
+        return false;
+
+    // Revalidation needs the ETag before the body is sent, so that a 304
+    // can be sent instead.
+    if (!GetRequestHeader( "If-None-Match", "" ).isEmpty())
+        return false;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPRequest::SendChunkedHeader( bool bCompressed )
+{
+    if (bCompressed)
+        SetResponseHeader( "Content-Encoding", "gzip" );
+
+    // The ETag is only known once the body has been serialized, unless
+    // the service has already given one
+    if (!m_mapRespHeaders.contains( "ETag" ))
+        SetResponseHeader( "Trailer", "ETag" );
+
+    QByteArray sHeader = BuildResponseHeader( -1 ).toUtf8();
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("Response header size: %1 bytes")
+            .arg(sHeader.length()));
+
+    qint64 nBytes = WriteBlock( sHeader.constData(), sHeader.length() );
+
+    return (nBytes == sHeader.length()) ? nBytes : -1;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -2454,6 +2699,25 @@ qint64 BufferedSocketDeviceRequest::WriteBlock(const char *pData, qint64 nLen)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool BufferedSocketDeviceRequest::FlushBlock( int msecs )
+{
+    if (!m_pSocket || !m_pSocket->isValid() ||
+        m_pSocket->state() != QAbstractSocket::ConnectedState)
+        return false;
+
+    while (m_pSocket->bytesToWrite() > 0)
+    {
+        if (!m_pSocket->waitForBytesWritten( msecs ))
+            return false;
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString BufferedSocketDeviceRequest::GetHostAddress()
 {
     return( m_pSocket->localAddress().toString() );
@@ -26,6 +26,8 @@
 #include "upnputil.h"
 #include "serializers/serializer.h"
 
+class HTTPChunkedStream;
+
 #define SOAP_ENVELOPE_BEGIN  "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" " \
                              "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"     \
                              "<s:Body>"
@@ -104,6 +106,8 @@ class IPostProcess
 
 class UPNP_PUBLIC HTTPRequest
 {
+    friend class HTTPChunkedStream;
+
     protected:
 
         static const char  *m_szServerHeaders;
@@ -152,6 +156,10 @@ class UPNP_PUBLIC HTTPRequest
 
         QBuffer             m_response;
 
+        // Set by GetSerializer() when a large action response may be
+        // streamed instead of being built up in m_response
+        HTTPChunkedStream  *m_pChunkedStream;
+
         IPostProcess       *m_pPostProcess;
 
         QString             m_sPrivateToken;
@@ -186,9 +194,14 @@ class UPNP_PUBLIC HTTPRequest
         void            ParseCookies        ( void );
 
         QString         BuildResponseHeader ( long long nSize );
+        qint64          SendChunkedHeader   ( bool bCompressed );
+        bool            CanStreamResponse   ();
 
         qint64          SendData            ( QIODevice *pDevice, qint64 llStart, qint64 llBytes );
         qint64          SendFile            ( QFile &file, qint64 llStart, qint64 llBytes );
+        qint64          SendFileDirect      ( QFile &file, qint64 llStart, qint64 llBytes );
+        qint64          SendFileCached      ( QFile &file, const QString &sCacheKey,
+                                              qint64 llStart, qint64 llBytes );
 
         bool            IsProtected         () const { return m_bProtected; }
         bool            IsEncrypted         () const { return m_bEncrypted; }
@@ -204,7 +217,7 @@ class UPNP_PUBLIC HTTPRequest
     public:
 
                         HTTPRequest     ();
-        virtual        ~HTTPRequest     () {};
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
@@ -259,6 +272,9 @@ class UPNP_PUBLIC HTTPRequest
         virtual qint64  ReadBlock       ( char *pData, qint64 nMaxLen, int msecs = 0 ) = 0;
         virtual qint64  WriteBlock      ( const char *pData,
                                           qint64 nLen    ) = 0;
+        // Waits for everything written so far to reach the socket, so it
+        // can be written to directly. Returns false if that isn't possible.
+        virtual bool    FlushBlock      ( int /* msecs */ ) { return false; }
         virtual QString  GetHostName     ();  // RFC 3875 - The name in the client request
         virtual QString  GetHostAddress  () = 0;
         virtual quint16  GetHostPort     () = 0;
@@ -284,6 +300,7 @@ class BufferedSocketDeviceRequest : public HTTPRequest
         virtual QString  ReadLine        ( int msecs );
         virtual qint64   ReadBlock       ( char *pData, qint64 nMaxLen, int msecs = 0  );
         virtual qint64   WriteBlock      ( const char *pData, qint64 nLen    );
+        virtual bool     FlushBlock      ( int msecs );
         virtual QString  GetHostAddress  ();
         virtual quint16  GetHostPort     ();
         virtual QString  GetPeerAddress  ();
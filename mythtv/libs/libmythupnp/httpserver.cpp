@@ -22,10 +22,14 @@
 #include <compat.h>
 #ifndef _WIN32
 #include <sys/utsname.h> 
+#include <unistd.h>
 #endif
 
 // Qt headers
+#include <QSocketNotifier>
 #include <QScriptEngine>
+#include <QDateTime>
+#include <QTimer>
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QSslCipher>
@@ -117,7 +121,8 @@ QString  HttpServer::s_platform;
 HttpServer::HttpServer() :
     ServerPool(), m_sSharePath(GetShareDir()),
     m_threadPool("HttpServerPool"), m_running(true),
-    m_privateToken(QUuid::createUuid().toString()) // Cryptographically random and sufficiently long enough to act as a secure token
+    m_privateToken(QUuid::createUuid().toString()), // Cryptographically random and sufficiently long enough to act as a secure token
+    m_parkedTimer(new QTimer(this))
 {
     // Number of connections processed concurrently
     int maxHttpWorkers = max(QThread::idealThreadCount() * 2, 2); // idealThreadCount can return -1
@@ -162,6 +167,9 @@ HttpServer::HttpServer() :
     RegisterExtension( new RttiServiceHost( m_sSharePath ));
 
     LoadSSLConfig();
+
+    m_parkedTimer->setInterval(1000);
+    connect(m_parkedTimer, SIGNAL(timeout()), SLOT(ExpireConnections()));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -176,6 +184,9 @@ HttpServer::~HttpServer()
 
     m_threadPool.Stop();
 
+    while (!m_parkedNotifiers.isEmpty())
+        CloseParkedConnection(m_parkedNotifiers.begin().key());
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -323,6 +334,116 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+void HttpServer::ParkConnection(int socket, int timeout)
+{
+    if (!IsRunning() || m_parkedNotifiers.contains(socket))
+    {
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+        return;
+    }
+
+    QSocketNotifier *notifier =
+        new QSocketNotifier(socket, QSocketNotifier::Read, this);
+    connect(notifier, SIGNAL(activated(int)), SLOT(ResumeConnection(int)));
+
+    m_parkedNotifiers.insert(socket, notifier);
+    m_parkedExpiry.insert(socket,
+                          QDateTime::currentMSecsSinceEpoch() + timeout);
+
+    if (!m_parkedTimer->isActive())
+        m_parkedTimer->start();
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("HttpServer: Parked connection %1, "
+                                    "%2 idle").arg(socket)
+                                              .arg(m_parkedNotifiers.size()));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// The next request (or the client closing the connection) has arrived, hand
+// the connection back to a worker.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ResumeConnection(int socket)
+{
+    QSocketNotifier *notifier = m_parkedNotifiers.take(socket);
+    m_parkedExpiry.remove(socket);
+
+    if (!notifier)
+        return;
+
+    notifier->setEnabled(false);
+    notifier->deleteLater();
+
+    m_threadPool.startReserved(
+        new HttpWorker(*this, socket, kTCPServer
+#ifndef QT_NO_OPENSSL
+                       , m_sslConfig
+#endif
+                       ),
+        QString("HttpServer%1").arg(socket));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ExpireConnections(void)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QList<int> expired;
+
+    QHash<int, qint64>::const_iterator it = m_parkedExpiry.constBegin();
+    for (; it != m_parkedExpiry.constEnd(); ++it)
+    {
+        if (it.value() <= now)
+            expired.append(it.key());
+    }
+
+    QList<int>::const_iterator eit = expired.constBegin();
+    for (; eit != expired.constEnd(); ++eit)
+    {
+        LOG(VB_HTTP, LOG_INFO, QString("HttpServer: Idle connection %1 "
+                                       "timed out").arg(*eit));
+        CloseParkedConnection(*eit);
+    }
+
+    if (m_parkedNotifiers.isEmpty())
+        m_parkedTimer->stop();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::CloseParkedConnection(int socket)
+{
+    QSocketNotifier *notifier = m_parkedNotifiers.take(socket);
+    m_parkedExpiry.remove(socket);
+
+    if (notifier)
+    {
+        notifier->setEnabled(false);
+        delete notifier;
+    }
+
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void HttpServer::RegisterExtension( HttpServerExtension *pExtension )
 {
     if (pExtension != NULL )
@@ -479,6 +600,7 @@ void HttpWorker::run(void)
 
     bool                    bTimeout   = false;
     bool                    bKeepAlive = true;
+    bool                    bPark      = false;
     HTTPRequest            *pRequest   = NULL;
     QTcpSocket             *pSocket;
     bool                    bEncrypted = false;
@@ -541,6 +663,19 @@ void HttpWorker::run(void)
         while (m_httpServer.IsRunning() && bKeepAlive && pSocket->isValid() &&
                pSocket->state() == QAbstractSocket::ConnectedState)
         {
+#ifndef _WIN32
+            // Rather than wait here for the next request on a keep-alive
+            // connection, hand it back to the server to watch so idle
+            // clients don't hold a pool thread. Encrypted connections have
+            // their state in the QSslSocket, so they stay with us.
+            if (nRequestsHandled > 0 && !bEncrypted &&
+                pSocket->bytesAvailable() == 0)
+            {
+                bPark = true;
+                break;
+            }
+#endif
+
             // We set a timeout on keep-alive connections to avoid blocking
             // new clients from connecting - Default at time of writing was
             // 5 seconds for initial connection, then up to 10 seconds of idle
@@ -687,6 +822,29 @@ void HttpWorker::run(void)
                                             .arg(pSocket->errorString()));
     }
 
+#ifndef _WIN32
+    if (bPark && m_httpServer.IsRunning() && pSocket->isValid() &&
+        pSocket->state() == QAbstractSocket::ConnectedState &&
+        pSocket->bytesToWrite() == 0)
+    {
+        // The server gets its own descriptor, ours is closed with pSocket
+        int socket = dup(pSocket->socketDescriptor());
+
+        if (socket >= 0)
+        {
+            QMetaObject::invokeMethod(&m_httpServer, "ParkConnection",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(int, socket),
+                                      Q_ARG(int, m_socketTimeout));
+
+            LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection idle "
+                                           "after %2 requests, parked")
+                                        .arg(m_socket)
+                                        .arg(nRequestsHandled));
+        }
+    }
+#endif
+
     LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
                                         .arg(m_socket)
                                         .arg(pSocket->socketDescriptor())
@@ -28,6 +28,7 @@
 #include <QPointer>
 #include <QMutex>
 #include <QList>
+#include <QHash>
 
 #include <QSslConfiguration>
 #include <QSslError>
@@ -46,6 +47,8 @@ typedef struct timeval  TaskTime;
 
 class HttpWorkerThread;
 class QScriptEngine;
+class QSocketNotifier;
+class QTimer;
 class HttpServer;
 #ifndef QT_NO_OPENSSL
 class QSslKey;
@@ -162,8 +165,31 @@ class UPNP_PUBLIC HttpServer : public ServerPool
   protected slots:
     virtual void newTcpConnection(qt_socket_fd_t socket); // QTcpServer
 
+  public slots:
+    /**
+     * \brief Wait for the next request on an idle keep-alive connection
+     *
+     * Called by an HttpWorker when a request has been answered, so the
+     * connection is watched from our event loop rather than holding a pool
+     * thread. Takes ownership of the socket.
+     *
+     * \param socket  Descriptor of the connection
+     * \param timeout Milliseconds to wait before closing it
+     */
+    void ParkConnection(int socket, int timeout);
+
+  private slots:
+    void ResumeConnection(int socket);
+    void ExpireConnections(void);
+
   private:
     void LoadSSLConfig();
+    void CloseParkedConnection(int socket);
+
+    // Idle keep-alive connections, only used from our own thread
+    QHash<int, QSocketNotifier*> m_parkedNotifiers;
+    QHash<int, qint64>           m_parkedExpiry; // msecs since epoch
+    QTimer                      *m_parkedTimer;
 };
 
 /////////////////////////////////////////////////////////////////////////////
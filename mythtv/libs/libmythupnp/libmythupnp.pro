@@ -27,7 +27,7 @@ HEADERS += configuration.h
 HEADERS += soapclient.h mythxmlclient.h mmembuf.h upnpexp.h
 HEADERS += upnpserviceimpl.h
 HEADERS += servicehost.h wsdl.h htmlserver.h serverSideScripting.h xsd.h
-HEADERS += upnphelpers.h websocket.h
+HEADERS += upnphelpers.h websocket.h httpchunkedstream.h
 
 HEADERS += services/rtti.h
 HEADERS += serviceHosts/rttiServiceHost.h
@@ -50,7 +50,7 @@ SOURCES += configuration.cpp soapclient.cpp mythxmlclient.cpp mmembuf.cpp
 SOURCES += upnpserviceimpl.cpp
 SOURCES += htmlserver.cpp serverSideScripting.cpp
 SOURCES += servicehost.cpp wsdl.cpp upnpsubscription.cpp xsd.cpp
-SOURCES += upnphelpers.cpp websocket.cpp
+SOURCES += upnphelpers.cpp websocket.cpp httpchunkedstream.cpp
 
 SOURCES += services/rtti.cpp
 
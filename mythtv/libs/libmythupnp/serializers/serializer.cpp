@@ -14,17 +14,42 @@
 
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QMetaClassInfo>
+#include <QReadWriteLock>
+#include <QStringList>
+
+// Metaobjects are static, so the cache is never pruned.
+static QReadWriteLock                                          s_metaLock;
+static QHash< const QMetaObject *, const SerializerMetaInfo * > s_metaCache;
 
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
 
 void Serializer::AddHeaders( QStringMap &headers )
+{
+    AddCacheControl( headers );
+
+    headers[ "ETag" ] = GetETag();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void Serializer::AddCacheControl( QStringMap &headers )
 {
     headers[ "Cache-Control" ] = "no-cache=\"Ext\", "
                                  "max-age = 7200"; // 2 hours
-    
-    headers[ "ETag" ] = "\"" + m_hash.result().toHex() + "\"";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Only valid once Serialize() has finished
+//////////////////////////////////////////////////////////////////////////////
+
+QString Serializer::GetETag()
+{
+    return "\"" + m_hash.result().toHex() + "\"";
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -103,41 +128,27 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != NULL)
     {
-        const QMetaObject *pMetaObject = pObject->metaObject();
+        const QMetaObject        *pMetaObject = pObject->metaObject();
+        const SerializerMetaInfo *pInfo       = GetMetaInfo( pMetaObject );
 
-        int nCount = pMetaObject->propertyCount();
+        QList< SerializerProperty >::const_iterator it;
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        for (it = pInfo->properties.begin(); it != pInfo->properties.end(); ++it)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            if (!it->metaProp.isDesignable( pObject ))
+                continue;
+
+            QVariant value( it->metaProp.read( pObject ));
 
-            if (metaProperty.isDesignable( pObject ))
+            if (!it->bTransient)
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
-
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-                
-                bool bHash = false;
-
-                if (ReadPropertyMetadata( pObject, 
-                                          sPropName, 
-                                          "transient").toLower() != "true" )
-                {
-                    bHash = true;
-                    m_hash.addData( sPropName.toUtf8() );
-                }
-
-                QVariant value( pObject->property( pszPropName ) );
-
-                if (bHash && !value.canConvert< QObject* >()) 
-                {
-                    m_hash.addData( value.toString().toUtf8() );
-                }
+                m_hash.addData( it->sName.toUtf8() );
 
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                if (!value.canConvert< QObject* >())
+                    m_hash.addData( value.toString().toUtf8() );
             }
+
+            AddProperty( it->sName, value, pMetaObject, &(it->metaProp) );
         }
     }
 }
@@ -152,26 +163,98 @@ QString Serializer::ReadPropertyMetadata( const QObject *pObject,
 {
     const QMetaObject *pMeta = pObject->metaObject();
 
-    int nIdx = -1;
+    if (pMeta == NULL)
+        return QString();
+
+    return GetMetaInfo( pMeta )->options.value( sPropName ).value( sKey );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+const SerializerMetaInfo *Serializer::GetMetaInfo( const QMetaObject *pMeta )
+{
+    s_metaLock.lockForRead();
+    const SerializerMetaInfo *pInfo = s_metaCache.value( pMeta, NULL );
+    s_metaLock.unlock();
+
+    if (pInfo != NULL)
+        return pInfo;
+
+    // ----------------------------------------------------------------------
+    // First time this class has been seen, build its metadata.
+    // ----------------------------------------------------------------------
 
-    if (pMeta)
-        nIdx = pMeta->indexOfClassInfo( sPropName.toUtf8());
+    SerializerMetaInfo *pNew = new SerializerMetaInfo;
 
-    if (nIdx >=0)
+    // A derived class's classinfo overrides its base classes', as with
+    // QMetaObject::indexOfClassInfo(), so walk them from the most derived.
+
+    for (int nIdx = pMeta->classInfoCount() - 1; nIdx >= 0; --nIdx)
     {
-        QString     sMetadata = pMeta->classInfo( nIdx ).value();
-        QStringList sOptions  = sMetadata.split( ';' );
+        QMetaClassInfo info     = pMeta->classInfo( nIdx );
+        QString        sName    = info.name();
+
+        if (pNew->options.contains( sName ))
+            continue;
+
+        QStringList    sOptions = QString( info.value() ).split( ';' );
+        QStringMap    &options  = pNew->options[ sName ];
 
-        QString     sFullKey  = sKey + "=";
+        if (sName == "version")
+            pNew->sVersion = info.value();
 
-        for (int nIdx = 0; nIdx < sOptions.size(); ++nIdx)
+        for (int nOpt = 0; nOpt < sOptions.size(); ++nOpt)
         {
-            if (sOptions.at( nIdx ).startsWith( sFullKey ))
-                return sOptions.at( nIdx ).mid( sFullKey.length() );
+            int nPos = sOptions.at( nOpt ).indexOf( '=' );
+
+            if (nPos < 0)
+                continue;
+
+            // Within one entry the first occurrence of a key wins, as the
+            // old linear search did.
+
+            QString sKey = sOptions.at( nOpt ).left( nPos );
+
+            if (!options.contains( sKey ))
+                options.insert( sKey, sOptions.at( nOpt ).mid( nPos + 1 ));
         }
     }
 
-    return QString();
-}
+    for (int nIdx = 0; nIdx < pMeta->propertyCount(); ++nIdx)
+    {
+        SerializerProperty prop;
 
+        prop.metaProp = pMeta->property( nIdx );
+        prop.sName    = prop.metaProp.name();
 
+        if (prop.sName.compare( "objectName" ) == 0)
+            continue;
+
+        prop.bTransient = pNew->options.value( prop.sName )
+                                       .value( "transient" ).toLower() == "true";
+
+        pNew->properties.append( prop );
+    }
+
+    // ----------------------------------------------------------------------
+    // Another thread may have beaten us to it.
+    // ----------------------------------------------------------------------
+
+    s_metaLock.lockForWrite();
+
+    pInfo = s_metaCache.value( pMeta, NULL );
+
+    if (pInfo == NULL)
+    {
+        s_metaCache.insert( pMeta, pNew );
+        pInfo = pNew;
+    }
+    else
+        delete pNew;
+
+    s_metaLock.unlock();
+
+    return pInfo;
+}
@@ -17,9 +17,36 @@
 #include "upnputil.h"
 
 #include <QList>
+#include <QHash>
 #include <QMetaType>
+#include <QMetaProperty>
 #include <QCryptographicHash>
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// Introspection results for one QMetaObject.  Reading property names and
+// parsing Q_CLASSINFO strings for every element of a large list dominates
+// serialization time, so this is built once per class and shared (read only)
+// by all serializers on all threads.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct SerializerProperty
+{
+    QMetaProperty   metaProp;
+    QString         sName;
+    bool            bTransient;
+};
+
+class SerializerMetaInfo
+{
+    public:
+
+        QList< SerializerProperty >     properties; // excludes objectName
+        QHash< QString, QStringMap >    options;    // Q_CLASSINFO "key=value;..."
+        QString                         sVersion;   // Null if no "version"
+};
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -54,6 +81,8 @@ class UPNP_PUBLIC Serializer
                                                  QString  sPropName, 
                                                  QString  sKey );
 
+        static const SerializerMetaInfo *GetMetaInfo( const QMetaObject *pMeta );
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
@@ -65,6 +94,8 @@ class UPNP_PUBLIC Serializer
 
         virtual QString GetContentType () = 0;
         virtual void    AddHeaders     ( QStringMap &headers );
+                void    AddCacheControl( QStringMap &headers );
+                QString GetETag        ();
 
 
         inline Serializer();
@@ -91,13 +91,8 @@ void XmlSerializer::BeginObject( const QString &sName, const QObject  *pObject )
 
     const QMetaObject *pMeta = pObject->metaObject();
 
-    int nIdx = -1;
-
-    if (pMeta)
-        nIdx = pMeta->indexOfClassInfo( "version" );
-
-    if (nIdx >=0)
-        m_pXmlWriter->writeAttribute( "version", pMeta->classInfo( nIdx ).value() );
+    if (pMeta && !GetMetaInfo( pMeta )->sVersion.isNull())
+        m_pXmlWriter->writeAttribute( "version", GetMetaInfo( pMeta )->sVersion );
 
     m_pXmlWriter->writeAttribute( "serializerVersion", XML_SERIALIZER_VERSION );
 
@@ -327,20 +322,19 @@ QString XmlSerializer::GetContentName( const QString        &sName,
 {
     // Try to read Name or TypeName from classinfo metadata.
 
-    int nClassIdx = -1;
+    const SerializerMetaInfo *pInfo = NULL;
 
     if ( pMetaObject )
-        nClassIdx = pMetaObject->indexOfClassInfo( sName.toLatin1() );
+        pInfo = GetMetaInfo( pMetaObject );
 
-    if (nClassIdx >=0 )
+    if (pInfo && pInfo->options.contains( sName ))
     {
-        QString     sOptionData = pMetaObject->classInfo( nClassIdx ).value();
-        QStringList sOptions    = sOptionData.split( ';' );
-        
-        QString sNameOption = FindOptionValue( sOptions, "name" );
+        const QStringMap &options = pInfo->options[ sName ];
+
+        QString sNameOption = options.value( "name" );
 
         if (sNameOption.isEmpty())
-            sNameOption = FindOptionValue( sOptions, "type" );
+            sNameOption = options.value( "type" );
 
         if (!sNameOption.isEmpty())
             return GetItemName(  sNameOption );
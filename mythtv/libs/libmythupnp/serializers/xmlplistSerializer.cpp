@@ -217,15 +217,10 @@ void XmlPListSerializer::BeginObject(const QString &sName,
 {
     const QMetaObject *pMeta = pObject->metaObject();
 
-    int nIdx = -1;
-
-    if (pMeta)
-        nIdx = pMeta->indexOfClassInfo("version");
-
-    if (nIdx >=0)
+    if (pMeta && !GetMetaInfo(pMeta)->sVersion.isNull())
     {
         m_pXmlWriter->writeTextElement("key", "version");
-        m_pXmlWriter->writeTextElement("string", pMeta->classInfo(nIdx).value());
+        m_pXmlWriter->writeTextElement("string", GetMetaInfo(pMeta)->sVersion);
     }
 
     m_pXmlWriter->writeTextElement("key", "serializerversion");
@@ -263,25 +258,18 @@ void XmlPListSerializer::SerializePListObjectProperties(const QString &sName,
     }
     m_pXmlWriter->writeStartElement("dict");
 
-    const QMetaObject *pMetaObject = pObject->metaObject();
+    const QMetaObject        *pMetaObject = pObject->metaObject();
+    const SerializerMetaInfo *pInfo       = GetMetaInfo(pMetaObject);
 
-    int nCount = pMetaObject->propertyCount();
+    QList<SerializerProperty>::const_iterator it;
 
-    for (int nIdx=0; nIdx < nCount; ++nIdx)
+    for (it = pInfo->properties.begin(); it != pInfo->properties.end(); ++it)
     {
-        QMetaProperty metaProperty = pMetaObject->property(nIdx);
-
-        if (metaProperty.isDesignable(pObject))
+        if (it->metaProp.isDesignable(pObject))
         {
-            const char *pszPropName = metaProperty.name();
-            QString     sPropName(pszPropName);
-
-            if (sPropName.compare("objectName") == 0)
-                continue;
-
-            QVariant value(pObject->property(pszPropName));
+            QVariant value(it->metaProp.read(pObject));
 
-            AddProperty(sPropName, value, pMetaObject, &metaProperty);
+            AddProperty(it->sName, value, pMetaObject, &(it->metaProp));
         }
     }
 
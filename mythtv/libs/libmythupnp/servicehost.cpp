@@ -486,10 +486,32 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QObject *pResults )
     {
         Serializer *pSer = pRequest->GetSerializer();
 
-        pSer->Serialize( pResults );
+        // ------------------------------------------------------------------
+        // A service that can tell cheaply whether its result has changed
+        // sets an "ETag" dynamic property on it.  That replaces the hash
+        // of the serialized content, and if the client already has this
+        // version, serializing it can be skipped altogether.
+        // ------------------------------------------------------------------
+
+        QString sETag = pResults->property( "ETag" ).toString();
+
+        if (!sETag.isEmpty())
+        {
+            sETag = "\"" + sETag + "\"";
+            pRequest->SetResponseHeader( "ETag", sETag, true );
+        }
+
+        if (sETag.isEmpty() ||
+            sETag != pRequest->GetRequestHeader( "If-None-Match", "" ))
+        {
+            pSer->Serialize( pResults );
+        }
 
         pRequest->FormatActionResponse( pSer );
 
+        if (!sETag.isEmpty())
+            pRequest->SetResponseHeader( "ETag", sETag, true );
+
         delete pResults;
 
         return true;
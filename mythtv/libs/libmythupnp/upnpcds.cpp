@@ -24,6 +24,12 @@ using namespace std;
 #define DIDL_LITE_BEGIN "<DIDL-Lite xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:upnp=\"urn:schemas-upnp-org:metadata-1-0/upnp/\" xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\">"
 #define DIDL_LITE_END   "</DIDL-Lite>";
 
+// Rendered results kept for browsing clients, see UPnpCDSCacheEntry
+
+static const qint64 kCacheMaxBytes = 16 * 1024 * 1024;
+static const int    kCacheMaxAge   = 10 * 60; // Seconds, for changes nobody
+                                              // sends an event for
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -72,7 +78,8 @@ QString UPnpCDSExtensionResults::GetResultXML(FilterMap &filter,
 /////////////////////////////////////////////////////////////////////////////
 
 UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
-  : Eventing( "UPnpCDS", "CDS_Event", sSharePath )
+  : Eventing( "UPnpCDS", "CDS_Event", sSharePath ),
+    m_nCacheBytes( 0 ), m_nCacheUseCount( 0 ), m_nCacheGeneration( 0 )
 {
     m_root.m_eType       = OT_Container;
     m_root.m_sId         = "0";
@@ -189,6 +196,7 @@ void UPnpCDS::UnregisterExtension( UPnpCDSExtension *pExtension )
     if (pExtension)
     {
         m_extensions.removeAll(pExtension);
+        ContainerChanged( pExtension->m_sExtensionId );
         delete pExtension;
     }
 }
@@ -480,14 +488,31 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
         // Look for a CDS Extension that knows how to handle this ObjectID
         // ------------------------------------------------------------------
 
+        QString           sCacheKey = GetCacheKey( request );
+        UPnpCDSCacheEntry entry;
+        quint64           nGeneration;
+
+        if (GetCachedResult( sCacheKey, entry, nGeneration ))
+        {
+            eErrorCode      = UPnPResult_Success;
+            nNumberReturned = entry.m_nNumberReturned;
+            nTotalMatches   = entry.m_nTotalMatches;
+            nUpdateID       = entry.m_nUpdateID;
+            sResultXML      = entry.m_sResultXML;
+        }
+
         UPnpCDSExtensionList::iterator it = m_extensions.begin();
-        for (; (it != m_extensions.end()) && !pResult; ++it)
+        for (; (it != m_extensions.end()) && !pResult &&
+               (eErrorCode != UPnPResult_Success); ++it)
         {
             LOG(VB_UPNP, LOG_INFO,
                 QString("UPNP Browse : Searching for : %1  / ObjectID : %2")
                     .arg((*it)->m_sExtensionId).arg(request.m_sObjectId));
 
             pResult = (*it)->Browse(&request);
+
+            if (pResult != NULL)
+                entry.m_sExtensionId = (*it)->m_sExtensionId;
         }
 
         if (pResult != NULL)
@@ -504,6 +529,16 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
                     sResultXML      = pResult->GetResultXML(filter, true); // Ignore children
                 else
                     sResultXML      = pResult->GetResultXML(filter);
+
+                if (nUpdateID == 0)
+                    nUpdateID = GetContainerUpdateID( entry.m_sExtensionId );
+
+                entry.m_sResultXML      = sResultXML;
+                entry.m_nNumberReturned = nNumberReturned;
+                entry.m_nTotalMatches   = nTotalMatches;
+                entry.m_nUpdateID       = nUpdateID;
+
+                AddCachedResult( sCacheKey, entry, nGeneration );
             }
 
             delete pResult;
@@ -628,10 +663,29 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
     bool bSearchDone = false;
 #endif
 
+    QString           sCacheKey = GetCacheKey( request );
+    UPnpCDSCacheEntry entry;
+    quint64           nGeneration;
+
+    if (GetCachedResult( sCacheKey, entry, nGeneration ))
+    {
+        eErrorCode      = UPnPResult_Success;
+        nNumberReturned = entry.m_nNumberReturned;
+        nTotalMatches   = entry.m_nTotalMatches;
+        nUpdateID       = entry.m_nUpdateID;
+        sResultXML      = entry.m_sResultXML;
+    }
+
     UPnpCDSExtensionList::iterator it = m_extensions.begin();
-    for (; (it != m_extensions.end()) && !pResult; ++it)
+    for (; (it != m_extensions.end()) && !pResult &&
+           (eErrorCode != UPnPResult_Success); ++it)
+    {
         pResult = (*it)->Search(&request);
 
+        if (pResult != NULL)
+            entry.m_sExtensionId = (*it)->m_sExtensionId;
+    }
+
     if (pResult != NULL)
     {
         eErrorCode  = pResult->m_eErrorCode;
@@ -644,6 +698,16 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
             nTotalMatches   = pResult->m_nTotalMatches;
             nUpdateID       = pResult->m_nUpdateID;
             sResultXML      = pResult->GetResultXML(filter);
+
+            if (nUpdateID == 0)
+                nUpdateID = GetContainerUpdateID( entry.m_sExtensionId );
+
+            entry.m_sResultXML      = sResultXML;
+            entry.m_nNumberReturned = nNumberReturned;
+            entry.m_nTotalMatches   = nTotalMatches;
+            entry.m_nUpdateID       = nUpdateID;
+
+            AddCachedResult( sCacheKey, entry, nGeneration );
 #if 0
             bSearchDone = true;
 #endif
@@ -780,6 +844,173 @@ void UPnpCDS::HandleGetServiceResetToken(HTTPRequest* pRequest)
     pRequest->FormatActionResponse(list);
 }
 
+void UPnpCDS::ContainerChanged( const QString &sExtensionId )
+{
+    ContainersChanged( QStringList( sExtensionId ));
+}
+
+/**
+ *  \brief Tells subscribers, and the result cache, that extensions'
+ *         content has changed.
+ *
+ *  Every cached result the extensions produced is dropped, their
+ *  containers' update IDs are bumped and ContainerUpdateIDs and
+ *  SystemUpdateID are evented once, so control points that cache the
+ *  directory themselves know to browse it again. Callers should collect
+ *  changes rather than call this for each one.
+ */
+
+void UPnpCDS::ContainersChanged( const QStringList &extensionIds )
+{
+    m_cacheLock.lock();
+
+    // Results the extensions are producing right now may predate the change
+    ++m_nCacheGeneration;
+
+    UPnpCDSCache::iterator it = m_cache.begin();
+    while (it != m_cache.end())
+    {
+        if (extensionIds.contains( it->m_sExtensionId ))
+        {
+            m_nCacheBytes -= it->m_sResultXML.size() * sizeof(QChar);
+            it = m_cache.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    m_cacheLock.unlock();
+
+    // The IDs and the evented values must change together, or two callers
+    // could event their IDs out of order
+    QMutexLocker locker(&m_updateIDLock);
+
+    QStringList updateIDs;
+
+    QStringList::const_iterator eit = extensionIds.begin();
+    for (; eit != extensionIds.end(); ++eit)
+    {
+        uint16_t nContainerUpdateID = ++m_containerUpdateIDs[*eit];
+
+        LOG(VB_UPNP, LOG_INFO,
+            QString("UPnpCDS::ContainersChanged : %1 (UpdateID %2)")
+                .arg(*eit).arg(nContainerUpdateID));
+
+        updateIDs << *eit << QString::number( nContainerUpdateID );
+    }
+
+    SetValue< QString  >( "ContainerUpdateIDs", updateIDs.join( "," ));
+    SetValue< uint16_t >( "SystemUpdateID",
+                          GetValue< uint16_t >( "SystemUpdateID" ) + 1 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+uint16_t UPnpCDS::GetContainerUpdateID( const QString &sExtensionId )
+{
+    QMutexLocker locker(&m_updateIDLock);
+
+    return m_containerUpdateIDs.value( sExtensionId, 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Everything an extension may base its response on, clients get tailored
+// results so the client type is part of it too.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QString UPnpCDS::GetCacheKey( const UPnpCDSRequest &request ) const
+{
+    return QString("%1\n%2\n%3\n%4\n%5\n%6\n%7\n%8\n%9")
+               .arg(request.m_sObjectId)
+               .arg(request.m_sContainerID)
+               .arg(request.m_eBrowseFlag)
+               .arg(request.m_sSearchCriteria)
+               .arg(request.m_sFilter)
+               .arg(request.m_nStartingIndex)
+               .arg(request.m_nRequestedCount)
+               .arg(request.m_sSortCriteria)
+               .arg(QString("%1/%2").arg(request.m_eClient)
+                                    .arg(request.m_nClientVersion));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool UPnpCDS::GetCachedResult( const QString &sKey, UPnpCDSCacheEntry &entry,
+                               quint64 &nGeneration )
+{
+    QMutexLocker locker(&m_cacheLock);
+
+    // Taken before the extensions are asked, see AddCachedResult()
+    nGeneration = m_nCacheGeneration;
+
+    UPnpCDSCache::iterator it = m_cache.find( sKey );
+    if (it == m_cache.end())
+        return false;
+
+    if (it->m_dtCreated.secsTo(QDateTime::currentDateTimeUtc()) >= kCacheMaxAge)
+    {
+        m_nCacheBytes -= it->m_sResultXML.size() * sizeof(QChar);
+        m_cache.erase(it);
+        return false;
+    }
+
+    it->m_nLastUsed = ++m_nCacheUseCount;
+    entry = *it;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::AddCachedResult( const QString &sKey, UPnpCDSCacheEntry &entry,
+                               quint64 nGeneration )
+{
+    qint64 nBytes = entry.m_sResultXML.size() * sizeof(QChar);
+
+    if (entry.m_sExtensionId.isEmpty() || nBytes > kCacheMaxBytes / 4)
+        return;
+
+    QMutexLocker locker(&m_cacheLock);
+
+    // Content changed while the result was being built, it may be stale
+    if (nGeneration != m_nCacheGeneration)
+        return;
+
+    entry.m_dtCreated = QDateTime::currentDateTimeUtc();
+    entry.m_nLastUsed = ++m_nCacheUseCount;
+
+    UPnpCDSCache::iterator it = m_cache.find( sKey );
+    if (it != m_cache.end())
+        m_nCacheBytes -= it->m_sResultXML.size() * sizeof(QChar);
+
+    m_cache.insert( sKey, entry );
+    m_nCacheBytes += nBytes;
+
+    // Drop the least recently used results until we're back within budget
+
+    while (m_nCacheBytes > kCacheMaxBytes && !m_cache.isEmpty())
+    {
+        UPnpCDSCache::iterator oldest = m_cache.begin();
+
+        for (it = m_cache.begin(); it != m_cache.end(); ++it)
+        {
+            if (it->m_nLastUsed < oldest->m_nLastUsed)
+                oldest = it;
+        }
+
+        m_nCacheBytes -= oldest->m_sResultXML.size() * sizeof(QChar);
+        m_cache.erase(oldest);
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -13,9 +13,13 @@
 #ifndef UPnpCDS_H_
 #define UPnpCDS_H_
 
+#include <QDateTime>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 #include "upnp.h"
@@ -280,6 +284,40 @@ class UPNP_PUBLIC UPnpCDSExtension
 
 typedef QList<UPnpCDSExtension*> UPnpCDSExtensionList;
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// A Browse or Search response as it was sent, kept so that clients paging
+// through a container don't rebuild the same objects from the database for
+// every request.  Entries belong to the extension that produced them and are
+// dropped when it reports a change through UPnpCDS::ContainerChanged().
+//
+//////////////////////////////////////////////////////////////////////////////
+
+class UPnpCDSCacheEntry
+{
+    public:
+
+        QString     m_sExtensionId;
+        QString     m_sResultXML;
+        uint16_t    m_nNumberReturned;
+        uint16_t    m_nTotalMatches;
+        uint16_t    m_nUpdateID;
+
+        QDateTime   m_dtCreated;
+        quint64     m_nLastUsed;
+
+    public:
+
+        UPnpCDSCacheEntry() : m_nNumberReturned( 0 ),
+                              m_nTotalMatches  ( 0 ),
+                              m_nUpdateID      ( 0 ),
+                              m_nLastUsed      ( 0 )
+        {
+        }
+};
+
+typedef QHash<QString, UPnpCDSCacheEntry> UPnpCDSCache;
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -301,6 +339,15 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         UPnPFeatureList        m_features;
         UPnPShortcutFeature      *m_pShortCuts;
 
+        QMutex                 m_cacheLock;
+        UPnpCDSCache           m_cache;
+        qint64                 m_nCacheBytes;
+        quint64                m_nCacheUseCount;
+        quint64                m_nCacheGeneration; // bumped by ContainersChanged
+
+        QMutex                 m_updateIDLock;
+        QMap<QString,uint16_t> m_containerUpdateIDs; // protected by m_updateIDLock
+
     private:
 
         UPnpCDSMethod       GetMethod              ( const QString &sURI  );
@@ -315,6 +362,15 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         void            HandleGetServiceResetToken ( HTTPRequest *pRequest );
         void            DetermineClient            ( HTTPRequest *pRequest, UPnpCDSRequest *pCDSRequest );
 
+        QString         GetCacheKey                ( const UPnpCDSRequest &request ) const;
+        bool            GetCachedResult            ( const QString &sKey,
+                                                     UPnpCDSCacheEntry &entry,
+                                                     quint64 &nGeneration );
+        void            AddCachedResult            ( const QString &sKey,
+                                                     UPnpCDSCacheEntry &entry,
+                                                     quint64 nGeneration );
+        uint16_t        GetContainerUpdateID       ( const QString &sExtensionId );
+
     protected:
 
         // Implement UPnpServiceImpl methods that we can
@@ -337,6 +393,9 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
                                       const QString &objectID );
         void     RegisterFeature    ( UPnPFeature *feature );
 
+        void     ContainerChanged   ( const QString &sExtensionId );
+        void     ContainersChanged  ( const QStringList &extensionIds );
+
         virtual QStringList GetBasePaths();
         
         virtual bool ProcessRequest( HTTPRequest *pRequest );
@@ -0,0 +1,302 @@
+// Qt headers
+#include <QCoreApplication>
+#include <QCryptographicHash>
+
+// MythTV headers
+#include "guidecache.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
+#include "channelutil.h"
+#include "scheduler.h"
+
+#define LOC QString("GuideCache: ")
+
+/// Start again at least this often, channel edits don't send any event.
+static const int kMaxAge = 15 * 60;
+
+GuideCache *GuideCache::s_instance = NULL;
+QMutex      GuideCache::s_instanceLock;
+
+QList<ProgramInfo*> GuideWindow::GetPrograms(uint chanid) const
+{
+    QList<ProgramInfo*> result;
+    QDateTime           limit = start.addDays(-1);
+    QDateTime           last;
+
+    // A program spanning several slots is in each of them, but the slots
+    // are in time order, so it is enough to only take later start times.
+
+    QList<GuideSlotPtr>::const_iterator it = buckets.begin();
+    for (; it != buckets.end(); ++it)
+    {
+        const QList<ProgramInfo*> list = (*it)->byChanId.value(chanid);
+
+        QList<ProgramInfo*>::const_iterator pit = list.begin();
+        for (; pit != list.end(); ++pit)
+        {
+            QDateTime startts = (*pit)->GetScheduledStartTime();
+
+            if ((*pit)->GetScheduledEndTime() < start || startts >= end ||
+                startts < limit || (last.isValid() && startts <= last))
+                continue;
+
+            result.push_back(*pit);
+            last = startts;
+        }
+    }
+
+    return result;
+}
+
+/** \fn GuideCache::GetInstance(void)
+ *  \brief Returns the cache, creating it on first use.
+ *
+ *  Requests arrive on HttpWorker threads, which have no event loop, so the
+ *  cache is handed to the UI thread to receive its events.
+ */
+GuideCache *GuideCache::GetInstance(void)
+{
+    QMutexLocker locker(&s_instanceLock);
+
+    if (!s_instance)
+    {
+        s_instance = new GuideCache();
+        s_instance->moveToThread(QCoreApplication::instance()->thread());
+        gCoreContext->addListener(s_instance);
+    }
+
+    return s_instance;
+}
+
+GuideCache::GuideCache(void) :
+    m_created(MythDate::current()), m_generation(0), m_useCount(0)
+{
+}
+
+ChannelInfoList GuideCache::GetChannels(uint channelGroupId, uint startIndex,
+                                        uint count, uint &totalAvailable)
+{
+    ChannelInfoList channels;
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        if (m_created.secsTo(MythDate::current()) >= kMaxAge)
+        {
+            locker.unlock();
+            Invalidate();
+            locker.relock();
+        }
+
+        if (m_channels.contains(channelGroupId))
+            channels = m_channels[channelGroupId];
+    }
+
+    if (channels.empty())
+    {
+        uint total = 0;
+
+        channels = ChannelUtil::LoadChannels(0, 0, total, true,
+                                             ChannelUtil::kChanOrderByChanNum,
+                                             ChannelUtil::kChanGroupByCallsign,
+                                             0, channelGroupId);
+
+        QMutexLocker locker(&m_lock);
+        m_channels[channelGroupId] = channels;
+    }
+
+    totalAvailable = channels.size();
+
+    if (startIndex >= channels.size())
+        return ChannelInfoList();
+
+    ChannelInfoList::iterator first = channels.begin() + startIndex;
+    ChannelInfoList::iterator last  = channels.end();
+
+    if (count > 0 && count < channels.size() - startIndex)
+        last = first + count;
+
+    return ChannelInfoList(first, last);
+}
+
+GuideWindow GuideCache::GetWindow(uint channelGroupId,
+                                  const QDateTime &start, const QDateTime &end)
+{
+    GuideWindow window;
+
+    window.start = start;
+    window.end   = end;
+
+    // Programs have to start before the end, hence the end is exclusive
+    qint64 first = start.toMSecsSinceEpoch() / 1000 / kSlotLength;
+    qint64 last  = (end.toMSecsSinceEpoch() / 1000 - 1) / kSlotLength;
+
+    for (qint64 slot = first; slot <= last; ++slot)
+        window.buckets.push_back(GetSlot(channelGroupId, slot));
+
+    return window;
+}
+
+QString GuideCache::GetETag(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QString("%1 %2")
+                 .arg(MythDate::toString(m_created, MythDate::kFilename))
+                 .arg(m_generation).toUtf8());
+
+    return hash.result().toHex();
+}
+
+GuideSlotPtr GuideCache::GetSlot(uint channelGroupId, qint64 slot)
+{
+    SlotKey key(channelGroupId, slot);
+
+    QMutexLocker locker(&m_lock);
+
+    while (true)
+    {
+        if (!m_slots.contains(key))
+            break;
+
+        Entry &entry = m_slots[key];
+
+        if (!entry.loading)
+        {
+            entry.lastUsed = ++m_useCount;
+            return entry.guideSlot;
+        }
+
+        // Someone else is loading it already. If the cache is invalidated
+        // meanwhile the entry disappears and we load it ourselves.
+        m_loaded.wait(&m_lock);
+    }
+
+    Entry &entry   = m_slots[key];
+    entry.loading  = true;
+    entry.lastUsed = ++m_useCount;
+
+    uint generation = m_generation;
+
+    locker.unlock();
+    GuideSlotPtr guideSlot = LoadSlot(channelGroupId, slot);
+    locker.relock();
+
+    if (generation == m_generation && m_slots.contains(key))
+    {
+        Entry &loaded    = m_slots[key];
+        loaded.guideSlot = guideSlot;
+        loaded.loading   = false;
+        Prune();
+    }
+
+    m_loaded.wakeAll();
+
+    return guideSlot;
+}
+
+GuideSlotPtr GuideCache::LoadSlot(uint channelGroupId, qint64 slot)
+{
+    GuideSlotPtr guideSlot(new GuideSlot);
+
+    QDateTime slotStart = MythDate::fromTime_t(slot * kSlotLength);
+    QDateTime slotEnd   = slotStart.addSecs(kSlotLength);
+
+    // Same selection Guide::GetProgramGuide() used to make per channel
+    QString sWhere = "program.endtime >= :STARTDATE "
+                     "AND program.starttime < :ENDDATE "
+                     "AND program.starttime >= :STARTDATELIMIT "
+                     "AND program.manualid = 0";
+
+    MSqlBindings bindings;
+    bindings[":STARTDATE"     ] = slotStart;
+    bindings[":STARTDATELIMIT"] = slotStart.addDays(-1);
+    bindings[":ENDDATE"       ] = slotEnd;
+
+    if (channelGroupId > 0)
+    {
+        sWhere += " AND program.chanid IN (SELECT chanid FROM channelgroup "
+                  "WHERE grpid = :CHANGROUPID)";
+        bindings[":CHANGROUPID"] = channelGroupId;
+    }
+
+    ProgramList schedList;
+
+    Scheduler *scheduler = dynamic_cast<Scheduler*>(gCoreContext->GetScheduler());
+    if (scheduler)
+        scheduler->GetAllPending(schedList);
+
+    LoadFromProgram(guideSlot->programs, sWhere,
+                    "program.chanid, program.starttime", "program.starttime",
+                    bindings, schedList);
+
+    ProgramList::iterator it = guideSlot->programs.begin();
+    for (; it != guideSlot->programs.end(); ++it)
+        guideSlot->byChanId[(*it)->GetChanID()].push_back(*it);
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC + QString("Loaded %1 programs for group %2 "
+                                             "from %3")
+        .arg(guideSlot->programs.size()).arg(channelGroupId)
+        .arg(MythDate::toString(slotStart, MythDate::ISODate)));
+
+    return guideSlot;
+}
+
+void GuideCache::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    // Slots being loaded are dropped too, their loaders see the new
+    // generation and don't publish what they got.
+    m_slots.clear();
+    m_channels.clear();
+    m_created = MythDate::current();
+    ++m_generation;
+
+    m_loaded.wakeAll();
+}
+
+/// Drops the least recently used slots. Must be called with m_lock held.
+void GuideCache::Prune(void)
+{
+    while (m_slots.size() > kMaxSlots)
+    {
+        QHash<SlotKey, Entry>::iterator it     = m_slots.begin();
+        QHash<SlotKey, Entry>::iterator oldest = m_slots.end();
+
+        for (; it != m_slots.end(); ++it)
+        {
+            if (it->loading)
+                continue;
+
+            if (oldest == m_slots.end() || it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+
+        if (oldest == m_slots.end())
+            return;
+
+        m_slots.erase(oldest);
+    }
+}
+
+void GuideCache::customEvent(QEvent *event)
+{
+    if (event->type() != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent *me      = static_cast<MythEvent *>(event);
+    QString    message = me->Message();
+
+    if (message.startsWith("RESCHEDULE_RECORDINGS") ||
+        message == "SCHEDULE_CHANGE")
+    {
+        LOG(VB_GENERAL, LOG_DEBUG, LOC + "Invalidated by " + message);
+        Invalidate();
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
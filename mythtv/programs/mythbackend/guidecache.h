@@ -0,0 +1,104 @@
+#ifndef GUIDECACHE_H_
+#define GUIDECACHE_H_
+
+#include <QSharedPointer>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QObject>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QPair>
+
+#include "programinfo.h"
+#include "channelinfo.h"
+
+/// Programs of one channel group overlapping one time slot.  Read only once
+/// it has been published, so any number of requests can share it.
+class GuideSlot
+{
+  public:
+    ProgramList                        programs;
+    QHash< uint, QList<ProgramInfo*> > byChanId; ///< ordered by start time
+};
+typedef QSharedPointer<GuideSlot> GuideSlotPtr;
+
+/// The slots covering one request, in time order.  Holding this keeps them
+/// alive even if the cache drops them in the meantime.
+class GuideWindow
+{
+  public:
+    QList<ProgramInfo*> GetPrograms(uint chanid) const;
+
+    QDateTime           start;
+    QDateTime           end;
+    QList<GuideSlotPtr> buckets;
+};
+
+/** \class GuideCache
+ *  \brief Shared cache of guide data for Guide/GetProgramGuide.
+ *
+ *  Guide data is kept in kSlotLength slices per channel group, each loaded
+ *  with a single query for all of the group's channels rather than one per
+ *  channel per request.  Clients nearly all ask for the same aligned
+ *  windows, so after the first request they are assembled from memory.
+ *  Concurrent requests for a slot that is being loaded wait for that load
+ *  instead of repeating it.
+ *
+ *  Everything is dropped on RESCHEDULE_RECORDINGS, which follows
+ *  mythfilldatabase and EIT updates, and on SCHEDULE_CHANGE, since the
+ *  programs carry their recording status.
+ */
+class GuideCache : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static GuideCache *GetInstance(void);
+
+    ChannelInfoList GetChannels(uint channelGroupId, uint startIndex,
+                                uint count, uint &totalAvailable);
+    GuideWindow     GetWindow(uint channelGroupId,
+                              const QDateTime &start, const QDateTime &end);
+    QString         GetETag(void);
+
+    static const int kSlotLength = 60 * 60;
+    static const int kMaxSlots   = 96;
+
+  protected:
+    GuideCache(void);
+    virtual void customEvent(QEvent *event);
+
+  private:
+    typedef QPair<uint, qint64> SlotKey; // channel group, slot number
+
+    class Entry
+    {
+      public:
+        Entry() : loading(false), lastUsed(0) {}
+
+        GuideSlotPtr guideSlot;
+        bool         loading;
+        quint64      lastUsed;
+    };
+
+    GuideSlotPtr GetSlot(uint channelGroupId, qint64 slot);
+    GuideSlotPtr LoadSlot(uint channelGroupId, qint64 slot);
+    void         Invalidate(void);
+    void         Prune(void);
+
+    static GuideCache *s_instance;
+    static QMutex      s_instanceLock;
+
+    QMutex         m_lock;
+    QWaitCondition m_loaded;
+    QHash<SlotKey, Entry> m_slots;
+    QHash<uint, ChannelInfoList> m_channels;
+    QDateTime      m_created;    ///< age of everything in the cache
+    uint           m_generation; ///< bumped on every invalidation
+    quint64        m_useCount;
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -570,6 +570,37 @@ void HttpStatus::FillStatusXML( QDomDocument *pDoc )
         pDoc->createTextNode(gCoreContext->GetSetting("DataDirectMessage"));
     guide.appendChild(dataDirectMessage);
 
+    // Add the connection pool state and the most expensive statements
+
+    QDomElement database = pDoc->createElement("Database");
+    root.appendChild(database);
+
+    MDBManager::PoolStats pool = gCoreContext->GetDBManager()->GetPoolStats();
+    database.setAttribute("connections" , pool.open);
+    database.setAttribute("inUse"       , pool.inUse);
+    database.setAttribute("limit"       , pool.limit);
+    database.setAttribute("checkouts"   , pool.checkouts);
+    database.setAttribute("waits"       , pool.waits);
+    database.setAttribute("waitTotal"   , pool.totalWaitUsecs);
+    database.setAttribute("waitMax"     , pool.maxWaitUsecs);
+    database.setAttribute("reaped"      , pool.reaped);
+    database.setAttribute("reapPending" , pool.reapPending);
+    database.setAttribute("queuedWrites", pool.queuedWrites);
+
+    QList<MSqlQueryProfiler::Stats> stats = MSqlQueryProfiler::GetStats(25);
+    QList<MSqlQueryProfiler::Stats>::const_iterator sit = stats.begin();
+    for (; sit != stats.end(); ++sit)
+    {
+        QDomElement query = pDoc->createElement("Query");
+        database.appendChild(query);
+
+        query.setAttribute("count", sit->count);
+        query.setAttribute("total", sit->totalUsecs);
+        query.setAttribute("p99"  , sit->p99Usecs);
+        query.setAttribute("max"  , sit->maxUsecs);
+        query.appendChild(pDoc->createTextNode(sit->statement));
+    }
+
     // Add Miscellaneous information
 
     QString info_script = gCoreContext->GetSetting("MiscStatusScript");
@@ -697,6 +728,13 @@ void HttpStatus::PrintStatus( QTextStream &os, QDomDocument *pDoc )
     if (!node.isNull())
         PrintMachineInfo( os, node.toElement());
 
+    // Database statements ---------------------
+
+    node = docElem.namedItem( "Database" );
+
+    if (!node.isNull())
+        PrintDatabase( os, node.toElement());
+
     // Miscellaneous information ---------------
 
     node = docElem.namedItem( "Miscellaneous" );
@@ -1454,6 +1492,63 @@ int HttpStatus::PrintMachineInfo( QTextStream &os, QDomElement info )
     return( 1 );
 }
 
+int HttpStatus::PrintDatabase( QTextStream &os, QDomElement database )
+{
+    if (database.isNull())
+        return( 0 );
+
+    os << "<div class=\"content\">\r\n"
+       << "    <h2 class=\"status\">Database</h2>\r\n"
+       << "    " << database.attribute("connections", "0")
+       << " connections open (" << database.attribute("inUse", "0")
+       << " in use, limit " << database.attribute("limit", "0") << "), "
+       << database.attribute("queuedWrites", "0") << " writes queued."
+       << "<br />\r\n"
+       << "    " << database.attribute("checkouts", "0")
+       << " connections handed out, " << database.attribute("waits", "0")
+       << " after waiting (total " << database.attribute("waitTotal", "0")
+       << " us, max " << database.attribute("waitMax", "0") << " us), "
+       << database.attribute("reaped", "0")
+       << " idle connections reaped to make room ("
+       << database.attribute("reapPending", "0")
+       << " still open until their thread closes them).<br />\r\n";
+
+    QDomNodeList nodes = database.elementsByTagName("Query");
+    uint count = nodes.count();
+    if (count == 0)
+    {
+        os << "</div>\r\n";
+        return( 1 );
+    }
+
+    os << "    The " << count << " statements with the most total time "
+       << "(times in microseconds):\r\n"
+       << "    <ul>\r\n";
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        QDomElement e = nodes.item(i).toElement();
+        if (e.isNull())
+            continue;
+
+        QString statement = e.text();
+        statement.replace("&", "&amp;").replace("<", "&lt;")
+                 .replace(">", "&gt;");
+
+        os << "      <li>"
+           << e.attribute("count", "0") << " runs, total "
+           << e.attribute("total", "0") << ", p99 "
+           << e.attribute("p99", "0") << ", max "
+           << e.attribute("max", "0") << ": <code>"
+           << statement << "</code></li>\r\n";
+    }
+
+    os << "    </ul>\r\n"
+       << "</div>\r\n";
+
+    return( count );
+}
+
 int HttpStatus::PrintMiscellaneousInfo( QTextStream &os, QDomElement info )
 {
     if (info.isNull())
@@ -1428,6 +1428,16 @@ void MainServer::customEvent(QEvent *e)
         if (me->Message() == "CLEAR_SETTINGS_CACHE")
             gCoreContext->ClearSettingsCache();
 
+        if (me->Message().startsWith("SETTING_CHANGED"))
+        {
+            QStringList tokens = me->Message()
+                .split(" ", QString::SkipEmptyParts);
+            if (tokens.size() > 2)
+                gCoreContext->ClearSettingsCache(tokens[2] + ' ' + tokens[1]);
+            else if (tokens.size() > 1)
+                gCoreContext->ClearSettingsCache(tokens[1]);
+        }
+
         if (me->Message().startsWith("RESET_IDLETIME") && m_sched)
             m_sched->ResetIdleTime();
 
@@ -1545,7 +1555,8 @@ void MainServer::customEvent(QEvent *e)
 
             bool reallysendit = false;
 
-            if (broadcast[1] == "CLEAR_SETTINGS_CACHE")
+            if (broadcast[1] == "CLEAR_SETTINGS_CACHE" ||
+                broadcast[1].startsWith("SETTING_CHANGED"))
             {
                 if ((ismaster) &&
                     (pbs->isSlaveBackend() || pbs->wantsEvents()))
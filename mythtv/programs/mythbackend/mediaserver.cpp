@@ -9,6 +9,8 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "mediaserver.h"
+#include "mythcorecontext.h"
+#include "mythevent.h"
 #include "httpconfig.h"
 #include "internetContent.h"
 #include "mythdirs.h"
@@ -57,6 +59,13 @@ MediaServer::MediaServer(void) :
 {
     LOG(VB_UPNP, LOG_INFO, "MediaServer(): Begin");
 
+    // UPnP moderates ContainerUpdateIDs and SystemUpdateID to an event
+    // every 2 seconds, so changes are collected for that long.
+    m_changeTimer.setSingleShot(true);
+    m_changeTimer.setInterval(2000);
+    connect(&m_changeTimer, SIGNAL(timeout()),
+            this, SLOT(SendContainerChanges()));
+
     // ----------------------------------------------------------------------
     // Initialize Configuration class (Database for Servers)
     // ----------------------------------------------------------------------
@@ -255,11 +264,9 @@ void MediaServer::Init(bool bIsMaster, bool bDisableUPnp /* = false */)
             RegisterExtension(new UPnpCDSVideo());
         }
 
-#if 0
         LOG(VB_UPNP, LOG_INFO, "MediaServer::Adding Context Listener");
 
         gCoreContext->addListener( this );
-#endif
 
         Start();
 
@@ -290,9 +297,7 @@ MediaServer::~MediaServer()
 {
     // -=>TODO: Need to check to see if calling this more than once is ok.
 
-#if 0
     gCoreContext->removeListener(this);
-#endif
 
     delete m_pHttpServer;
 
@@ -304,18 +309,59 @@ MediaServer::~MediaServer()
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
-#if 0
+
 void MediaServer::customEvent( QEvent *e )
 {
-    if (MythEvent::Type(e->type()) == MythEvent::MythEventMessage)
-    {
-        MythEvent *me = (MythEvent *)e;
-        QString message = me->Message();
+    if (m_pUPnpCDS == NULL ||
+        MythEvent::Type(e->type()) != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent *me = (MythEvent *)e;
+    QString message = me->Message();
 
-        //-=>TODO: Need to handle events to notify clients of changes
+    // Let the ContentDirectory drop what it has cached for the affected
+    // extension and event the change to subscribed clients.
+
+    QString sContainer;
+
+    if (message.startsWith("RECORDING_LIST_CHANGE") ||
+        message.startsWith("MASTER_UPDATE_REC_INFO"))
+    {
+        sContainer = "Recordings";
+    }
+    else if (message.startsWith("VIDEO_LIST_CHANGE"))
+    {
+        sContainer = "Videos";
+    }
+    else if (message.startsWith("MUSIC_SCANNER_FINISHED") ||
+             message.startsWith("MUSIC_METADATA_CHANGED") ||
+             message.startsWith("MUSIC_ALBUMART_CHANGED"))
+    {
+        sContainer = "Music";
     }
+
+    if (sContainer.isEmpty())
+        return;
+
+    if (!m_changedContainers.contains(sContainer))
+        m_changedContainers.append(sContainer);
+
+    if (!m_changeTimer.isActive())
+        m_changeTimer.start();
 }
-#endif
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void MediaServer::SendContainerChanges( void )
+{
+    if (m_pUPnpCDS != NULL && !m_changedContainers.isEmpty())
+        m_pUPnpCDS->ContainersChanged( m_changedContainers );
+
+    m_changedContainers.clear();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
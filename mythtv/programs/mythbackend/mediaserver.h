@@ -11,7 +11,10 @@
 #ifndef __MEDIASERVER_H__
 #define __MEDIASERVER_H__
 
+#include <QObject>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
 
 #include "upnp.h"
 #include "upnpcds.h"
@@ -28,8 +31,10 @@ class BonjourRegister;
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
-class MediaServer : public UPnp
+class MediaServer : public QObject, public UPnp
 {
+    Q_OBJECT
+
     private:
 
 #ifdef USING_LIBDNS_SD
@@ -43,6 +48,10 @@ class MediaServer : public UPnp
 
         QString          m_sSharePath;
 
+        // Containers changed since ContainerUpdateIDs was last evented
+        QStringList      m_changedContainers;
+        QTimer           m_changeTimer;
+
     public:
         explicit MediaServer();
         void Init(bool bMaster, bool bDisableUPnp = false);
@@ -52,6 +61,14 @@ class MediaServer : public UPnp
         void     RegisterExtension  ( UPnpCDSExtension    *pExtension );
         void     UnregisterExtension( UPnpCDSExtension    *pExtension );
 
+    protected:
+
+        virtual void customEvent( QEvent *e );
+
+    private slots:
+
+        void SendContainerChanges( void );
+
 };
 
 #endif
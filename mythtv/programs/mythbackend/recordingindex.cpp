@@ -0,0 +1,236 @@
+// Qt headers
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QStringList>
+#include <QRegExp>
+
+// MythTV headers
+#include "recordingindex.h"
+#include "mythcorecontext.h"
+#include "mythscheduler.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
+#include "jobqueue.h"
+
+#define LOC QString("RecordingIndex: ")
+
+/// Reload at least this often in case something changed the recorded
+/// table without telling us.
+static const int kMaxAge = 10 * 60;
+
+RecordingIndex *RecordingIndex::s_instance = NULL;
+QMutex          RecordingIndex::s_instanceLock;
+
+/** \fn RecordingIndex::GetInstance(void)
+ *  \brief Returns the index, creating it on first use.
+ *
+ *  This is normally called from an HttpWorker thread, which has no event
+ *  loop, so the index is handed to the UI thread to receive its events.
+ */
+RecordingIndex *RecordingIndex::GetInstance(void)
+{
+    QMutexLocker locker(&s_instanceLock);
+
+    if (!s_instance)
+    {
+        s_instance = new RecordingIndex();
+        s_instance->moveToThread(QCoreApplication::instance()->thread());
+        gCoreContext->addListener(s_instance);
+    }
+
+    return s_instance;
+}
+
+RecordingIndex::RecordingIndex(void) :
+    m_stale(true), m_generation(0)
+{
+}
+
+/** \fn RecordingIndex::Query(ProgramList&,int&,bool,int,int,const QString&,const QString&,const QString&)
+ *  \brief Fills page with copies of the matching recordings.
+ *
+ *  \param page           receives at most count recordings from startIndex
+ *  \param totalAvailable set to the number of recordings that match
+ *  \return An ETag for the result, which only changes if the index, the
+ *          parameters or the in use/recording state of the page does.
+ */
+QString RecordingIndex::Query(ProgramList &page, int &totalAvailable,
+                              bool descending, int startIndex, int count,
+                              const QString &titleRegEx,
+                              const QString &recGroup,
+                              const QString &storageGroup)
+{
+    QMap<QString, ProgramInfo*> recMap;
+
+    if (gCoreContext->GetScheduler())
+        recMap = gCoreContext->GetScheduler()->GetRecording();
+
+    QMap<QString, uint32_t> inUseMap     = ProgramInfo::QueryInUseMap();
+    QMap<QString, bool>     isJobRunning =
+        ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+
+    QDateTime rectime = MythDate::current().addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+
+    QRegExp rTitleRegEx(titleRegEx, Qt::CaseInsensitive);
+
+    QMutexLocker locker(&m_lock);
+
+    LoadIfStale(isJobRunning);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(QString("%1 %2 %3 %4 %5 %6 %7 %8")
+                 .arg(MythDate::toString(m_loaded, MythDate::kFilename))
+                 .arg(m_generation).arg(descending).arg(startIndex)
+                 .arg(count).arg(titleRegEx).arg(recGroup)
+                 .arg(storageGroup).toUtf8());
+
+    uint size  = m_list.size();
+    int  max   = (count > 0) ? count : size;
+    int  added = 0;
+
+    totalAvailable = 0;
+
+    for (uint n = 0; n < size; ++n)
+    {
+        ProgramInfo *pginfo = m_list[descending ? size - n - 1 : n];
+
+        if (pginfo->IsDeletePending() ||
+            (!titleRegEx.isEmpty() &&
+             !pginfo->GetTitle().contains(rTitleRegEx)) ||
+            (!recGroup.isEmpty() &&
+             recGroup != pginfo->GetRecordingGroup()) ||
+            (!storageGroup.isEmpty() &&
+             storageGroup != pginfo->GetStorageGroup()))
+            continue;
+
+        if ((totalAvailable++ < startIndex) || (added >= max))
+            continue;
+
+        ++added;
+
+        // Same adjustments LoadFromRecorded() makes
+
+        ProgramInfo *copy  = new ProgramInfo(*pginfo);
+        QString      key   = copy->MakeUniqueKey();
+        uint32_t     flags = copy->GetProgramFlags() | inUseMap.value(key);
+
+        if ((flags & FL_COMMPROCESSING) && !isJobRunning.contains(key))
+            flags &= ~FL_COMMPROCESSING;
+
+        copy->SetProgramFlags(flags);
+
+        if (copy->GetRecordingEndTime() > rectime && recMap.contains(key))
+            copy->SetRecordingStatus(RecStatus::Recording);
+
+        hash.addData(QString("%1 %2 %3").arg(key).arg(flags)
+                     .arg(copy->GetRecordingStatus()).toUtf8());
+
+        page.push_back(copy);
+    }
+
+    hash.addData(QByteArray::number(totalAvailable));
+
+    QMap<QString, ProgramInfo*>::iterator it = recMap.begin();
+    for (; it != recMap.end(); it = recMap.erase(it))
+        delete *it;
+
+    return hash.result().toHex();
+}
+
+/// Must be called with m_lock held.
+void RecordingIndex::LoadIfStale(const QMap<QString,bool> &isJobRunning)
+{
+    if (!m_stale && m_loaded.secsTo(MythDate::current()) < kMaxAge)
+        return;
+
+    // In use and recording state are per query, so don't cache them. The
+    // real job map is needed though, LoadFromRecorded() resets the flagging
+    // state of anything that says it is being flagged but isn't.
+
+    QMap<QString, uint32_t>     noInUse;
+    QMap<QString, ProgramInfo*> noRecordings;
+
+    LoadFromRecorded(m_list, false, noInUse, isJobRunning, noRecordings, 1);
+
+    m_stale  = false;
+    m_loaded = MythDate::current();
+    ++m_generation;
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC +
+        QString("Loaded %1 recordings").arg(m_list.size()));
+}
+
+void RecordingIndex::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_stale = true;
+    ++m_generation;
+}
+
+void RecordingIndex::Remove(uint recordedid)
+{
+    QMutexLocker locker(&m_lock);
+
+    ProgramList::iterator it = m_list.begin();
+    while (it != m_list.end())
+    {
+        if ((*it)->GetRecordingID() == recordedid)
+            it = m_list.erase(it);
+        else
+            ++it;
+    }
+
+    ++m_generation;
+}
+
+void RecordingIndex::UpdateFileSize(uint recordedid, uint64_t filesize)
+{
+    QMutexLocker locker(&m_lock);
+
+    ProgramList::iterator it = m_list.begin();
+    for (; it != m_list.end(); ++it)
+    {
+        if ((*it)->GetRecordingID() == recordedid)
+        {
+            (*it)->SetFilesize(filesize);
+            ++m_generation;
+            return;
+        }
+    }
+}
+
+void RecordingIndex::customEvent(QEvent *event)
+{
+    if (event->type() != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent  *me     = static_cast<MythEvent *>(event);
+    QStringList tokens = me->Message().simplified().split(" ");
+
+    if (tokens.isEmpty())
+        return;
+
+    if (tokens[0] == "RECORDING_LIST_CHANGE")
+    {
+        // "RECORDING_LIST_CHANGE DELETE <recordedid>" is the one change that
+        // can be made without going back to the database.
+        if (tokens.size() >= 3 && tokens[1] == "DELETE")
+            Remove(tokens[2].toUInt());
+        else
+            Invalidate();
+    }
+    else if (tokens[0] == "MASTER_UPDATE_REC_INFO")
+    {
+        Invalidate();
+    }
+    else if (tokens[0] == "UPDATE_FILE_SIZE" && tokens.size() >= 3)
+    {
+        UpdateFileSize(tokens[1].toUInt(), tokens[2].toULongLong());
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,60 @@
+#ifndef RECORDINGINDEX_H_
+#define RECORDINGINDEX_H_
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QMap>
+
+#include "programinfo.h"
+
+/** \class RecordingIndex
+ *  \brief In memory copy of the recorded table for the Services API.
+ *
+ *  Loading every recording through ProgramInfo is far more expensive than
+ *  filtering and paging a list that is already in memory, and web clients
+ *  poll Dvr/GetRecordedList constantly.  The index is loaded on first use
+ *  and kept current from RECORDING_LIST_CHANGE, MASTER_UPDATE_REC_INFO and
+ *  UPDATE_FILE_SIZE events; anything that can't be applied in place just
+ *  marks it stale so the next query reloads it.
+ *
+ *  Which recordings are in use, being commercial flagged or still recording
+ *  changes without any event, so that is looked up per query and applied
+ *  to the page being returned only.
+ */
+class RecordingIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static RecordingIndex *GetInstance(void);
+
+    QString Query(ProgramList &page, int &totalAvailable,
+                  bool descending, int startIndex, int count,
+                  const QString &titleRegEx, const QString &recGroup,
+                  const QString &storageGroup);
+
+  protected:
+    RecordingIndex(void);
+    virtual void customEvent(QEvent *event);
+
+  private:
+    void LoadIfStale(const QMap<QString,bool> &isJobRunning);
+    void Invalidate(void);
+    void Remove(uint recordedid);
+    void UpdateFileSize(uint recordedid, uint64_t filesize);
+
+    static RecordingIndex *s_instance;
+    static QMutex          s_instanceLock;
+
+    QMutex      m_lock;
+    ProgramList m_list;       ///< ascending by recording start
+    bool        m_stale;
+    uint        m_generation; ///< bumped on every change
+    QDateTime   m_loaded;
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
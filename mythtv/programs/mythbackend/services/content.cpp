@@ -35,6 +35,7 @@
 #include "mythcorecontext.h"
 #include "storagegroup.h"
 #include "programinfo.h"
+#include "previewcache.h"
 #include "previewgenerator.h"
 #include "backendutil.h"
 #include "httprequest.h"
@@ -544,7 +545,9 @@ QFileInfo Content::GetPreviewImage(        int        nRecordedId,
     QString sFileName = GetPlaybackURL(&pginfo);
 
     // ----------------------------------------------------------------------
-    // check to see if default preview image is already created.
+    // check to see if the full size preview image is already created.
+    // The default one lives next to the recording where the preview
+    // queue and the frontends look for it, any other goes in the cache.
     // ----------------------------------------------------------------------
 
     QString sPreviewFileName;
@@ -556,7 +559,11 @@ QFileInfo Content::GetPreviewImage(        int        nRecordedId,
     }
     else
     {
-        sPreviewFileName = QString("%1.%2.png").arg(sFileName).arg(nSecsIn);
+        QString sKey = PreviewCache::GetKey(pginfo, sFileName, nSecsIn, true,
+                                            QSize(0, 0), "png");
+        sPreviewFileName = PreviewCache::Find(sKey, "png");
+        if (sPreviewFileName.isEmpty())
+            sPreviewFileName = PreviewCache::GetPath(sKey, "png");
     }
 
     if (!QFile::exists( sPreviewFileName ))
@@ -586,61 +593,44 @@ QFileInfo Content::GetPreviewImage(        int        nRecordedId,
 
     bool bDefaultPixmap = (nWidth == 0) && (nHeight == 0);
 
-    QString sNewFileName;
-
     if (bDefaultPixmap)
-        sNewFileName = sPreviewFileName;
-    else
-    {
-        sNewFileName = QString( "%1.%2.%3x%4.%5" )
-                          .arg( sFileName )
-                          .arg( nSecsIn   )
-                          .arg( nWidth == 0 ? -1 : nWidth )
-                          .arg( nHeight == 0 ? -1 : nHeight )
-                          .arg( sImageFormat.toLower() );
-
-        // ----------------------------------------------------------------------
-        // check to see if scaled preview image is already created and isn't
-        // out of date
-        // ----------------------------------------------------------------------
-        if (QFile::exists( sNewFileName ))
-        {
-            if (QFileInfo(sPreviewFileName).lastModified() <=
-                QFileInfo(sNewFileName).lastModified())
-                return QFileInfo( sNewFileName );
-        }
+        return QFileInfo( sPreviewFileName );
 
-        QImage image = QImage(sPreviewFileName);
+    // ----------------------------------------------------------------------
+    // check to see if scaled preview image is already cached and isn't
+    // out of date
+    // ----------------------------------------------------------------------
 
-        if (image.isNull())
-            return QFileInfo();
+    QString sKey = PreviewCache::GetKey(pginfo, sFileName, nSecsIn, true,
+                                        QSize(nWidth, nHeight), sImageFormat);
+    QString sNewFileName = PreviewCache::Find(sKey, sImageFormat,
+                                              sPreviewFileName);
 
-        // We can just re-scale the default (full-size version) to avoid
-        // a preview generator run
-        if ( nWidth <= 0 )
-            image = image.scaledToHeight(nHeight, Qt::SmoothTransformation);
-        else if ( nHeight <= 0 )
-            image = image.scaledToWidth(nWidth, Qt::SmoothTransformation);
-        else
-            image = image.scaled(nWidth, nHeight, Qt::IgnoreAspectRatio,
-                                        Qt::SmoothTransformation);
-
-        image.save(sNewFileName, sImageFormat.toUpper().toLocal8Bit());
-
-        // Let anybody update it
-        bool ret = makeFileAccessible(sNewFileName.toLocal8Bit().constData());
-        if (!ret)
-        {
-            LOG(VB_GENERAL, LOG_ERR, "Unable to change permissions on "
-                                     "preview image. Backends and frontends "
-                                     "running under different users will be "
-                                     "unable to access it");
-        }
-    }
+    if (!sNewFileName.isEmpty())
+        return QFileInfo( sNewFileName );
 
-    if (QFile::exists( sNewFileName ))
+    QImage image = QImage(sPreviewFileName);
+
+    if (image.isNull())
+        return QFileInfo();
+
+    // We can just re-scale the default (full-size version) to avoid
+    // a preview generator run
+    if ( nWidth <= 0 )
+        image = image.scaledToHeight(nHeight, Qt::SmoothTransformation);
+    else if ( nHeight <= 0 )
+        image = image.scaledToWidth(nWidth, Qt::SmoothTransformation);
+    else
+        image = image.scaled(nWidth, nHeight, Qt::IgnoreAspectRatio,
+                                    Qt::SmoothTransformation);
+
+    sNewFileName = PreviewCache::Store(sKey, sImageFormat, image);
+
+    if (!sNewFileName.isEmpty())
         return QFileInfo( sNewFileName );
 
+    sNewFileName = PreviewCache::GetPath(sKey, sImageFormat);
+
     PreviewGenerator *previewgen = new PreviewGenerator( &pginfo,
                                                          QString(),
                                                          PreviewGenerator::kLocal);
@@ -38,6 +38,7 @@
 #include "encoderlink.h"
 #include "remoteutil.h"
 #include "mythdate.h"
+#include "recordingindex.h"
 #include "recordinginfo.h"
 #include "cardutil.h"
 #include "inputinfo.h"
@@ -66,66 +67,31 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
                                         const QString &sRecGroup,
                                         const QString &sStorageGroup )
 {
-    QMap< QString, ProgramInfo* > recMap;
-
-    if (gCoreContext->GetScheduler())
-        recMap = gCoreContext->GetScheduler()->GetRecording();
-
-    QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
-    QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
-
     ProgramList progList;
+    int         nAvailable = 0;
 
-    int desc = 1;
-    if (bDescending)
-        desc = -1;
-
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc );
-
-    QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
-
-    for (; mit != recMap.end(); mit = recMap.erase(mit))
-        delete *mit;
+    QString sETag = RecordingIndex::GetInstance()->Query(
+        progList, nAvailable, bDescending, nStartIndex, nCount,
+        sTitleRegEx, sRecGroup, sStorageGroup );
 
     // ----------------------------------------------------------------------
     // Build Response
     // ----------------------------------------------------------------------
 
     DTC::ProgramList *pPrograms = new DTC::ProgramList();
-    int nAvailable = 0;
-
-    int nMax      = (nCount > 0) ? nCount : progList.size();
-
-    nAvailable = 0;
-    nCount = 0;
-
-    QRegExp rTitleRegEx        = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
 
     for( unsigned int n = 0; n < progList.size(); n++)
     {
-        ProgramInfo *pInfo = progList[ n ];
-
-        if (pInfo->IsDeletePending() ||
-            (!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)) ||
-            (!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
-            (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()))
-            continue;
-
-        if ((nAvailable < nStartIndex) ||
-            (nCount >= nMax))
-        {
-            ++nAvailable;
-            continue;
-        }
-
-        ++nAvailable;
-        ++nCount;
-
         DTC::Program *pProgram = pPrograms->AddNewProgram();
 
-        FillProgramInfo( pProgram, pInfo, true );
+        FillProgramInfo( pProgram, progList[ n ], true );
     }
 
+    nCount = progList.size();
+
+    // Lets ServiceHost answer an unchanged list with a 304
+    pPrograms->setProperty( "ETag", sETag );
+
     // ----------------------------------------------------------------------
 
     pPrograms->setStartIndex    ( nStartIndex     );
@@ -25,6 +25,8 @@
 
 #include <math.h>
 
+#include <QCryptographicHash>
+
 #include "guide.h"
 
 #include "compat.h"
@@ -35,6 +37,7 @@
 #include "channelutil.h"
 #include "channelgroup.h"
 #include "storagegroup.h"
+#include "guidecache.h"
 
 #include "mythlogging.h"
 
@@ -71,48 +74,19 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
         nCount = 20000;
 
     // ----------------------------------------------------------------------
-    // Load the channel list
-    // ----------------------------------------------------------------------
-
-    uint nTotalAvailable = 0;
-    ChannelInfoList chanList = ChannelUtil::LoadChannels(nStartIndex, nCount,
-                                                         nTotalAvailable, true,
-                                                         ChannelUtil::kChanOrderByChanNum,
-                                                         ChannelUtil::kChanGroupByCallsign,
-                                                         0,
-                                                         nChannelGroupId);
-
-    // ----------------------------------------------------------------------
-    // Build SQL statement for Program Listing
+    // Load the channel list and the slots of guide data covering the window
     // ----------------------------------------------------------------------
 
-    ProgramList  schedList;
-    MSqlBindings bindings;
-
-    QString sWhere   = "program.chanid = :CHANID "
-                       "AND program.endtime >= :STARTDATE "
-                       "AND program.starttime < :ENDDATE "
-                       "AND program.starttime >= :STARTDATELIMIT "
-                       "AND program.manualid = 0"; // Omit 'manual' recordings scheds
-
-    QString sGroupBy = "program.starttime, channel.channum,"
-                       "channel.callsign, program.title";
-
-    QString sOrderBy = "program.starttime";
+    GuideCache *pCache = GuideCache::GetInstance();
 
-    bindings[":STARTDATE"     ] = dtStartTime;
-    bindings[":STARTDATELIMIT"] = dtStartTime.addDays(-1);
-    bindings[":ENDDATE"       ] = dtEndTime;
+    QString sETag = pCache->GetETag();
 
-    // ----------------------------------------------------------------------
-    // Get all Pending Scheduled Programs
-    // ----------------------------------------------------------------------
+    uint nTotalAvailable = 0;
+    ChannelInfoList chanList = pCache->GetChannels(nChannelGroupId, nStartIndex,
+                                                   nCount, nTotalAvailable);
 
-    // NOTE: Fetching this information directly from the schedule is
-    //       significantly faster than using ProgramInfo::LoadFromScheduler()
-    Scheduler *scheduler = dynamic_cast<Scheduler*>(gCoreContext->GetScheduler());
-    if (scheduler)
-        scheduler->GetAllPending(schedList);
+    GuideWindow window = pCache->GetWindow(nChannelGroupId,
+                                           dtStartTime, dtEndTime);
 
     // ----------------------------------------------------------------------
     // Build Response
@@ -128,14 +102,9 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
         pChannel = pGuide->AddNewChannel();
         FillChannelInfo( pChannel, (*chan_it), bDetails );
 
-        // Load the list of programmes for this channel
-        ProgramList  progList;
-        bindings[":CHANID"] = (*chan_it).chanid;
-        LoadFromProgram( progList, sWhere, sOrderBy, sOrderBy, bindings,
-                         schedList );
-
         // Create Program objects and add them to the channel object
-        ProgramList::iterator progIt;
+        QList<ProgramInfo*> progList = window.GetPrograms( (*chan_it).chanid );
+        QList<ProgramInfo*>::iterator progIt;
         for( progIt = progList.begin(); progIt != progList.end(); ++progIt)
         {
             DTC::Program *pProgram = pChannel->AddNewProgram();
@@ -143,6 +112,15 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
         }
     }
 
+    // The cache only changes when it is invalidated, so that and the
+    // parameters identify the result.
+    pGuide->setProperty( "ETag", QString( QCryptographicHash::hash(
+        QString( "%1 %2 %3 %4 %5 %6 %7" ).arg( sETag )
+            .arg( MythDate::toString( dtStartTime, MythDate::kFilename ))
+            .arg( MythDate::toString( dtEndTime, MythDate::kFilename ))
+            .arg( bDetails ).arg( nChannelGroupId ).arg( nStartIndex )
+            .arg( nCount ).toUtf8(), QCryptographicHash::Sha1 ).toHex()));
+
     // ----------------------------------------------------------------------
 
     pGuide->setStartTime    ( dtStartTime   );
@@ -720,7 +720,10 @@ bool Myth::PutSetting( const QString &sHostName,
     if (!sKey.isEmpty())
     {
         if ( gCoreContext->SaveSettingOnHost( sKey, sValue, sHostName ) )
+        {
+            gCoreContext->SendSettingChanged( sKey, sHostName );
             bResult = true;
+        }
 
         return bResult;
     }
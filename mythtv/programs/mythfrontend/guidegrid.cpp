@@ -356,6 +356,40 @@ public:
     QVector<bool> m_unavailables;
 };
 
+// Loads the guide data for rows just off the screen into the guide cache.
+class GuideUpdatePrefetch : public GuideUpdaterBase
+{
+public:
+    GuideUpdatePrefetch(GuideGrid *guide, uint startChan,
+                        const QDateTime &startTime,
+                        const QDateTime &start, const QDateTime &end,
+                        const QVector<uint> &chanids)
+        : GuideUpdaterBase(guide), m_currentStartChannel(startChan),
+          m_currentStartTime(startTime),
+          m_start(start), m_end(end), m_chanids(chanids) {}
+    virtual bool ExecuteNonUI(void)
+    {
+        for (int i = 0; i < m_chanids.size(); ++i)
+        {
+            // Stop if the guide has moved on since this was queued
+            if (m_currentStartChannel != m_guide->GetCurrentStartChannel() ||
+                m_currentStartTime != m_guide->GetCurrentStartTime())
+                break;
+            if (!m_guide->IsGuideDataCached(m_chanids[i], m_start, m_end))
+                delete m_guide->LoadGuideData(m_chanids[i], m_start, m_end);
+        }
+        return false;
+    }
+    virtual void ExecuteUI(void) {}
+
+private:
+    const uint m_currentStartChannel;
+    const QDateTime m_currentStartTime;
+    const QDateTime m_start;
+    const QDateTime m_end;
+    const QVector<uint> m_chanids;
+};
+
 class UpdateGuideEvent : public QEvent
 {
 public:
@@ -518,6 +552,9 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
            m_channelOrdering(gCoreContext->GetSetting("ChannelOrdering", "channum")),
            m_updateTimer(new QTimer(this)),
            m_threadPool("GuideGridHelperPool"),
+           m_guideCache(20000),
+           m_timeScroll(1),
+           m_channelScroll(1),
            m_changrpid(changrpid),
            m_changrplist(ChannelGroup::GetChannelGroups(false)),
            m_jumpToChannelLock(QMutex::Recursive),
@@ -1236,6 +1273,23 @@ static ProgramList *CopyProglist(ProgramList *proglist)
     return result;
 }
 
+// Copies the programs that the guide query would return for the given times
+static ProgramList *CopyProglist(ProgramList *proglist, const QDateTime &start,
+                                 const QDateTime &end)
+{
+    ProgramList *result = new ProgramList();
+    QDateTime startlimit = start.addDays(-1);
+    for (ProgramList::iterator pi = proglist->begin();
+         pi != proglist->end(); ++pi)
+    {
+        if ((*pi)->GetScheduledEndTime() >= start &&
+            (*pi)->GetScheduledStartTime() <= end &&
+            (*pi)->GetScheduledStartTime() >= startlimit)
+            result->push_back(new ProgramInfo(**pi));
+    }
+    return result;
+}
+
 uint GuideGrid::GetAlternateChannelIndex(
     uint chan_idx, bool with_same_channum) const
 {
@@ -1559,25 +1613,62 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
 
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
-    ProgramList *proglist = new ProgramList();
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
 
-    if (proglist)
-    {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
-        QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    return LoadGuideData(GetChannelInfo(chanNum)->chanid, starttime, endtime);
+}
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
+bool GuideGrid::IsGuideDataCached(uint chanid, const QDateTime &start,
+                                  const QDateTime &end) const
+{
+    QMutexLocker locker(&m_guideCacheLock);
+    GuideCacheEntry *entry = m_guideCache.object(chanid);
+    return entry && entry->m_start <= start && entry->m_end >= end;
+}
+
+/**
+ *  \brief Returns the programs on a channel between two times, from the
+ *         guide cache when it covers them.
+ *
+ *  A miss loads the channel from the database for a span one screen wider
+ *  than asked for on each side, and another screen further in the direction
+ *  the guide last scrolled, so that the next few scrolls are served from
+ *  memory. The cache is dropped when the schedule changes.
+ */
+ProgramList *GuideGrid::LoadGuideData(uint chanid, const QDateTime &start,
+                                      const QDateTime &end)
+{
+    {
+        QMutexLocker locker(&m_guideCacheLock);
+        GuideCacheEntry *cached = m_guideCache.object(chanid);
+        if (cached && cached->m_start <= start && cached->m_end >= end)
+            return CopyProglist(&cached->m_programs, start, end);
     }
 
+    int span = start.secsTo(end);
+    GuideCacheEntry *entry = new GuideCacheEntry(
+        start.addSecs(-span * (m_timeScroll < 0 ? 2 : 1)),
+        end.addSecs(span * (m_timeScroll > 0 ? 2 : 1)));
+
+    MSqlBindings bindings;
+    QString querystr = "WHERE program.chanid = :CHANID "
+                       "  AND program.endtime >= :STARTTS "
+                       "  AND program.starttime <= :ENDTS "
+                       "  AND program.starttime >= :STARTLIMITTS "
+                       "  AND program.manualid = 0 ";
+    bindings[":CHANID"]  = chanid;
+    bindings[":STARTTS"] = entry->m_start;
+    bindings[":STARTLIMITTS"] = entry->m_start.addDays(-1);
+    bindings[":ENDTS"] = entry->m_end;
+
+    LoadFromProgram(entry->m_programs, querystr, bindings, m_recList);
+
+    ProgramList *proglist = CopyProglist(&entry->m_programs, start, end);
+
+    QMutexLocker locker(&m_guideCacheLock);
+    m_guideCache.insert(chanid, entry, entry->m_programs.size() + 1);
+
     return proglist;
 }
 
@@ -1646,6 +1737,42 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
     GuideUpdateProgramRow *updater =
         new GuideUpdateProgramRow(this, gs, proglists);
     m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+        prefetchProgramRows();
+}
+
+/**
+ *  \brief Queues loading the page of channels after the current one, or
+ *         before it when scrolling up, into the guide cache.
+ */
+void GuideGrid::prefetchProgramRows(void)
+{
+    int numChans = m_channelInfos.size();
+    if (numChans <= m_channelCount)
+        return;
+
+    QVector<uint> chanids;
+    for (int i = 0; i < m_channelCount; ++i)
+    {
+        int chanNum = m_currentStartChannel +
+            (m_channelScroll < 0 ? -1 - i : m_channelCount + i);
+        chanNum = ((chanNum % numChans) + numChans) % numChans;
+
+        const ChannelInfo *chinfo = GetChannelInfo(chanNum);
+        if (chinfo)
+            chanids.push_back(chinfo->chanid);
+    }
+
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+
+    GuideUpdatePrefetch *updater =
+        new GuideUpdatePrefetch(this, m_currentStartChannel,
+                                m_currentStartTime, starttime, endtime,
+                                chanids);
+    // Queued behind updates of what is on screen, the pool has one thread
+    m_threadPool.start(new GuideHelper(this, updater), "GuideHelper", 1);
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row, int chanNum,
@@ -1893,6 +2020,11 @@ void GuideGrid::customEvent(QEvent *event)
         {
             GuideHelper::Wait(this);
             LoadFromScheduler(m_recList);
+            // Cached programs carry the old recording status. The backend
+            // also reschedules after new guide data, so this drops that too.
+            m_guideCacheLock.lock();
+            m_guideCache.clear();
+            m_guideCacheLock.unlock();
             fillProgramInfos();
         }
         else if (message == "STOP_VIDEO_REFRESH_TIMER")
@@ -2464,6 +2596,12 @@ void GuideGrid::cursorUp()
 
 void GuideGrid::moveLeftRight(MoveVector movement)
 {
+    if (movement == kScrollLeft || movement == kPageLeft ||
+        movement == kDayLeft)
+        m_timeScroll = -1;
+    else
+        m_timeScroll = 1;
+
     switch (movement)
     {
         case kScrollLeft :
@@ -2495,6 +2633,11 @@ void GuideGrid::moveLeftRight(MoveVector movement)
 
 void GuideGrid::moveUpDown(MoveVector movement)
 {
+    if (movement == kScrollUp || movement == kPageUp)
+        m_channelScroll = -1;
+    else
+        m_channelScroll = 1;
+
     switch (movement)
     {
         case kScrollDown :
@@ -11,6 +11,8 @@ using namespace std;
 #include <QDateTime>
 #include <QEvent>
 #include <QLinkedList>
+#include <QCache>
+#include <QMutex>
 
 // myth
 #include "mythscreentype.h"
@@ -37,6 +39,18 @@ typedef vector<ChannelInfo>   db_chan_list_t;
 typedef vector<db_chan_list_t> db_chan_list_list_t;
 typedef ProgramInfo *ProgInfoGuideArray[MAX_DISPLAY_CHANS][MAX_DISPLAY_TIMES];
 
+/// Programs on one channel between two times, see GuideGrid::LoadGuideData()
+class GuideCacheEntry
+{
+  public:
+    GuideCacheEntry(const QDateTime &start, const QDateTime &end)
+        : m_start(start), m_end(end) {}
+
+    QDateTime   m_start;
+    QDateTime   m_end;
+    ProgramList m_programs;
+};
+
 class JumpToChannel;
 class JumpToChannelListener
 {
@@ -208,9 +222,14 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void fillProgramInfos(bool useExistingData = false);
     // Set row=-1 to fill all rows.
     void fillProgramRowInfos(int row, bool useExistingData);
+    void prefetchProgramRows(void);
 public:
     // These need to be public so that the helper classes can operate.
     ProgramList *getProgramListFromProgram(int chanNum);
+    ProgramList *LoadGuideData(uint chanid, const QDateTime &start,
+                               const QDateTime &end);
+    bool IsGuideDataCached(uint chanid, const QDateTime &start,
+                           const QDateTime &end) const;
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -277,6 +296,15 @@ private:
 
     MThreadPool       m_threadPool;
 
+    /// Programs by chanid over a wider span than is shown, so that scrolling
+    /// the grid rarely has to wait for the database
+    QCache<uint, GuideCacheEntry> m_guideCache;
+    mutable QMutex    m_guideCacheLock;
+    /// Direction of the last scroll through time, -1 earlier or 1 later
+    int               m_timeScroll;
+    /// Direction of the last scroll through channels, -1 up or 1 down
+    int               m_channelScroll;
+
     int               m_changrpid;
     ChannelGroupList  m_changrplist;
 
@@ -83,6 +83,7 @@ using namespace std;
 #include "taskqueue.h"
 #include "cleanupguard.h"
 #include "standardsettings.h"
+#include "startuptrace.h"
 
 // Video
 #include "cleanup.h"
@@ -197,6 +198,55 @@ namespace
         ParentalLevelChangeChecker m_plcc;
     };
 
+    /** \brief Initializes the plugins left pending at startup one per timer
+     *         tick, so that the main menu is drawn and responsive first.
+     */
+    class DeferredPluginInit : public QObject
+    {
+        Q_OBJECT
+
+      public:
+        static void Create(MythPluginManager *manager)
+        {
+            new DeferredPluginInit(manager);
+        }
+
+      private:
+        explicit DeferredPluginInit(MythPluginManager *manager) :
+            QObject(qApp), m_manager(manager)
+        {
+            connect(&m_timer, SIGNAL(timeout()), SLOT(InitNext()));
+            m_timer.start(kInterval);
+        }
+
+        ~DeferredPluginInit() {}
+
+      private slots:
+        void InitNext(void)
+        {
+            QStringList pending = m_manager->GetPendingPlugins();
+
+            if (pending.isEmpty())
+            {
+                m_timer.stop();
+                StartupTrace::Finish();
+                deleteLater();
+                return;
+            }
+
+            StartupTrace::Mark("Plugin " + pending.first());
+            m_manager->init_plugin(pending.first());
+            StartupTrace::EndPhase();
+        }
+
+      private:
+        /// Gap left between plugins for drawing and input, in milliseconds
+        static const int   kInterval = 50;
+
+        MythPluginManager *m_manager;
+        QTimer             m_timer;
+    };
+
     class BookmarkDialog : MythScreenType
     {
         Q_DECLARE_TR_FUNCTIONS(BookmarkDialog)
@@ -1865,6 +1915,8 @@ int main(int argc, char **argv)
         MythUIHelper::ParseGeometryOverride(cmdline.toString("geometry"));
     }
 
+    StartupTrace::Mark("Database connection");
+
     gContext = new MythContext(MYTH_BINARY_VERSION, true);
     gCoreContext->SetAsFrontend(true);
 
@@ -1874,6 +1926,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_NO_MYTHCONTEXT;
     }
 
+    StartupTrace::Mark("Settings");
+
     cmdline.ApplySettingsOverride();
 
     if (!GetMythDB()->HaveSchema())
@@ -1948,6 +2002,8 @@ int main(int argc, char **argv)
     if (LCD *lcd = LCD::Get())
         lcd->setupLEDs(RemoteGetRecordingMask);
 
+    StartupTrace::Mark("Theme");
+
     MythTranslation::load("mythfrontend");
 
     QString themename = gCoreContext->GetSetting("Theme", DEFAULT_UI_THEME);
@@ -1971,6 +2027,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_NO_THEME;
     }
 
+    StartupTrace::Mark("Main window and fonts");
+
     MythMainWindow *mainWindow = GetMythMainWindow();
 #if CONFIG_DARWIN
     mainWindow->Init(QT_PAINTER);
@@ -2001,6 +2059,8 @@ int main(int argc, char **argv)
             return GENERIC_EXIT_NO_THEME;
     }
 
+    StartupTrace::Mark("Database schema");
+
     if (!UpgradeTVDatabaseSchema(false))
     {
         LOG(VB_GENERAL, LOG_ERR,
@@ -2008,6 +2068,8 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_DB_OUTOFDATE;
     }
 
+    StartupTrace::Mark("Default settings and keys");
+
     WriteDefaults();
 
     // Refresh Global/Main Menu keys after DB update in case there was no DB
@@ -2025,9 +2087,15 @@ int main(int argc, char **argv)
 
     setHttpProxy();
 
-    pmanager = new MythPluginManager();
+    // Plugins are only found here, they are initialized once the main menu
+    // is up (see DeferredPluginInit) or when first used
+    StartupTrace::Mark("Plugins");
+
+    pmanager = new MythPluginManager(true);
     gCoreContext->SetPluginManager(pmanager);
 
+    StartupTrace::Mark("Media monitor");
+
     MediaMonitor *mon = MediaMonitor::GetMediaMonitor();
     if (mon)
     {
@@ -2035,6 +2103,8 @@ int main(int argc, char **argv)
         mainWindow->installEventFilter(mon);
     }
 
+    StartupTrace::Mark("Network control");
+
     NetworkControl *networkControl = NULL;
     if (gCoreContext->GetNumSetting("NetworkControlEnabled", 0))
     {
@@ -2046,6 +2116,8 @@ int main(int argc, char **argv)
                    .arg(port));
     }
 
+    StartupTrace::Mark("Main menu");
+
 #if CONFIG_DARWIN
     GetMythMainWindow()->SetEffectsEnabled(false);
     GetMythMainWindow()->Init(OPENGL2_PAINTER);
@@ -2057,6 +2129,9 @@ int main(int argc, char **argv)
     {
         return GENERIC_EXIT_NO_THEME;
     }
+
+    StartupTrace::Mark("Background services");
+
     ThemeUpdateChecker *themeUpdateChecker = NULL;
     if (gCoreContext->GetNumSetting("ThemeUpdateNofications", 1))
         themeUpdateChecker = new ThemeUpdateChecker();
@@ -2100,6 +2175,10 @@ int main(int argc, char **argv)
     {
         MythMainWindow *mmw = GetMythMainWindow();
 
+        // The jump point may belong to a plugin
+        StartupTrace::Mark("Plugins for jump point");
+        pmanager->InitPendingPlugins();
+
         if (mmw->DestinationExists(cmdline.toString("jumppoint")))
             mmw->JumpTo(cmdline.toString("jumppoint"));
         else
@@ -2122,6 +2201,9 @@ int main(int argc, char **argv)
         standbyScreen();
     }
 
+    StartupTrace::EndPhase();
+    DeferredPluginInit::Create(pmanager);
+
     int ret = qApp->exec();
 
     if (ret==0)
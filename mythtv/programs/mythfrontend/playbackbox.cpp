@@ -1,6 +1,9 @@
 
 #include "playbackbox.h"
 
+// C++
+#include <algorithm>
+
 // QT
 #include <QCoreApplication>
 #include <QDateTime>
@@ -208,6 +211,43 @@ static bool comp_season_rev_less_than(
     return comp_season_rev(a, b) < 0;
 }
 
+// The order of the "All Programs" page, which follows the program cache
+static bool comp_recstart_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    if (a->GetRecordingStartTime() == b->GetRecordingStartTime())
+        return a->GetChanID() < b->GetChanID();
+    return a->GetRecordingStartTime() < b->GetRecordingStartTime();
+}
+
+static bool comp_recstart_rev_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    if (a->GetRecordingStartTime() == b->GetRecordingStartTime())
+        return a->GetChanID() > b->GetChanID();
+    return a->GetRecordingStartTime() > b->GetRecordingStartTime();
+}
+
+typedef bool (*ProgramLessThan)(const ProgramInfo *, const ProgramInfo *);
+
+// The order of the episodes on each page, or NULL to leave them unsorted
+static ProgramLessThan episode_sort(const QString &episodeSort, int listOrder)
+{
+    if (episodeSort == "OrigAirDate")
+        return (listOrder == 0) ? comp_originalAirDate_rev_less_than :
+                                  comp_originalAirDate_less_than;
+    if (episodeSort == "Id")
+        return (listOrder == 0) ? comp_programid_rev_less_than :
+                                  comp_programid_less_than;
+    if (episodeSort == "Date")
+        return (listOrder == 0) ? comp_recordDate_rev_less_than :
+                                  comp_recordDate_less_than;
+    if (episodeSort == "Season")
+        return (listOrder == 0) ? comp_season_rev_less_than :
+                                  comp_season_less_than;
+    return NULL;
+}
+
 static const uint s_artDelay[] =
     { kArtworkFanTimeout, kArtworkBannerTimeout, kArtworkCoverTimeout,};
 
@@ -429,6 +469,7 @@ PlaybackBox::PlaybackBox(MythScreenStack *parent, QString name,
       m_programInfoCache(this),           m_playingSomething(false),
       // Selection state variables
       m_needUpdate(false),
+      m_updateUIListQueued(false),
       m_haveGroupInfoSet(false),
       // Other
       m_player(NULL),
@@ -571,6 +612,9 @@ bool PlaybackBox::Create()
     connect(m_recordingList, SIGNAL(itemLoaded(MythUIButtonListItem*)),
             SLOT(ItemLoaded(MythUIButtonListItem*)));
 
+    // Large recording lists are only filled in around the items shown
+    m_recordingList->SetPrefetchMargin(50);
+
     // connect up timers...
     connect(m_artTimer[kArtworkFanart],   SIGNAL(timeout()), SLOT(fanartLoad()));
     connect(m_artTimer[kArtworkBanner],   SIGNAL(timeout()), SLOT(bannerLoad()));
@@ -1598,6 +1642,109 @@ static void restore_position(
     }
 }
 
+/// Whether a recording is shown when viewing the current recording group
+bool PlaybackBox::IsInView(const ProgramInfo *p)
+{
+    const QString& pRecgroup(p->GetRecordingGroup());
+
+    // Never show anything from unauthorised passworded groups
+    QString password = getRecGroupPassword(pRecgroup);
+    if (m_curGroupPassword != password && !password.isEmpty())
+        return false;
+
+    // Filter nothing from Deleted group
+    // Never show Deleted recs anywhere else
+    if (pRecgroup == "Deleted")
+        return m_recGroup == "Deleted";
+
+    if (pRecgroup.startsWith('.'))
+        return false;
+
+    // Optionally ignore LiveTV programs if not viewing LiveTV group
+    if (!(m_viewMask & VIEW_LIVETVGRP) &&
+        m_recGroup != "LiveTV" && pRecgroup == "LiveTV")
+        return false;
+
+    // Optionally ignore watched
+    if (!(m_viewMask & VIEW_WATCHED) && p->IsWatched())
+        return false;
+
+    // Filter by category
+    if (m_recGroupType.value(m_recGroup) == "category")
+    {
+        if (m_recGroup == tr("Unknown"))
+            return p->GetCategory().isEmpty();
+        return p->GetCategory() == m_recGroup;
+    }
+
+    // Filter by recgroup
+    return m_recGroup == "All Programs" || pRecgroup == m_recGroup;
+}
+
+/**
+ *  \brief Returns the title, recording group and category pages that a
+ *         recording in view is listed on, adding their names to sortedList.
+ *
+ *  The "All Programs", search rule and watch list pages are not included.
+ */
+QStringList PlaybackBox::GetPageKeys(const ProgramInfo *p,
+                                     ViewTitleSort titleSort,
+                                     QMap<QString, QString> &sortedList) const
+{
+    QStringList keys;
+
+    const QString& pRecgroup(p->GetRecordingGroup());
+    const bool     isLiveTVProg(pRecgroup == "LiveTV");
+    const bool     isLiveTvGroup(m_recGroup == "LiveTV");
+
+    if (!isLiveTvGroup && isLiveTVProg && (m_viewMask & VIEW_LIVETVGRP))
+    {
+        QString tmpTitle = tr("Live TV");
+        sortedList[tmpTitle.toLower()] = tmpTitle;
+        keys << tmpTitle.toLower();
+        return keys;
+    }
+
+    // Show titles
+    if ((m_viewMask & VIEW_TITLES) && (!isLiveTVProg || isLiveTvGroup))
+    {
+        QString sTitle = construct_sort_title(
+                    p->GetTitle(), m_viewMask, titleSort,
+                    p->GetRecordingPriority(), m_prefixes);
+        sTitle = sTitle.toLower();
+
+        if (!sortedList.contains(sTitle))
+            sortedList[sTitle] = p->GetTitle();
+        keys << sortedList[sTitle].toLower();
+    }
+
+    // Show recording groups
+    if ((m_viewMask & VIEW_RECGROUPS) &&
+        !pRecgroup.isEmpty() && !isLiveTVProg)
+    {
+        sortedList[pRecgroup.toLower()] = pRecgroup;
+        keys << pRecgroup.toLower();
+    }
+
+    // Show categories
+    if ((m_viewMask & VIEW_CATEGORIES) && !p->GetCategory().isEmpty())
+    {
+        QString catl = p->GetCategory().toLower();
+        sortedList[catl] = p->GetCategory();
+        keys << catl;
+    }
+
+    return keys;
+}
+
+void PlaybackBox::AddToPage(const QString &key, ProgramInfo *p)
+{
+    ProgramList &list = m_progLists[key];
+    list.push_front(p);
+    list.setAutoDelete(false);
+    m_recordingGroups[p->GetRecordingID()].push_back(key);
+}
+
 bool PlaybackBox::UpdateUILists(void)
 {
     m_isFilling = true;
@@ -1631,6 +1778,7 @@ bool PlaybackBox::UpdateUILists(void)
     m_progsInDB = 0;
     m_titleList.clear();
     m_progLists.clear();
+    m_recordingGroups.clear();
     m_recordingList->Reset();
     m_groupList->Reset();
     if (m_recgroupList)
@@ -1651,8 +1799,6 @@ bool PlaybackBox::UpdateUILists(void)
 
     if (!m_programInfoCache.empty())
     {
-        QString sTitle;
-
         if ((m_viewMask & VIEW_SEARCHES))
         {
             MSqlQuery query(MSqlQuery::InitCon());
@@ -1671,10 +1817,6 @@ bool PlaybackBox::UpdateUILists(void)
             }
         }
 
-        bool isCategoryFilter  = (m_recGroupType[m_recGroup] == "category");
-        bool isUnknownCategory = (m_recGroup == tr("Unknown"));
-        bool isAllProgsGroup   = (m_recGroup == "All Programs");
-        bool isDeletedGroup    = (m_recGroup == "Deleted");
         bool isLiveTvGroup     = (m_recGroup == "LiveTV");
 
         vector<ProgramInfo*> list;
@@ -1689,53 +1831,18 @@ bool PlaybackBox::UpdateUILists(void)
 
             m_progsInDB++;
 
-            const QString& pRecgroup(p->GetRecordingGroup());
-            const bool     isLiveTVProg(pRecgroup == "LiveTV");
-
-            // Never show anything from unauthorised passworded groups
-            QString password = getRecGroupPassword(pRecgroup);
-            if (m_curGroupPassword != password && !password.isEmpty())
+            if (!IsInView(p))
                 continue;
 
-            if (pRecgroup == "Deleted")
-            {
-                // Filter nothing from Deleted group
-                // Never show Deleted recs anywhere else
-                if (!isDeletedGroup)
-                    continue;
-            }
-            else if (pRecgroup.startsWith('.'))
-            {
-                continue;
-            }
-            // Optionally ignore LiveTV programs if not viewing LiveTV group
-            else if (!(m_viewMask & VIEW_LIVETVGRP) &&
-                     !isLiveTvGroup && isLiveTVProg)
-            {
-                continue;
-            }
-            // Optionally ignore watched
-            else if (!(m_viewMask & VIEW_WATCHED) && p->IsWatched())
-            {
-                continue;
-            }
-            else if (isCategoryFilter)
-            {
-                // Filter by category
-                if (isUnknownCategory ? !p->GetCategory().isEmpty()
-                                      : p->GetCategory() != m_recGroup)
-                    continue;
-            }
-            // Filter by recgroup
-            else if (!isAllProgsGroup && pRecgroup != m_recGroup)
-                continue;
+            const QString& pRecgroup(p->GetRecordingGroup());
+            const bool     isLiveTVProg(pRecgroup == "LiveTV");
 
             if (p->GetTitle().isEmpty())
                 p->SetTitle(tr("_NO_TITLE_"));
 
             if (m_viewMask != VIEW_NONE && (!isLiveTVProg || isLiveTvGroup))
             {
-                m_progLists[""].push_front(p);
+                AddToPage("", p);
             }
 
             asRecordingID = p->GetRecordingID();
@@ -1744,46 +1851,14 @@ bool PlaybackBox::UpdateUILists(void)
             else
                 p->SetAvailableStatus(asAvailable,  "UpdateUILists");
 
+            QStringList keys = GetPageKeys(p, titleSort, sortedList);
+            QStringList::const_iterator kit = keys.begin();
+            for (; kit != keys.end(); ++kit)
+                AddToPage(*kit, p);
+
+            // LiveTV shown in its own page goes nowhere else
             if (!isLiveTvGroup && isLiveTVProg && (m_viewMask & VIEW_LIVETVGRP))
-            {
-                QString tmpTitle = tr("Live TV");
-                sortedList[tmpTitle.toLower()] = tmpTitle;
-                m_progLists[tmpTitle.toLower()].push_front(p);
-                m_progLists[tmpTitle.toLower()].setAutoDelete(false);
                 continue;
-            }
-
-            // Show titles
-            if ((m_viewMask & VIEW_TITLES) && (!isLiveTVProg || isLiveTvGroup))
-            {
-                sTitle = construct_sort_title(
-                            p->GetTitle(), m_viewMask, titleSort,
-                            p->GetRecordingPriority(), m_prefixes);
-                sTitle = sTitle.toLower();
-
-                if (!sortedList.contains(sTitle))
-                    sortedList[sTitle] = p->GetTitle();
-                m_progLists[sortedList[sTitle].toLower()].push_front(p);
-                m_progLists[sortedList[sTitle].toLower()].setAutoDelete(false);
-            }
-
-            // Show recording groups
-            if ((m_viewMask & VIEW_RECGROUPS) &&
-                !pRecgroup.isEmpty() && !isLiveTVProg)
-            {
-                sortedList[pRecgroup.toLower()] = pRecgroup;
-                m_progLists[pRecgroup.toLower()].push_front(p);
-                m_progLists[pRecgroup.toLower()].setAutoDelete(false);
-            }
-
-            // Show categories
-            if ((m_viewMask & VIEW_CATEGORIES) && !p->GetCategory().isEmpty())
-            {
-                QString catl = p->GetCategory().toLower();
-                sortedList[catl] = p->GetCategory();
-                m_progLists[catl].push_front(p);
-                m_progLists[catl].setAutoDelete(false);
-            }
 
             if ((m_viewMask & VIEW_SEARCHES) &&
                     !searchRule[p->GetRecordingRuleID()].isEmpty() &&
@@ -1792,8 +1867,7 @@ bool PlaybackBox::UpdateUILists(void)
                 QString tmpTitle = QString("(%1)")
                         .arg(searchRule[p->GetRecordingRuleID()]);
                 sortedList[tmpTitle.toLower()] = tmpTitle;
-                m_progLists[tmpTitle.toLower()].push_front(p);
-                m_progLists[tmpTitle.toLower()].setAutoDelete(false);
+                AddToPage(tmpTitle.toLower(), p);
             }
 
             if ((m_viewMask & VIEW_WATCHLIST) &&
@@ -1819,8 +1893,7 @@ bool PlaybackBox::UpdateUILists(void)
                     if (recidEpisodes[p->GetRecordingRuleID()] == 1 ||
                             !p->GetRecordingRuleID())
                     {
-                        m_progLists[m_watchGroupLabel].push_front(p);
-                        m_progLists[m_watchGroupLabel].setAutoDelete(false);
+                        AddToPage(m_watchGroupLabel, p);
                     }
                     else
                     {
@@ -1845,62 +1918,16 @@ bool PlaybackBox::UpdateUILists(void)
         return false;
     }
 
-    QString episodeSort = gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date");
+    ProgramLessThan episodeSort = episode_sort(
+        gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"), m_listOrder);
 
-    if (episodeSort == "OrigAirDate")
-    {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0) ?
-                                 comp_originalAirDate_rev_less_than :
-                                 comp_originalAirDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Id")
-    {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0) ?
-                                 comp_programid_rev_less_than :
-                                 comp_programid_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Date")
+    if (episodeSort)
     {
         QMap<QString, ProgramList>::iterator it;
         for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
         {
             if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder) ?
-                                 comp_recordDate_rev_less_than :
-                                 comp_recordDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Season")
-    {
-        QMap<QString, ProgramList>::iterator it;
-        for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
-        {
-            if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder) ?
-                                 comp_season_rev_less_than :
-                                 comp_season_less_than);
-            }
+                std::stable_sort((*it).begin(), (*it).end(), episodeSort);
         }
     }
 
@@ -4097,6 +4124,7 @@ void PlaybackBox::customEvent(QEvent *event)
         }
         else if (message == "UPDATE_UI_LIST")
         {
+            m_updateUIListQueued = false;
             if (m_playingSomething)
                 m_needUpdate = true;
             else
@@ -4351,14 +4379,30 @@ void PlaybackBox::HandleRecordingRemoveEvent(uint recordingID)
         return;
     }
 
+    RemoveFromUILists(recordingID);
+
+    m_helper.ForceFreeSpaceUpdate();
+}
+
+/**
+ *  \brief Removes a recording from the pages it is listed on, and the pages
+ *         it leaves empty.
+ */
+void PlaybackBox::RemoveFromUILists(uint recordingID)
+{
     MythUIButtonListItem *sel_item = m_groupList->GetItemCurrent();
     QString groupname;
     if (sel_item)
         groupname = sel_item->GetData().toString();
 
-    ProgramMap::iterator git = m_progLists.begin();
-    while (git != m_progLists.end())
+    QStringList keys = m_recordingGroups.take(recordingID);
+    QStringList::const_iterator kit = keys.begin();
+    for (; kit != keys.end(); ++kit)
     {
+        ProgramMap::iterator git = m_progLists.find(*kit);
+        if (git == m_progLists.end())
+            continue;
+
         ProgramList::iterator pit = (*git).begin();
         while (pit != (*git).end())
         {
@@ -4406,20 +4450,114 @@ void PlaybackBox::HandleRecordingRemoveEvent(uint recordingID)
                 if (sel_item)
                     groupname = sel_item->GetData().toString();
             }
-            git = m_progLists.erase(git);
+            m_progLists.erase(git);
         }
         else
         {
-            ++git;
+            MythUIButtonListItem *item =
+                m_groupList->GetItemByData(qVariantFromValue(git.key()));
+            if (item)
+                item->SetText(QString::number((*git).size()), "reccount");
         }
     }
+}
 
-    m_helper.ForceFreeSpaceUpdate();
+/**
+ *  \brief Lists a new recording on its pages without rebuilding the lists.
+ *
+ *  Views with the watch list or search rule pages, and recordings that
+ *  need a page that isn't shown yet, are left to a full rebuild.
+ *  \return False if the lists need to be rebuilt instead.
+ */
+bool PlaybackBox::AddToUILists(ProgramInfo *p)
+{
+    if (m_isFilling || m_playingSomething || m_progLists.isEmpty() ||
+        (m_viewMask & (VIEW_WATCHLIST | VIEW_SEARCHES)))
+        return false;
+
+    if (p->IsDeletePending() || !IsInView(p))
+        return true;
+
+    const bool isLiveTVProg(p->GetRecordingGroup() == "LiveTV");
+    const bool isLiveTvGroup(m_recGroup == "LiveTV");
+
+    if (p->GetTitle().isEmpty())
+        p->SetTitle(tr("_NO_TITLE_"));
+
+    ViewTitleSort titleSort = (ViewTitleSort)gCoreContext->GetNumSetting(
+                                "DisplayGroupTitleSort", TitleSortAlphabetical);
+    QMap<QString, QString> sortedList;
+    QStringList keys = GetPageKeys(p, titleSort, sortedList);
+
+    QStringList::const_iterator kit = keys.begin();
+    for (; kit != keys.end(); ++kit)
+    {
+        ProgramMap::const_iterator git = m_progLists.find(*kit);
+        if (git == m_progLists.end() || (*git).empty())
+            return false;
+    }
+
+    p->SetAvailableStatus(asAvailable, "AddToUILists");
+
+    if (m_viewMask != VIEW_NONE && (!isLiveTVProg || isLiveTvGroup))
+        keys.push_front("");
+
+    ProgramLessThan episodeSort = episode_sort(
+        gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"), m_listOrder);
+    ProgramLessThan allSort = m_allOrder ? comp_recstart_rev_less_than :
+                                           comp_recstart_less_than;
+
+    for (kit = keys.begin(); kit != keys.end(); ++kit)
+    {
+        ProgramLessThan lessThan =
+            (episodeSort && !kit->isEmpty()) ? episodeSort : allSort;
+
+        ProgramList &list = m_progLists[*kit];
+        ProgramList::iterator pos =
+            std::upper_bound(list.begin(), list.end(), p, lessThan);
+        pos = list.insert(pos, p);
+        m_recordingGroups[p->GetRecordingID()].push_back(*kit);
+
+        MythUIButtonListItem *item =
+            m_groupList->GetItemByData(qVariantFromValue(*kit));
+        if (item)
+            item->SetText(QString::number(list.size()), "reccount");
+
+        if (*kit != m_currentGroup)
+            continue;
+
+        // Skip the entries above it that updateRecList() doesn't show
+        int listPos = 0;
+        for (ProgramList::iterator it = list.begin(); it != pos; ++it)
+        {
+            if ((*it)->GetAvailableStatus() != asPendingDelete &&
+                (*it)->GetAvailableStatus() != asDeleted)
+                ++listPos;
+        }
+        new PlaybackBoxListItem(this, m_recordingList, p, listPos);
+
+        if (m_noRecordingsText)
+            m_noRecordingsText->SetVisible(false);
+    }
+
+    return true;
 }
 
 void PlaybackBox::HandleRecordingAddEvent(const ProgramInfo &evinfo)
 {
+    bool isNew = !m_programInfoCache.GetRecordingInfo(evinfo.GetRecordingID());
     m_programInfoCache.Add(evinfo);
+
+    ProgramInfo *pginfo =
+        m_programInfoCache.GetRecordingInfo(evinfo.GetRecordingID());
+    if (isNew && pginfo && !m_programInfoCache.IsLoadInProgress() &&
+        AddToUILists(pginfo))
+    {
+        if (!pginfo->IsDeletePending())
+            m_progsInDB++;
+        return;
+    }
+
     ScheduleUpdateUIList();
 }
 
@@ -4431,8 +4569,8 @@ void PlaybackBox::HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo)
     if (!m_programInfoCache.Update(evinfo))
         return;
 
-    // If the recording group has changed, reload lists from the recently
-    // updated cache; if not, only update UI for the updated item
+    // If the recording group has changed, move it to its new pages;
+    // if not, only update UI for the updated item
     if (evinfo.GetRecordingGroup() == old_recgroup)
     {
         ProgramInfo *dst = FindProgramInUILists(evinfo);
@@ -4441,7 +4579,12 @@ void PlaybackBox::HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo)
         return;
     }
 
-    ScheduleUpdateUIList();
+    ProgramInfo *pginfo =
+        m_programInfoCache.GetRecordingInfo(evinfo.GetRecordingID());
+    RemoveFromUILists(evinfo.GetRecordingID());
+    if (!pginfo || m_programInfoCache.IsLoadInProgress() ||
+        !AddToUILists(pginfo))
+        ScheduleUpdateUIList();
 }
 
 void PlaybackBox::HandleUpdateProgramInfoFileSizeEvent(uint recordingID,
@@ -4456,8 +4599,12 @@ void PlaybackBox::HandleUpdateProgramInfoFileSizeEvent(uint recordingID,
 
 void PlaybackBox::ScheduleUpdateUIList(void)
 {
-    if (!m_programInfoCache.IsLoadInProgress())
+    // One rebuild covers any number of changes made before it runs
+    if (!m_programInfoCache.IsLoadInProgress() && !m_updateUIListQueued)
+    {
+        m_updateUIListQueued = true;
         QCoreApplication::postEvent(this, new MythEvent("UPDATE_UI_LIST"));
+    }
 }
 
 void PlaybackBox::showIconHelp(void)
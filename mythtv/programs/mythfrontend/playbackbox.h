@@ -17,6 +17,7 @@ using namespace std;
 #include <QObject>
 #include <QMutex>
 #include <QMap>
+#include <QHash>
 #include <QSet>
 
 #include "jobqueue.h"
@@ -320,6 +321,12 @@ class PlaybackBox : public ScheduleCommon
 
     void HandlePreviewEvent(const QStringList &list);
     void HandleRecordingRemoveEvent(uint recordingID);
+    bool IsInView(const ProgramInfo *p);
+    QStringList GetPageKeys(const ProgramInfo *p, ViewTitleSort titleSort,
+                            QMap<QString, QString> &sortedList) const;
+    void AddToPage(const QString &key, ProgramInfo *p);
+    bool AddToUILists(ProgramInfo *p);
+    void RemoveFromUILists(uint recordingID);
     void HandleRecordingAddEvent(const ProgramInfo &evinfo);
     void HandleUpdateProgramInfoEvent(const ProgramInfo &evinfo);
     void HandleUpdateProgramInfoFileSizeEvent(uint recordingID, uint64_t filesize);
@@ -401,6 +408,8 @@ class PlaybackBox : public ScheduleCommon
     // Main Recording List support
     QStringList         m_titleList;  ///< list of pages
     ProgramMap          m_progLists;  ///< lists of programs by page
+    /// pages each recording is listed on, to remove it without a search
+    QHash<uint, QStringList> m_recordingGroups;
     int                 m_progsInDB;  ///< total number of recordings in DB
     bool                m_isFilling;
 
@@ -426,6 +435,8 @@ class PlaybackBox : public ScheduleCommon
 
     /// Does the recording list need to be refilled
     bool m_needUpdate;
+    /// Is a refill of the recording list already queued
+    bool m_updateUIListQueued;
 
     // Selection state variables
     bool                m_haveGroupInfoSet;
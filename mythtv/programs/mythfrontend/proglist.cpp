@@ -177,6 +177,9 @@ bool ProgLister::Create()
     connect(m_progList, SIGNAL(itemLoaded(MythUIButtonListItem*)),
             this,       SLOT(  HandleVisible(  MythUIButtonListItem*)));
 
+    // Program lists can be long, only fill in items around those shown
+    m_progList->SetPrefetchMargin(50);
+
     if (m_type == plPreviouslyRecorded)
         connect(m_progList, SIGNAL(itemClicked(MythUIButtonListItem*)),
                 this,       SLOT(  ShowOldRecordedMenu()));
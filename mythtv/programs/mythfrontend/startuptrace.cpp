@@ -0,0 +1,74 @@
+#include "startuptrace.h"
+
+#include <QTextStream>
+#include <QFile>
+
+#include "mythlogging.h"
+#include "mythdirs.h"
+
+#define LOC QString("StartupTrace: ")
+
+MythTimer                   StartupTrace::s_timer;
+QList<StartupTrace::Phase>  StartupTrace::s_phases;
+bool                        StartupTrace::s_finished = false;
+
+void StartupTrace::Mark(const QString &phase)
+{
+    if (s_finished)
+        return;
+
+    if (!s_timer.isRunning())
+        s_timer.start();
+
+    EndPhase();
+
+    Phase next;
+    next.m_name     = phase;
+    next.m_start    = s_timer.elapsed();
+    next.m_duration = -1;
+    s_phases.append(next);
+}
+
+void StartupTrace::EndPhase(void)
+{
+    if (s_phases.isEmpty() || s_phases.last().m_duration >= 0)
+        return;
+
+    Phase &last = s_phases.last();
+    last.m_duration = s_timer.elapsed() - last.m_start;
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC + QString("%1 took %2 ms")
+        .arg(last.m_name).arg(last.m_duration));
+}
+
+void StartupTrace::Finish(void)
+{
+    if (s_finished || s_phases.isEmpty())
+        return;
+
+    EndPhase();
+    s_finished = true;
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Startup took %1 ms")
+        .arg(s_timer.elapsed()));
+
+    QString filename = GetConfDir() + "/startup.trace";
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Unable to write '%1'").arg(filename));
+        s_phases.clear();
+        return;
+    }
+
+    QTextStream stream(&file);
+    QList<Phase>::const_iterator it = s_phases.begin();
+    for (; it != s_phases.end(); ++it)
+    {
+        stream << QString("%1 %2 %3\n")
+            .arg(it->m_start, 7).arg(it->m_duration, 7).arg(it->m_name);
+    }
+
+    s_phases.clear();
+}
@@ -0,0 +1,40 @@
+#ifndef _STARTUPTRACE_H_
+#define _STARTUPTRACE_H_
+
+#include <QString>
+#include <QList>
+
+#include "mythtimer.h"
+
+/** \brief Times the phases of frontend startup
+ *
+ *  Each call to Mark() ends the running phase and starts the next one.
+ *  EndPhase() ends it without starting another, so idle time in the event
+ *  loop isn't charged to anything.
+ *  Finish() ends the last phase, logs the total and writes the timings to
+ *  startup.trace in the configuration directory, one phase per line as
+ *  "<start ms> <duration ms> <phase>".
+ *
+ *  Only to be used from the UI thread.
+ */
+class StartupTrace
+{
+  public:
+    static void Mark(const QString &phase);
+    static void EndPhase(void);
+    static void Finish(void);
+
+  private:
+    struct Phase
+    {
+        QString m_name;
+        int     m_start;
+        int     m_duration;
+    };
+
+    static MythTimer    s_timer;
+    static QList<Phase> s_phases;
+    static bool         s_finished;
+};
+
+#endif
@@ -2524,6 +2524,7 @@ void VideoDialog::DisplayMenu()
     MythMenu *menu = new MythMenu(label, this, "display");
 
     menu->AddItem(tr("Scan For Changes"), SLOT(doVideoScan()));
+    menu->AddItem(tr("Rescan All Directories"), SLOT(doFullVideoScan()));
     menu->AddItem(tr("Retrieve All Details"), SLOT(VideoAutoSearch()));
     menu->AddItem(tr("Filter Display"), SLOT(ChangeFilter()));
     menu->AddItem(tr("Browse By..."), NULL, CreateMetadataBrowseMenu());
@@ -3824,11 +3825,27 @@ void VideoDialog::OnVideoSearchDone(MetadataLookup *lookup)
 }
 
 void VideoDialog::doVideoScan()
+{
+    StartVideoScan(false);
+}
+
+/** \fn VideoDialog::doFullVideoScan()
+ *  \brief Scans every video directory, not only those that changed.
+ *
+ *  For when the directory index has gone wrong, e.g. after changes on a
+ *  network share that didn't show in the directory times.
+ */
+void VideoDialog::doFullVideoScan()
+{
+    StartVideoScan(true);
+}
+
+void VideoDialog::StartVideoScan(bool fullScan)
 {
     if (!m_d->m_scanner)
         m_d->m_scanner = new VideoScanner();
     connect(m_d->m_scanner, SIGNAL(finished(bool)), SLOT(scanFinished(bool)));
-    m_d->m_scanner->doScan(GetVideoDirs());
+    m_d->m_scanner->doScan(GetVideoDirs(), fullScan);
 }
 
 void VideoDialog::PromptToScan()
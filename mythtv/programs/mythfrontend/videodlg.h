@@ -133,6 +133,7 @@ class VideoDialog : public MythScreenType
     void OnVideoSearchListSelection(RefCountHandler<MetadataLookup> lookup);
 
     void doVideoScan();
+    void doFullVideoScan();
 
   protected slots:
     void scanFinished(bool);
@@ -173,6 +174,7 @@ class VideoDialog : public MythScreenType
     void SwitchLayout(DialogType type, BrowseType browse);
 
     void StartVideoImageSet(VideoMetadata *metadata);
+    void StartVideoScan(bool fullScan);
 
     void SavePosition(void);
 